@@ -54,6 +54,18 @@ endif()
 
 include(DuneTBB)
 
+# compression of rotated log files
+find_package(ZLIB)
+set(HAVE_ZLIB 0)
+if(ZLIB_FOUND)
+  dune_register_package_flags(INCLUDE_DIRS ${ZLIB_INCLUDE_DIRS} LIBRARIES ${ZLIB_LIBRARIES})
+  set(HAVE_ZLIB 1)
+endif(ZLIB_FOUND)
+include(FindZstd)
+if(ZSTD_FOUND)
+  dune_register_package_flags(INCLUDE_DIRS ${ZSTD_INCLUDE_DIRS} LIBRARIES ${ZSTD_LIBRARIES})
+endif(ZSTD_FOUND)
+
 if(HAVE_MPI)
   include(FindMPI4PY)
   if(MPI4PY_FOUND)
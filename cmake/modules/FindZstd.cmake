@@ -0,0 +1,24 @@
+# ~~~
+# This file is part of the dune-xt-common project:
+#   https://github.com/dune-community/dune-xt-common
+# Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+# License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+#      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+#          with "runtime exception" (http://www.dune-project.org/license.html)
+# ~~~
+
+find_path(ZSTD_INCLUDE_DIR NAMES zstd.h PATHS ${ZSTD_ROOT} PATH_SUFFIXES include)
+find_library(ZSTD_LIBRARY NAMES zstd PATHS ${ZSTD_ROOT} PATH_SUFFIXES lib)
+
+mark_as_advanced(ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Zstd ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+set(HAVE_ZSTD 0)
+if(ZSTD_FOUND)
+  set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+  set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+  set(HAVE_ZSTD 1)
+endif()
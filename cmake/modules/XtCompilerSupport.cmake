@@ -42,6 +42,8 @@ include(CheckIncludeFileCXX)
 include(TestCXXAcceptsFlag)
 check_include_file_cxx("tr1/array" HAVE_TR1_ARRAY)
 check_include_file_cxx("malloc.h" HAVE_MALLOC_H)
+check_include_file_cxx("linux/perf_event.h" HAVE_PERF_EVENT_OPEN)
+check_include_file_cxx("sys/mman.h" HAVE_SYS_MMAN_H)
 
 check_cxx_source_compiles("
    int main(void)
@@ -60,6 +60,14 @@
 #cmakedefine01 HAVE_TBB
 #endif
 
+#ifndef HAVE_ZLIB
+#cmakedefine01 HAVE_ZLIB
+#endif
+
+#ifndef HAVE_ZSTD
+#cmakedefine01 HAVE_ZSTD
+#endif
+
 #ifndef DXT_DISABLE_LARGE_TESTS
 #define DXT_DISABLE_LARGE_TESTS 0
 #endif
@@ -76,6 +84,14 @@
 #cmakedefine01 ENABLE_PERFMON
 #endif
 
+#ifndef HAVE_PERF_EVENT_OPEN
+#cmakedefine01 HAVE_PERF_EVENT_OPEN
+#endif
+
+#ifndef HAVE_SYS_MMAN_H
+#cmakedefine01 HAVE_SYS_MMAN_H
+#endif
+
 #if ENABLE_PERFMON && HAVE_LIKWID
 #define LIKWID_PERFMON 1
 #endif
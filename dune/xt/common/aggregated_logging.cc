@@ -0,0 +1,382 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "exceptions.hh"
+#include "aggregated_logging.hh"
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace {
+
+
+// each line is stored as its flags, its size and its characters
+const size_t aggregated_line_header = sizeof(std::int32_t) + sizeof(std::uint32_t);
+
+//! "[rank 3] " or "[ranks 0-3,7,9-12] " for the ascending ranks
+std::string rank_prefix(const std::vector<int>& ranks)
+{
+  std::string prefix = (ranks.size() == 1) ? "[rank " : "[ranks ";
+  for (size_t ii = 0; ii < ranks.size();) {
+    size_t last = ii;
+    while (last + 1 < ranks.size() && ranks[last + 1] == ranks[last] + 1)
+      ++last;
+    if (ii > 0)
+      prefix += ",";
+    prefix += std::to_string(ranks[ii]);
+    if (last > ii)
+      prefix += "-" + std::to_string(ranks[last]);
+    ii = last + 1;
+  }
+  return prefix + "] ";
+} // ... rank_prefix(...)
+
+
+} // namespace
+
+
+LogAggregatorOptions::LogAggregatorOptions(bool per_node_in,
+                                           size_t collate_every_in,
+                                           size_t max_repeats_in,
+                                           std::chrono::milliseconds repeat_interval_in)
+  : per_node(per_node_in)
+  , collate_every(collate_every_in)
+  , max_repeats(max_repeats_in)
+  , repeat_interval(repeat_interval_in)
+{}
+
+
+struct LogAggregator::Round
+{
+  enum class Stage
+  {
+    idle,
+    sizes,
+    data,
+    //! the aggregating rank has written the lines of all ranks once this stage is completed
+    written
+  };
+
+#if HAVE_MPI
+  MPI_Comm comm;
+  MPI_Request request;
+#endif
+  //! rank and size within the group of ranks sharing an aggregating rank
+  int rank;
+  int size;
+  //! the global ranks of the group, only on the aggregating rank
+  std::vector<int> ranks;
+  Stage stage;
+  std::string sending;
+  int sending_size;
+  std::vector<int> sizes;
+  std::vector<int> offsets;
+  std::vector<char> receiving;
+}; // struct LogAggregator::Round
+
+
+LogAggregator::LogAggregator(WriterType writer, LogAggregatorOptions options, MPIHelper::MPICommunicator comm)
+  : writer_(writer)
+  , options_(options)
+  , rank_(0)
+  , size_(1)
+  , round_(new Round())
+  , calls_(0)
+  , suppressed_(0)
+{
+  if (options_.collate_every == 0)
+    DUNE_THROW(Exceptions::wrong_input_given, "collate_every has to be positive!");
+  auto& round = *round_;
+  round.rank = 0;
+  round.size = 1;
+  round.ranks = {0};
+  round.stage = Round::Stage::idle;
+#if HAVE_MPI
+  MPI_Comm_rank(comm, &rank_);
+  MPI_Comm_size(comm, &size_);
+  if (options_.per_node)
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank_, MPI_INFO_NULL, &round.comm);
+  else
+    MPI_Comm_dup(comm, &round.comm);
+  MPI_Comm_rank(round.comm, &round.rank);
+  MPI_Comm_size(round.comm, &round.size);
+  round.ranks.resize((round.rank == 0) ? round.size : 0);
+  MPI_Gather(&rank_, 1, MPI_INT, round.ranks.data(), 1, MPI_INT, 0, round.comm);
+#else
+  (void)comm;
+#endif
+} // LogAggregator(...)
+
+LogAggregator::~LogAggregator()
+{
+  std::string buffer;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto&& repeats : repeats_)
+      report_suppressed_(repeats.first, repeats.second);
+    buffer.swap(buffer_);
+  }
+#if HAVE_MPI
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (!finalized)
+    advance_(false);
+#endif
+  // a round cannot be completed without the other ranks, so the lines of this rank in it are written here as well
+  const auto stage = round_->stage;
+  if (stage == Round::Stage::sizes || stage == Round::Stage::data || (stage == Round::Stage::written && !aggregating()))
+    buffer = round_->sending + buffer;
+  if (!buffer.empty())
+    write_({rank_}, {{buffer.data(), buffer.size()}});
+#if HAVE_MPI
+  if (finalized)
+    return;
+  if (stage == Round::Stage::idle)
+    MPI_Comm_free(&round_->comm);
+  else {
+    // requests of collectives can neither be freed nor cancelled, the pending one may still access the buffers
+    round_.release();
+  }
+#endif
+} // ~LogAggregator(...)
+
+bool LogAggregator::aggregating() const
+{
+  return round_->rank == 0;
+}
+
+void LogAggregator::push(const int flags, const std::string& text)
+{
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t begin = 0;
+  while (begin < text.size()) {
+    auto end = text.find('\n', begin);
+    if (end == std::string::npos)
+      end = text.size();
+    const auto line = text.substr(begin, end - begin);
+    begin = end + 1;
+    if (options_.max_repeats == 0) {
+      append_(flags, line);
+      continue;
+    }
+    std::string key(sizeof(std::int32_t), '\0');
+    const auto flags_32 = std::int32_t(flags);
+    std::memcpy(&key[0], &flags_32, sizeof(flags_32));
+    key += line;
+    auto& repeats = repeats_[key];
+    if (repeats.count == 0 || now - repeats.begin >= options_.repeat_interval) {
+      report_suppressed_(key, repeats);
+      repeats.begin = now;
+      repeats.count = 0;
+    }
+    if (repeats.count >= options_.max_repeats) {
+      ++repeats.suppressed;
+      ++suppressed_;
+      continue;
+    }
+    ++repeats.count;
+    append_(flags, line);
+  }
+} // ... push(...)
+
+void LogAggregator::collate()
+{
+  advance_(false);
+  if (++calls_ % options_.collate_every != 0)
+    return;
+  // only one round at a time
+  advance_(true);
+  start_round_();
+  advance_(false);
+}
+
+void LogAggregator::finish()
+{
+  advance_(true);
+  start_round_();
+  advance_(true);
+}
+
+size_t LogAggregator::suppressed() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return suppressed_;
+}
+
+const LogAggregatorOptions& LogAggregator::options() const
+{
+  return options_;
+}
+
+void LogAggregator::append_(const int flags, const std::string& line)
+{
+  const auto flags_32 = std::int32_t(flags);
+  const auto size = std::uint32_t(line.size());
+  buffer_.append(reinterpret_cast<const char*>(&flags_32), sizeof(flags_32));
+  buffer_.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  buffer_.append(line);
+}
+
+void LogAggregator::report_suppressed_(const std::string& key, Repeats& repeats)
+{
+  if (repeats.suppressed == 0)
+    return;
+  std::int32_t flags;
+  std::memcpy(&flags, key.data(), sizeof(flags));
+  append_(flags,
+          key.substr(sizeof(flags)) + " [suppressed " + std::to_string(repeats.suppressed) + " repetition"
+              + ((repeats.suppressed == 1) ? "]" : "s]"));
+  repeats.suppressed = 0;
+}
+
+void LogAggregator::start_round_()
+{
+  auto& round = *round_;
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto it = repeats_.begin(); it != repeats_.end();) {
+      report_suppressed_(it->first, it->second);
+      // forget lines whose interval is over, to bound the memory
+      if (now - it->second.begin >= options_.repeat_interval)
+        it = repeats_.erase(it);
+      else
+        ++it;
+    }
+    round.sending.clear();
+    round.sending.swap(buffer_);
+  }
+  round.sending_size = int(round.sending.size());
+#if HAVE_MPI
+  round.sizes.resize((round.rank == 0) ? round.size : 0);
+  MPI_Igather(&round.sending_size, 1, MPI_INT, round.sizes.data(), 1, MPI_INT, 0, round.comm, &round.request);
+  round.stage = Round::Stage::sizes;
+#else
+  write_(round.ranks, {{round.sending.data(), round.sending.size()}});
+#endif
+} // ... start_round_(...)
+
+void LogAggregator::advance_(const bool wait)
+{
+#if HAVE_MPI
+  auto& round = *round_;
+  while (round.stage != Round::Stage::idle) {
+    int done = 1;
+    if (wait)
+      MPI_Wait(&round.request, MPI_STATUS_IGNORE);
+    else
+      MPI_Test(&round.request, &done, MPI_STATUS_IGNORE);
+    if (!done)
+      return;
+    if (round.stage == Round::Stage::sizes) {
+      if (round.rank == 0) {
+        round.offsets.resize(round.size);
+        int total = 0;
+        for (int ii = 0; ii < round.size; ++ii) {
+          round.offsets[ii] = total;
+          total += round.sizes[ii];
+        }
+        round.receiving.resize(total);
+      }
+      MPI_Igatherv(round.sending.data(),
+                   round.sending_size,
+                   MPI_CHAR,
+                   round.receiving.data(),
+                   round.sizes.data(),
+                   round.offsets.data(),
+                   MPI_CHAR,
+                   0,
+                   round.comm,
+                   &round.request);
+      round.stage = Round::Stage::data;
+    } else if (round.stage == Round::Stage::data) {
+      if (round.rank == 0) {
+        std::vector<std::pair<const char*, size_t>> buffers;
+        for (int ii = 0; ii < round.size; ++ii)
+          buffers.emplace_back(round.receiving.data() + round.offsets[ii], round.sizes[ii]);
+        write_(round.ranks, buffers);
+      }
+      // the data has only left the other ranks, the barrier tells them that it was written as well
+      MPI_Ibarrier(round.comm, &round.request);
+      round.stage = Round::Stage::written;
+    } else
+      round.stage = Round::Stage::idle;
+  }
+#else
+  (void)wait;
+#endif
+} // ... advance_(...)
+
+void LogAggregator::write_(const std::vector<int>& ranks,
+                           const std::vector<std::pair<const char*, size_t>>& buffers) const
+{
+  struct Entry
+  {
+    std::int32_t flags;
+    std::string line;
+    std::vector<int> ranks;
+  };
+  // in order of the first appearance, identified by the line (including its flags) and its occurrence on each rank
+  std::vector<Entry> entries;
+  std::unordered_map<std::string, size_t> index;
+  for (size_t ii = 0; ii < buffers.size(); ++ii) {
+    std::unordered_map<std::string, size_t> occurrences;
+    const char* position = buffers[ii].first;
+    const char* const end = position + buffers[ii].second;
+    while (position < end) {
+      std::int32_t flags;
+      std::uint32_t size;
+      std::memcpy(&flags, position, sizeof(flags));
+      std::memcpy(&size, position + sizeof(flags), sizeof(size));
+      std::string key(position, aggregated_line_header + size);
+      position += aggregated_line_header + size;
+      const auto occurrence = occurrences[key]++;
+      key.append(reinterpret_cast<const char*>(&occurrence), sizeof(occurrence));
+      const auto found = index.find(key);
+      if (found == index.end()) {
+        index.emplace(key, entries.size());
+        entries.push_back({flags, key.substr(aggregated_line_header, size), {ranks[ii]}});
+      } else
+        entries[found->second].ranks.push_back(ranks[ii]);
+    }
+  }
+  for (const auto& entry : entries)
+    writer_(entry.flags, ((size_ > 1) ? rank_prefix(entry.ranks) : std::string()) + entry.line + "\n");
+} // ... write_(...)
+
+
+AggregatedLogBuffer::AggregatedLogBuffer(int loglevel, int& logflags, LogAggregator& aggregator)
+  : SuspendableStrBuffer(loglevel, logflags)
+  , aggregator_(aggregator)
+  , loglevel_(loglevel)
+  , logflags_(logflags)
+{}
+
+int AggregatedLogBuffer::sync()
+{
+  std::lock_guard<std::mutex> guard(sync_mutex_);
+  const auto text = str();
+  if (!text.empty())
+    aggregator_.push(loglevel_ | (logflags_ & (LOG_CONSOLE | LOG_FILE)), text);
+  str("");
+  return 0;
+}
+
+AggregatedLogStream::AggregatedLogStream(int loglevel, int& logflags, LogAggregator& aggregator)
+  : LogStream(new AggregatedLogBuffer(loglevel, logflags, aggregator))
+{}
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
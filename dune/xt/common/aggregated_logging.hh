@@ -0,0 +1,170 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_AGGREGATED_LOGGING_HH
+#define DUNE_XT_COMMON_AGGREGATED_LOGGING_HH
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/logstreams.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+struct LogAggregatorOptions
+{
+  LogAggregatorOptions(bool per_node_in = false,
+                       size_t collate_every_in = 1,
+                       size_t max_repeats_in = 10,
+                       std::chrono::milliseconds repeat_interval_in = std::chrono::seconds(1));
+  //! one aggregating rank per shared memory node instead of a single one for all ranks
+  bool per_node;
+  //! LogAggregator::collate() only starts a new round on every collate_every-th call
+  size_t collate_every;
+  //! identical lines of a rank beyond this number per repeat_interval are suppressed, 0 disables this
+  size_t max_repeats;
+  std::chrono::milliseconds repeat_interval;
+};
+
+/**
+ * \brief Collects the log output of all ranks on a single rank (or on one rank per node).
+ *
+ *        Each rank buffers its lines locally, which are sent to the aggregating rank in rounds started by the
+ *        collective collate(). A round uses non-blocking collectives and is completed by the next round, so collate()
+ *        only waits if the previous round did not finish in the meantime. The aggregating rank writes the lines of a
+ *        round once, prefixed by the ranks they stem from (the k-th occurrence of a line on one rank is merged with the
+ *        k-th occurrence of that line on all other ranks):
+\code
+[ranks 0-511] assembling the system matrix
+[rank 17] solver did not converge
+\endcode
+ *        Repeated identical lines of a rank are rate limited, see LogAggregatorOptions::max_repeats, the number of
+ *        suppressed lines is reported in the next round.
+ *
+ * \note  Use via the LOG_AGGREGATE flag of Logging.
+ */
+class LogAggregator
+{
+public:
+  //! called on aggregating ranks with the flags of the originating stream and the text (including the newline)
+  typedef std::function<void(const int flags, const std::string& text)> WriterType;
+
+  //! collective on comm
+  LogAggregator(WriterType writer,
+                LogAggregatorOptions options = LogAggregatorOptions(),
+                MPIHelper::MPICommunicator comm = MPIHelper::getCommunicator());
+
+  /**
+   * \brief writes all lines of this rank which have not been written by the aggregating rank yet on this rank itself
+   * \note  Not collective, call finish() on all ranks before to have all lines aggregated. Otherwise the lines of a
+   *        round which is still in flight are written on each rank, so they appear twice if the aggregating rank
+   *        completes that round nevertheless. The state of such a round is not freed, since MPI may still access it.
+   */
+  ~LogAggregator();
+
+  //! whether this rank writes the aggregated lines
+  bool aggregating() const;
+
+  //! buffers the lines of text, thread safe and without communication
+  void push(const int flags, const std::string& text);
+
+  //! starts a round of aggregation (see LogAggregatorOptions::collate_every), collective
+  void collate();
+
+  //! writes all lines pushed so far on the aggregating rank, collective and blocking
+  void finish();
+
+  //! number of lines suppressed on this rank due to LogAggregatorOptions::max_repeats
+  size_t suppressed() const;
+
+  const LogAggregatorOptions& options() const;
+
+private:
+  LogAggregator(const LogAggregator&) = delete;
+  LogAggregator& operator=(const LogAggregator&) = delete;
+
+  //! the state of the non-blocking collectives
+  struct Round;
+
+  //! a line which is rate limited
+  struct Repeats
+  {
+    std::chrono::steady_clock::time_point begin;
+    size_t count;
+    size_t suppressed;
+  };
+
+  //! has to be called with mutex_ locked
+  void append_(const int flags, const std::string& line);
+
+  //! has to be called with mutex_ locked
+  void report_suppressed_(const std::string& key, Repeats& repeats);
+
+  //! moves the buffered lines into a new round and starts it, the previous round has to be completed
+  void start_round_();
+
+  //! advances the current round as far as possible, until it is completed if wait is true
+  void advance_(const bool wait);
+
+  //! merges and writes the lines of all ranks of the group, given the global ranks and their buffers
+  void write_(const std::vector<int>& ranks, const std::vector<std::pair<const char*, size_t>>& buffers) const;
+
+  const WriterType writer_;
+  const LogAggregatorOptions options_;
+  int rank_;
+  int size_;
+  std::unique_ptr<Round> round_;
+  size_t calls_;
+  mutable std::mutex mutex_;
+  //! the lines pushed since the last round, each as flags, size and characters
+  std::string buffer_;
+  std::unordered_map<std::string, Repeats> repeats_;
+  size_t suppressed_;
+}; // class LogAggregator
+
+
+//! stream buffer passing its content to a LogAggregator on sync, flagged with its level and LOG_CONSOLE/LOG_FILE
+class AggregatedLogBuffer : public SuspendableStrBuffer
+{
+public:
+  AggregatedLogBuffer(int loglevel, int& logflags, LogAggregator& aggregator);
+
+protected:
+  virtual int sync();
+
+private:
+  LogAggregator& aggregator_;
+  const int loglevel_;
+  const int& logflags_;
+  std::mutex sync_mutex_;
+}; // class AggregatedLogBuffer
+
+
+//! ostream compatible class collecting the output of all ranks via a LogAggregator
+class AggregatedLogStream : public LogStream
+{
+public:
+  AggregatedLogStream(int loglevel, int& logflags, LogAggregator& aggregator);
+}; // class AggregatedLogStream
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_AGGREGATED_LOGGING_HH
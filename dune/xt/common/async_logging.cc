@@ -0,0 +1,486 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/parallel/threadstorage.hh>
+
+#include "async_logging.hh"
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace internal {
+
+
+struct AsyncLogRecord
+{
+  AsyncLogBackend::SinksType sinks;
+  std::string text;
+};
+
+//! ring buffer with a single producer (the owning thread) and a single consumer (whoever drains)
+struct AsyncLogQueue
+{
+  explicit AsyncLogQueue(const size_t capacity)
+    : claimed(true)
+    , pushing(false)
+    , head(0)
+    , tail(0)
+    , dropped(0)
+    , reported(0)
+    , last_sinks{{nullptr, nullptr}}
+    , records(capacity)
+  {}
+
+  std::atomic<bool> claimed;
+  //! set by the producer within push(), to detect signal handlers interrupting it
+  std::atomic<bool> pushing;
+  // producer and consumer should not share cache lines, padded since make_shared ignores alignas before C++17
+  char padding0[cache_line_size];
+  //! next record to be written, advanced by the consumer
+  std::atomic<size_t> head;
+  char padding1[cache_line_size];
+  //! next free record, advanced by the producer
+  std::atomic<size_t> tail;
+  std::atomic<size_t> dropped;
+  // only used by the consumer
+  size_t reported;
+  AsyncLogBackend::SinksType last_sinks;
+  std::vector<AsyncLogRecord> records;
+}; // struct AsyncLogQueue
+
+struct AsyncLogQueueNode
+{
+  std::shared_ptr<AsyncLogQueue> queue;
+  AsyncLogQueueNode* next;
+};
+
+
+} // namespace internal
+namespace {
+
+
+//! output of a thread to an AsyncLogBuffer since the last sync
+struct AsyncLogStaging
+{
+  std::uint64_t buffer;
+  std::string text;
+};
+
+struct AsyncLogThreadData
+{
+  //! the queues claimed by the thread, per backend
+  std::vector<std::pair<std::uint64_t, std::shared_ptr<internal::AsyncLogQueue>>> queues;
+  std::vector<AsyncLogStaging> staging;
+};
+
+// trivially destructible, so that logging during the destruction of static objects works
+thread_local AsyncLogThreadData* async_log_thread_data = nullptr;
+thread_local bool async_log_thread_exiting = false;
+
+//! releases the queues of a thread for reuse on thread exit
+struct AsyncLogThreadGuard
+{
+  ~AsyncLogThreadGuard()
+  {
+    async_log_thread_exiting = true;
+    if (async_log_thread_data == nullptr)
+      return;
+    for (auto&& entry : async_log_thread_data->queues)
+      entry.second->claimed.store(false, std::memory_order_release);
+    delete async_log_thread_data;
+    async_log_thread_data = nullptr;
+  }
+
+  void touch() {}
+};
+
+thread_local AsyncLogThreadGuard async_log_thread_guard;
+
+AsyncLogThreadData& local_async_log_data()
+{
+  if (async_log_thread_data == nullptr) {
+    async_log_thread_data = new AsyncLogThreadData();
+    // data created after the guard was destroyed is leaked, the thread is about to end anyway
+    if (!async_log_thread_exiting)
+      async_log_thread_guard.touch();
+  }
+  return *async_log_thread_data;
+}
+
+std::atomic<std::uint64_t> async_log_backend_count(0);
+std::atomic<std::uint64_t> async_log_buffer_count(0);
+//! the backends written by AsyncLogBackend::flush_on_signal(), which may not take any lock
+std::atomic<AsyncLogBackend*> async_log_backends[8] = {};
+
+size_t round_up_to_power_of_two(const size_t value)
+{
+  size_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+
+} // namespace
+
+
+AsyncLogOptions::AsyncLogOptions(LogOverflowPolicy overflow_in,
+                                 size_t queue_capacity_in,
+                                 size_t max_bytes_in,
+                                 std::chrono::milliseconds interval_in)
+  : overflow(overflow_in)
+  , queue_capacity(round_up_to_power_of_two(std::max(queue_capacity_in, size_t(2))))
+  , max_bytes(max_bytes_in)
+  , interval(interval_in)
+{}
+
+AsyncLogBackend::AsyncLogBackend(AsyncLogOptions options)
+  : options_(options)
+  , id_(++async_log_backend_count)
+  , queues_(nullptr)
+  , queued_bytes_(0)
+  , dropped_(0)
+  , stop_(false)
+  , flush_requested_(0)
+  , flush_completed_(0)
+  , signal_flush_requested_(0)
+  , signal_flush_completed_(0)
+{
+  if (pipe(wake_pipe_) != 0)
+    DUNE_THROW(Exceptions::external_error, "Creating a pipe failed: " << std::strerror(errno));
+  // neither end may block, wake_() is called in signal handlers
+  for (auto fd : wake_pipe_) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+  }
+  worker_ = std::thread(&AsyncLogBackend::run_, this);
+  for (auto&& slot : async_log_backends) {
+    AsyncLogBackend* expected = nullptr;
+    if (slot.compare_exchange_strong(expected, this))
+      break;
+  }
+} // AsyncLogBackend(...)
+
+AsyncLogBackend::~AsyncLogBackend()
+{
+  for (auto&& slot : async_log_backends) {
+    AsyncLogBackend* expected = this;
+    slot.compare_exchange_strong(expected, nullptr);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_();
+  worker_.join();
+  close(wake_pipe_[0]);
+  close(wake_pipe_[1]);
+  auto node = queues_.load();
+  while (node != nullptr) {
+    const auto next = node->next;
+    delete node;
+    node = next;
+  }
+} // ~AsyncLogBackend(...)
+
+void AsyncLogBackend::push(const SinksType& sinks, const std::string& text)
+{
+  auto& queue = local_queue_();
+  if (queue.pushing.load(std::memory_order_relaxed)) {
+    // a signal handler interrupted push() on this thread, so the queue must not be touched
+    for (auto&& sink : sinks)
+      if (sink != nullptr)
+        sink->write(text.data(), text.size()).flush();
+    return;
+  }
+  queue.pushing.store(true, std::memory_order_relaxed);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  const auto capacity = queue.records.size();
+  const auto tail = queue.tail.load(std::memory_order_relaxed);
+  size_t size = 0;
+  while (true) {
+    size = tail - queue.head.load(std::memory_order_acquire);
+    const auto bytes = queued_bytes_.load(std::memory_order_relaxed);
+    if (size < capacity && (bytes == 0 || bytes + text.size() <= options_.max_bytes))
+      break;
+    if (options_.overflow != LogOverflowPolicy::block) {
+      queue.dropped.fetch_add(1, std::memory_order_relaxed);
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      queue.pushing.store(false, std::memory_order_relaxed);
+      return;
+    }
+    wake_();
+    std::this_thread::yield();
+  }
+  auto& record = queue.records[tail & (capacity - 1)];
+  record.sinks = sinks;
+  // reuses the capacity of the record
+  record.text.assign(text);
+  queued_bytes_.fetch_add(text.size(), std::memory_order_relaxed);
+  queue.tail.store(tail + 1, std::memory_order_release);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  queue.pushing.store(false, std::memory_order_relaxed);
+  // the background thread is only woken early if the queue fills up
+  if (size + 1 == capacity / 2)
+    wake_();
+} // ... push(...)
+
+void AsyncLogBackend::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto ticket = ++flush_requested_;
+  wake_();
+  flushed_condition_.wait(lock, [&]() { return flush_completed_ >= ticket; });
+}
+
+size_t AsyncLogBackend::dropped() const
+{
+  return dropped_.load();
+}
+
+const AsyncLogOptions& AsyncLogBackend::options() const
+{
+  return options_;
+}
+
+bool AsyncLogBackend::flush_on_signal(const std::chrono::milliseconds timeout)
+{
+  // only lock-free atomics, write(2) and nanosleep(2) are used, which are async-signal-safe
+  std::array<std::pair<AsyncLogBackend*, std::uint64_t>, 8> requested;
+  size_t num_requested = 0;
+  for (auto&& slot : async_log_backends) {
+    const auto backend = slot.load();
+    // the background thread was interrupted, so it cannot write anything
+    if (backend == nullptr || backend->worker_.get_id() == std::this_thread::get_id())
+      continue;
+    requested[num_requested++] = {backend, ++backend->signal_flush_requested_};
+    backend->wake_();
+  }
+  const timespec step{0, 1000000};
+  long waited = 0;
+  for (size_t ii = 0; ii < num_requested; ++ii) {
+    const auto& backend = *requested[ii].first;
+    while (backend.signal_flush_completed_.load(std::memory_order_acquire) < requested[ii].second) {
+      if (waited++ >= timeout.count())
+        return false;
+      nanosleep(&step, nullptr);
+    }
+  }
+  return true;
+} // ... flush_on_signal(...)
+
+internal::AsyncLogQueue& AsyncLogBackend::local_queue_()
+{
+  auto& queues = local_async_log_data().queues;
+  for (auto&& entry : queues)
+    if (entry.first == id_)
+      return *entry.second;
+  // the queues of destroyed backends are only referenced here
+  queues.erase(std::remove_if(queues.begin(),
+                              queues.end(),
+                              [](const std::pair<std::uint64_t, std::shared_ptr<internal::AsyncLogQueue>>& entry) {
+                                return entry.second.use_count() == 1;
+                              }),
+               queues.end());
+  std::shared_ptr<internal::AsyncLogQueue> queue;
+  for (auto node = queues_.load(std::memory_order_acquire); node != nullptr; node = node->next) {
+    bool expected = false;
+    if (node->queue->claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+      queue = node->queue;
+      break;
+    }
+  }
+  if (!queue) {
+    queue = std::make_shared<internal::AsyncLogQueue>(options_.queue_capacity);
+    auto node = new internal::AsyncLogQueueNode{queue, queues_.load(std::memory_order_relaxed)};
+    while (!queues_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+      ;
+  }
+  queues.emplace_back(id_, queue);
+  return *queue;
+} // ... local_queue_(...)
+
+void AsyncLogBackend::drain_()
+{
+  const auto signal_ticket = signal_flush_requested_.load(std::memory_order_acquire);
+  // each sink is flushed once in the end
+  std::array<std::ostream*, 8> touched;
+  size_t num_touched = 0;
+  const auto write = [&](const SinksType& sinks, const std::string& text) {
+    for (auto&& sink : sinks) {
+      if (sink == nullptr)
+        continue;
+      sink->write(text.data(), text.size());
+      if (std::find(touched.begin(), touched.begin() + num_touched, sink) != touched.begin() + num_touched)
+        continue;
+      if (num_touched < touched.size())
+        touched[num_touched++] = sink;
+      else
+        sink->flush();
+    }
+  };
+  size_t bytes = 0;
+  for (auto node = queues_.load(std::memory_order_acquire); node != nullptr; node = node->next) {
+    auto& queue = *node->queue;
+    const auto capacity = queue.records.size();
+    const auto tail = queue.tail.load(std::memory_order_acquire);
+    auto head = queue.head.load(std::memory_order_relaxed);
+    for (; head != tail; ++head) {
+      auto& record = queue.records[head & (capacity - 1)];
+      write(record.sinks, record.text);
+      bytes += record.text.size();
+      queue.last_sinks = record.sinks;
+      // do not keep the memory of exceptionally long records
+      if (record.text.capacity() > 4096)
+        std::string().swap(record.text);
+      else
+        record.text.clear();
+    }
+    queue.head.store(head, std::memory_order_release);
+    if (options_.overflow == LogOverflowPolicy::count) {
+      const auto dropped = queue.dropped.load(std::memory_order_relaxed);
+      // reported once the sinks of the queue are known
+      if (dropped != queue.reported && (queue.last_sinks[0] != nullptr || queue.last_sinks[1] != nullptr)) {
+        write(queue.last_sinks, "(" + std::to_string(dropped - queue.reported) + " log records dropped)\n");
+        queue.reported = dropped;
+      }
+    }
+  }
+  queued_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+  for (size_t ii = 0; ii < num_touched; ++ii)
+    touched[ii]->flush();
+  signal_flush_completed_.store(signal_ticket, std::memory_order_release);
+} // ... drain_(...)
+
+void AsyncLogBackend::wake_()
+{
+  const char byte = 0;
+  // if the pipe is full, the background thread is woken anyway
+  static_cast<void>(write(wake_pipe_[1], &byte, 1));
+}
+
+void AsyncLogBackend::wait_()
+{
+  pollfd wake_fd{wake_pipe_[0], POLLIN, 0};
+  const auto interval = std::min<std::chrono::milliseconds::rep>(options_.interval.count(), 1000 * 60 * 60);
+  static_cast<void>(poll(&wake_fd, 1, static_cast<int>(interval)));
+  char buffer[64];
+  while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0)
+    ;
+}
+
+void AsyncLogBackend::run_()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    const auto ticket = flush_requested_;
+    const auto stop = stop_;
+    lock.unlock();
+    drain_();
+    lock.lock();
+    flush_completed_ = ticket;
+    flushed_condition_.notify_all();
+    if (stop)
+      return;
+    // the pipe keeps wake-ups of the meantime, so none is missed
+    if (!stop_ && flush_requested_ == ticket) {
+      lock.unlock();
+      wait_();
+      // the thread interrupted by a signal handler may hold mutex_
+      if (signal_flush_requested_.load(std::memory_order_acquire)
+          != signal_flush_completed_.load(std::memory_order_relaxed))
+        drain_();
+      lock.lock();
+    }
+  }
+} // ... run_(...)
+
+AsyncLogBuffer::AsyncLogBuffer(int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out)
+  : SuspendableStrBuffer(loglevel, logflags)
+  , backend_(backend)
+  , sinks_{{&out, nullptr}}
+  , id_(++async_log_buffer_count)
+{}
+
+AsyncLogBuffer::AsyncLogBuffer(
+    int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out, std::ostream& file)
+  : SuspendableStrBuffer(loglevel, logflags)
+  , backend_(backend)
+  , sinks_{{&out, &file}}
+  , id_(++async_log_buffer_count)
+{}
+
+std::streamsize AsyncLogBuffer::xsputn(const char_type* s, std::streamsize count)
+{
+  if (enabled())
+    staging_().append(s, count);
+  // pretend everything was written
+  return count;
+}
+
+AsyncLogBuffer::int_type AsyncLogBuffer::overflow(int_type ch)
+{
+  if (enabled() && !traits_type::eq_int_type(ch, traits_type::eof()))
+    staging_().push_back(traits_type::to_char_type(ch));
+  return traits_type::not_eof(ch);
+}
+
+int AsyncLogBuffer::sync()
+{
+  auto& text = staging_();
+  if (!text.empty()) {
+    backend_.push(sinks_, text);
+    text.clear();
+  }
+  return 0;
+}
+
+std::string& AsyncLogBuffer::staging_()
+{
+  auto& staging = local_async_log_data().staging;
+  for (auto&& entry : staging)
+    if (entry.buffer == id_)
+      return entry.text;
+  // entries of destroyed buffers are never used again, entries of others are simply recreated
+  if (staging.size() >= 16)
+    staging.erase(std::remove_if(staging.begin(),
+                                 staging.end(),
+                                 [](const AsyncLogStaging& entry) { return entry.text.empty(); }),
+                  staging.end());
+  staging.push_back({id_, std::string()});
+  return staging.back().text;
+} // ... staging_(...)
+
+AsyncLogStream::AsyncLogStream(int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out)
+  : LogStream(new AsyncLogBuffer(loglevel, logflags, backend, out))
+{}
+
+AsyncLogStream::AsyncLogStream(
+    int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out, std::ostream& file)
+  : LogStream(new AsyncLogBuffer(loglevel, logflags, backend, out, file))
+{}
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
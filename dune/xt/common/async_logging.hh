@@ -0,0 +1,188 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_ASYNC_LOGGING_HH
+#define DUNE_XT_COMMON_ASYNC_LOGGING_HH
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include <dune/xt/common/logstreams.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace internal {
+
+
+struct AsyncLogQueue;
+struct AsyncLogQueueNode;
+
+
+} // namespace internal
+
+
+//! what AsyncLogBackend does with records which do not fit into the queues
+enum class LogOverflowPolicy
+{
+  //! the writing thread waits until the background thread made room
+  block,
+  //! the record is discarded, see AsyncLogBackend::dropped()
+  drop,
+  //! as drop, but the number of discarded records is also written to the sinks
+  count
+};
+
+struct AsyncLogOptions
+{
+  AsyncLogOptions(LogOverflowPolicy overflow_in = LogOverflowPolicy::block,
+                  size_t queue_capacity_in = 1024,
+                  size_t max_bytes_in = 64 * 1024 * 1024,
+                  std::chrono::milliseconds interval_in = std::chrono::milliseconds(10));
+  LogOverflowPolicy overflow;
+  //! number of records each thread may queue, rounded up to a power of two
+  size_t queue_capacity;
+  //! number of characters all threads may queue, a single record is always accepted
+  size_t max_bytes;
+  //! the background thread writes the queued records at least this often
+  std::chrono::milliseconds interval;
+};
+
+/**
+ * \brief Writes log records on a background thread.
+ *
+ *        Each thread appends its records to its own bounded single-producer queue, without taking any lock. The
+ *        background thread drains all queues in batches and flushes each sink once per batch. Queues of finished
+ *        threads are reused by new ones. Records of a single thread keep their order, records of different threads
+ *        are only ordered by flush().
+ *
+ * \note  Queued records are only written by the background thread, i.e. at the latest by flush(), flush_on_signal()
+ *        or on destruction. Records still queued when the program is terminated by std::abort are lost.
+ *
+ * \note  Use via Logging::set_async() or AsyncLogStream.
+ */
+class AsyncLogBackend
+{
+public:
+  //! a record is written to each non-null sink
+  typedef std::array<std::ostream*, 2> SinksType;
+
+  explicit AsyncLogBackend(AsyncLogOptions options = AsyncLogOptions());
+
+  //! writes all queued records
+  ~AsyncLogBackend();
+
+  //! queues text, lock-free unless the queue is full and the policy is LogOverflowPolicy::block
+  void push(const SinksType& sinks, const std::string& text);
+
+  //! writes all records queued so far by the calling thread (and possibly others) and flushes the sinks
+  void flush();
+
+  //! number of records discarded due to LogOverflowPolicy::drop or LogOverflowPolicy::count
+  size_t dropped() const;
+
+  const AsyncLogOptions& options() const;
+
+  /**
+   * \brief lets the background threads of all backends write the records queued so far, to be used in signal handlers
+   * \note  This is async-signal-safe: the request is handed to the background threads via a pipe and the calling
+   *        thread waits for them without taking any lock. Handlers installed via install_signal_handler() call this
+   *        before the actual handler.
+   * \note  The wait is bounded by timeout, since the interrupted thread may hold a lock the background thread needs
+   *        (e.g. of the allocator). Records of a backend whose background thread was interrupted are not written.
+   * \return whether all records were written in time
+   */
+  static bool flush_on_signal(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+private:
+  AsyncLogBackend(const AsyncLogBackend&) = delete;
+  AsyncLogBackend& operator=(const AsyncLogBackend&) = delete;
+
+  //! the calling thread's queue, claimed on first use
+  internal::AsyncLogQueue& local_queue_();
+
+  //! writes the records of all queues, only called by the background thread
+  void drain_();
+
+  //! lets the background thread drain the queues before its interval has passed, async-signal-safe
+  void wake_();
+
+  //! waits for wake_() or until the interval has passed, only called by the background thread
+  void wait_();
+
+  void run_();
+
+  const AsyncLogOptions options_;
+  const std::uint64_t id_;
+  //! lock-free list of all queues, only grows
+  std::atomic<internal::AsyncLogQueueNode*> queues_;
+  std::atomic<size_t> queued_bytes_;
+  std::atomic<size_t> dropped_;
+  //! written to by wake_(), the background thread waits for it to become readable
+  int wake_pipe_[2];
+  std::mutex mutex_;
+  std::condition_variable flushed_condition_;
+  bool stop_;
+  std::uint64_t flush_requested_;
+  std::uint64_t flush_completed_;
+  //! as flush_requested_ and flush_completed_, for flush_on_signal(), which may not lock mutex_
+  std::atomic<std::uint64_t> signal_flush_requested_;
+  std::atomic<std::uint64_t> signal_flush_completed_;
+  std::thread worker_;
+}; // class AsyncLogBackend
+
+
+/**
+ * \brief Stream buffer collecting the output of each thread separately and queuing it in an AsyncLogBackend on sync.
+ *
+ *        Unlike OstreamBuffer, writing takes no lock and output of different threads is not interleaved within a
+ *        line (or whatever is written between two flushes).
+ */
+class AsyncLogBuffer : public SuspendableStrBuffer
+{
+public:
+  AsyncLogBuffer(int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out);
+
+  AsyncLogBuffer(int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out, std::ostream& file);
+
+protected:
+  virtual std::streamsize xsputn(const char_type* s, std::streamsize count);
+  virtual int_type overflow(int_type ch = traits_type::eof());
+  virtual int sync();
+
+private:
+  //! the calling thread's output since the last sync
+  std::string& staging_();
+
+  AsyncLogBackend& backend_;
+  const AsyncLogBackend::SinksType sinks_;
+  const std::uint64_t id_;
+}; // class AsyncLogBuffer
+
+
+//! ostream compatible class wrapping asynchronous file and console output
+class AsyncLogStream : public LogStream
+{
+public:
+  AsyncLogStream(int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out);
+
+  AsyncLogStream(int loglevel, int& logflags, AsyncLogBackend& backend, std::ostream& out, std::ostream& file);
+}; // class AsyncLogStream
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_ASYNC_LOGGING_HH
@@ -0,0 +1,318 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#if HAVE_SYS_MMAN_H
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <dune/common/parametertree.hh>
+
+#include <dune/xt/common/filesystem.hh>
+
+#include "binary_configuration.hh"
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace {
+
+
+const char binary_configuration_magic[8] = {'D', 'X', 'T', 'C', 'C', 'F', 'G', '\0'};
+constexpr std::uint32_t binary_configuration_byte_order = 0x01020304;
+constexpr std::uint32_t binary_configuration_version = 1;
+
+//! lexicographic comparison as for std::string
+int compare_keys(const char* left, const size_t left_size, const char* right, const size_t right_size)
+{
+  const auto result = std::memcmp(left, right, std::min(left_size, right_size));
+  if (result != 0)
+    return result;
+  return (left_size < right_size) ? -1 : ((left_size > right_size) ? 1 : 0);
+}
+
+//! broadcasts in chunks, since MPI counts are ints
+void broadcast_bytes(const CollectiveCommunication<MPIHelper::MPICommunicator>& comm,
+                     char* data,
+                     const size_t bytes,
+                     const int root)
+{
+  const size_t chunk = std::numeric_limits<int>::max();
+  for (size_t offset = 0; offset < bytes; offset += chunk)
+    comm.broadcast(data + offset, static_cast<int>(std::min(chunk, bytes - offset)), root);
+}
+
+
+} // namespace
+
+
+constexpr std::uint32_t BinaryConfiguration::has_integer;
+constexpr std::uint32_t BinaryConfiguration::has_number;
+
+BinaryConfiguration::BinaryConfiguration()
+  : BinaryConfiguration(Configuration())
+{}
+
+BinaryConfiguration::BinaryConfiguration(const Configuration& config)
+  : bytes_(0)
+{
+  auto data = serialize_(config.flatten(), bytes_);
+  data_ = std::shared_ptr<const char>(data.release(), std::default_delete<const char[]>());
+}
+
+BinaryConfiguration::BinaryConfiguration(std::unique_ptr<char[]> data, const size_t bytes)
+  : BinaryConfiguration(std::shared_ptr<const char>(data.release(), std::default_delete<const char[]>()), bytes)
+{}
+
+BinaryConfiguration::BinaryConfiguration(std::shared_ptr<const char> data, const size_t bytes)
+  : data_(std::move(data))
+  , bytes_(bytes)
+{
+  validate_();
+}
+
+BinaryConfiguration BinaryConfiguration::read(const std::string& filename)
+{
+#if HAVE_SYS_MMAN_H
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    DUNE_THROW(Exceptions::external_error, "Could not open '" << filename << "': " << std::strerror(errno));
+  struct stat status;
+  if (::fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header))) {
+    ::close(fd);
+    DUNE_THROW(Exceptions::configuration_error, "'" << filename << "' is not a binary configuration!");
+  }
+  const size_t bytes = static_cast<size_t>(status.st_size);
+  void* mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after closing
+  ::close(fd);
+  if (mapped == MAP_FAILED)
+    DUNE_THROW(Exceptions::external_error, "Could not map '" << filename << "': " << std::strerror(errno));
+  return BinaryConfiguration(
+      std::shared_ptr<const char>(static_cast<const char*>(mapped),
+                                  [bytes](const char* data) { ::munmap(const_cast<char*>(data), bytes); }),
+      bytes);
+#else // HAVE_SYS_MMAN_H
+  auto file = make_ifstream(filename, std::ios_base::in | std::ios_base::binary);
+  if (!file->good())
+    DUNE_THROW(Exceptions::external_error, "Could not open '" << filename << "'!");
+  file->seekg(0, std::ios_base::end);
+  const size_t bytes = static_cast<size_t>(file->tellg());
+  file->seekg(0, std::ios_base::beg);
+  std::unique_ptr<char[]> data(new char[bytes]);
+  if (!file->read(data.get(), bytes))
+    DUNE_THROW(Exceptions::external_error, "Could not read '" << filename << "'!");
+  return BinaryConfiguration(std::move(data), bytes);
+#endif // HAVE_SYS_MMAN_H
+} // ... read(...)
+
+BinaryConfiguration
+BinaryConfiguration::broadcast(const BinaryConfiguration& config, MPIHelper::MPICommunicator mpi_comm, const int root)
+{
+  CollectiveCommunication<MPIHelper::MPICommunicator> comm(mpi_comm);
+  unsigned long bytes = config.bytes_;
+  comm.broadcast(&bytes, 1, root);
+  if (comm.rank() == root) {
+    // root only sends, the data is not modified
+    broadcast_bytes(comm, const_cast<char*>(config.data_.get()), bytes, root);
+    return config;
+  }
+  // see broadcast(filename, ...)
+  if (bytes == 0)
+    DUNE_THROW(Exceptions::configuration_error, "Obtaining the configuration failed on rank " << root << "!");
+  std::unique_ptr<char[]> data(new char[bytes]);
+  broadcast_bytes(comm, data.get(), bytes, root);
+  return BinaryConfiguration(std::move(data), bytes);
+} // ... broadcast(...)
+
+BinaryConfiguration
+BinaryConfiguration::broadcast(const std::string& filename, MPIHelper::MPICommunicator mpi_comm, const int root)
+{
+  CollectiveCommunication<MPIHelper::MPICommunicator> comm(mpi_comm);
+  if (comm.rank() != root)
+    return broadcast(BinaryConfiguration(), mpi_comm, root);
+  std::unique_ptr<BinaryConfiguration> config;
+  try {
+    config.reset(new BinaryConfiguration(read(filename)));
+  } catch (...) {
+    // no valid configuration is empty, so the other ranks do not wait forever
+    unsigned long bytes = 0;
+    comm.broadcast(&bytes, 1, root);
+    throw;
+  }
+  return broadcast(*config, mpi_comm, root);
+} // ... broadcast(...)
+
+void BinaryConfiguration::write(const std::string& filename) const
+{
+  auto file = make_ofstream(filename, std::ios_base::out | std::ios_base::binary);
+  if (!file->write(data_.get(), bytes_))
+    DUNE_THROW(Exceptions::external_error, "Could not write '" << filename << "'!");
+}
+
+const char* BinaryConfiguration::data() const
+{
+  return data_.get();
+}
+
+size_t BinaryConfiguration::bytes() const
+{
+  return bytes_;
+}
+
+size_t BinaryConfiguration::size() const
+{
+  return size_();
+}
+
+bool BinaryConfiguration::empty() const
+{
+  return size_() == 0;
+}
+
+const char* BinaryConfiguration::key(const size_t ii) const
+{
+  if (ii >= size_())
+    DUNE_THROW(Exceptions::index_out_of_range, "ii = " << ii << ", size() = " << size_());
+  return data_.get() + sizeof(Header) + size_() * sizeof(Entry) + entry_(ii).key;
+}
+
+const char* BinaryConfiguration::value(const size_t ii) const
+{
+  if (ii >= size_())
+    DUNE_THROW(Exceptions::index_out_of_range, "ii = " << ii << ", size() = " << size_());
+  return data_.get() + sizeof(Header) + size_() * sizeof(Entry) + entry_(ii).value;
+}
+
+bool BinaryConfiguration::has_key(const std::string& key) const
+{
+  return find_(key) != size_();
+}
+
+Configuration BinaryConfiguration::configuration() const
+{
+  ParameterTree tree;
+  for (size_t ii = 0; ii < size_(); ++ii)
+    tree[key(ii)] = value(ii);
+  return Configuration(tree);
+}
+
+std::unique_ptr<char[]> BinaryConfiguration::serialize_(const std::map<std::string, std::string>& values,
+                                                        size_t& bytes)
+{
+  std::vector<Entry> entries;
+  std::string strings;
+  for (const auto& key_value : values) {
+    Entry entry;
+    std::memset(&entry, 0, sizeof(Entry));
+    entry.key = strings.size();
+    entry.key_size = static_cast<std::uint32_t>(key_value.first.size());
+    strings.append(key_value.first).push_back('\0');
+    entry.value = strings.size();
+    entry.value_size = static_cast<std::uint32_t>(key_value.second.size());
+    strings.append(key_value.second).push_back('\0');
+    // the same conversions as in get()
+    try {
+      entry.integer = from_string<long long>(key_value.second);
+      entry.flags |= has_integer;
+    } catch (const Dune::Exception&) {
+    }
+    try {
+      entry.number = from_string<double>(key_value.second);
+      entry.flags |= has_number;
+    } catch (const Dune::Exception&) {
+    }
+    entries.push_back(entry);
+  }
+  Header header;
+  std::memcpy(header.magic, binary_configuration_magic, sizeof(header.magic));
+  header.byte_order = binary_configuration_byte_order;
+  header.version = binary_configuration_version;
+  header.entries = entries.size();
+  header.strings_bytes = strings.size();
+  bytes = sizeof(Header) + entries.size() * sizeof(Entry) + strings.size();
+  std::unique_ptr<char[]> data(new char[bytes]);
+  std::memcpy(data.get(), &header, sizeof(Header));
+  if (!entries.empty())
+    std::memcpy(data.get() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+  std::memcpy(data.get() + sizeof(Header) + entries.size() * sizeof(Entry), strings.data(), strings.size());
+  return data;
+} // ... serialize_(...)
+
+void BinaryConfiguration::validate_() const
+{
+  Header header;
+  if (!data_ || bytes_ < sizeof(Header))
+    DUNE_THROW(Exceptions::configuration_error, "Not a binary configuration (too short)!");
+  std::memcpy(&header, data_.get(), sizeof(Header));
+  if (std::memcmp(header.magic, binary_configuration_magic, sizeof(header.magic)) != 0)
+    DUNE_THROW(Exceptions::configuration_error, "Not a binary configuration (wrong magic)!");
+  if (header.byte_order != binary_configuration_byte_order)
+    DUNE_THROW(Exceptions::configuration_error, "The binary configuration was written with another byte order!");
+  if (header.version != binary_configuration_version)
+    DUNE_THROW(Exceptions::configuration_error,
+               "Unsupported binary configuration version " << header.version << ", expected "
+                                                           << binary_configuration_version << "!");
+  if (header.entries > (bytes_ - sizeof(Header)) / sizeof(Entry)
+      || header.strings_bytes != bytes_ - sizeof(Header) - header.entries * sizeof(Entry))
+    DUNE_THROW(Exceptions::configuration_error, "The binary configuration is truncated!");
+  const char* strings = data_.get() + sizeof(Header) + header.entries * sizeof(Entry);
+  const auto terminated = [&](const std::uint64_t offset, const std::uint32_t size) {
+    return offset < header.strings_bytes && size < header.strings_bytes - offset && strings[offset + size] == '\0';
+  };
+  for (size_t ii = 0; ii < header.entries; ++ii) {
+    const auto entry = entry_(ii);
+    if (!terminated(entry.key, entry.key_size) || !terminated(entry.value, entry.value_size))
+      DUNE_THROW(Exceptions::configuration_error, "Entry " << ii << " of the binary configuration is corrupt!");
+    // lookups rely on the order
+    if (ii > 0) {
+      const auto previous = entry_(ii - 1);
+      if (compare_keys(strings + previous.key, previous.key_size, strings + entry.key, entry.key_size) >= 0)
+        DUNE_THROW(Exceptions::configuration_error, "The keys of the binary configuration are not sorted!");
+    }
+  }
+} // ... validate_(...)
+
+size_t BinaryConfiguration::size_() const
+{
+  Header header;
+  std::memcpy(&header, data_.get(), sizeof(Header));
+  return header.entries;
+}
+
+size_t BinaryConfiguration::find_(const std::string& key) const
+{
+  const auto entries = size_();
+  const char* strings = data_.get() + sizeof(Header) + entries * sizeof(Entry);
+  size_t first = 0;
+  size_t last = entries;
+  while (first < last) {
+    const auto middle = first + (last - first) / 2;
+    const auto entry = entry_(middle);
+    const auto result = compare_keys(strings + entry.key, entry.key_size, key.data(), key.size());
+    if (result == 0)
+      return middle;
+    if (result < 0)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  return entries;
+} // ... find_(...)
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,220 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_BINARY_CONFIGURATION_HH
+#define DUNE_XT_COMMON_BINARY_CONFIGURATION_HH
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/configuration.hh>
+#include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/string.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+/**
+ * \brief A read-only Configuration in a compact binary format, which may be memory-mapped and broadcast.
+ *
+ *        The format consists of a header, a table of all keys (as in Configuration::flatten()) in sorted order and
+ *        a blob of the null-terminated keys and values. Values which convert to integers or doubles are additionally
+ *        stored converted in the table. Lookups are binary searches in the table, neither loading a file nor looking
+ *        up a value copies anything. To parse the parameters on a single rank and broadcast them to all others:
+\code
+const auto config = BinaryConfiguration::broadcast(MPIHelper::getCollectiveCommunication().rank() == 0
+                                                        ? BinaryConfiguration(Configuration(argc, argv, "params.ini"))
+                                                        : BinaryConfiguration());
+const auto tolerance = config.get("solver.tolerance", 1e-10);
+\endcode
+ * \note The format uses the native byte order, loading data written with another byte order throws.
+ */
+class BinaryConfiguration
+{
+  //! the layout of the data, written and read as is
+  struct Header
+  {
+    char magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint64_t entries;
+    std::uint64_t strings_bytes;
+  };
+
+  struct Entry
+  {
+    //! offsets of the null-terminated key and value in the blob
+    std::uint64_t key;
+    std::uint64_t value;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+    std::uint32_t flags;
+    std::uint32_t padding;
+    std::int64_t integer;
+    double number;
+  };
+
+  static constexpr std::uint32_t has_integer = 1;
+  static constexpr std::uint32_t has_number = 2;
+
+public:
+  //! an empty configuration
+  BinaryConfiguration();
+
+  explicit BinaryConfiguration(const Configuration& config);
+
+  //! takes ownership of data, which is validated
+  BinaryConfiguration(std::unique_ptr<char[]> data, const size_t bytes);
+
+  //! maps the file into memory if the system supports it, reads it otherwise
+  static BinaryConfiguration read(const std::string& filename);
+
+  /**
+   * \brief broadcasts config from root to all ranks of mpi_comm
+   * \note  config is only used on root.
+   */
+  static BinaryConfiguration broadcast(const BinaryConfiguration& config,
+                                       MPIHelper::MPICommunicator mpi_comm = MPIHelper::getCommunicator(),
+                                       const int root = 0);
+
+  //! reads filename on root only and broadcasts it to all ranks of mpi_comm
+  static BinaryConfiguration broadcast(const std::string& filename,
+                                       MPIHelper::MPICommunicator mpi_comm = MPIHelper::getCommunicator(),
+                                       const int root = 0);
+
+  void write(const std::string& filename) const;
+
+  //! the binary representation, see write()
+  const char* data() const;
+
+  size_t bytes() const;
+
+  //! the number of keys
+  size_t size() const;
+
+  bool empty() const;
+
+  const char* key(const size_t ii) const;
+
+  const char* value(const size_t ii) const;
+
+  bool has_key(const std::string& key) const;
+
+  //! \sa Configuration::get(), values which need to be converted are converted on each call
+  template <class T>
+  typename internal::Typer<T>::type get(const std::string& key, const size_t size = 0, const size_t cols = 0) const
+  {
+    const auto ii = find_(key);
+    if (ii == size_())
+      DUNE_THROW(Exceptions::configuration_error,
+                 "Configuration does not have this key and there was no default value provided!\n"
+                     << "  key: " << key);
+    return convert_<typename internal::Typer<T>::type>(ii, size, cols);
+  }
+
+  //! \sa Configuration::get()
+  template <class T>
+  typename internal::Typer<T>::type
+  get(const std::string& key, T def, const size_t size = 0, const size_t cols = 0) const
+  {
+    const auto ii = find_(key);
+    if (ii == size_())
+      return def;
+    return convert_<typename internal::Typer<T>::type>(ii, size, cols);
+  }
+
+  //! rebuilds the tree
+  Configuration configuration() const;
+
+private:
+  BinaryConfiguration(std::shared_ptr<const char> data, const size_t bytes);
+
+  static std::unique_ptr<char[]> serialize_(const std::map<std::string, std::string>& values, size_t& bytes);
+
+  //! throws if data_ is not in the expected format
+  void validate_() const;
+
+  size_t size_() const;
+
+  Entry entry_(const size_t ii) const
+  {
+    Entry entry;
+    std::memcpy(&entry, data_.get() + sizeof(Header) + ii * sizeof(Entry), sizeof(Entry));
+    return entry;
+  }
+
+  //! \return the index of key, size_() if there is none
+  size_t find_(const std::string& key) const;
+
+  //! the types for which from_string() is equivalent to a conversion to long long
+  template <class T>
+  struct is_integer
+  {
+    static constexpr bool value = std::is_same<T, int>::value || std::is_same<T, long>::value
+                                  || std::is_same<T, long long>::value || std::is_same<T, unsigned int>::value
+                                  || std::is_same<T, unsigned long>::value
+                                  || std::is_same<T, unsigned long long>::value;
+  };
+
+  template <class T>
+  typename std::enable_if<is_integer<T>::value, T>::type
+  convert_(const size_t ii, const size_t /*size*/, const size_t /*cols*/) const
+  {
+    const auto entry = entry_(ii);
+    if ((entry.flags & has_integer) && fits_<T>(entry.integer))
+      return static_cast<T>(entry.integer);
+    return from_string<T>(std::string(value(ii), entry.value_size));
+  }
+
+  template <class T>
+  typename std::enable_if<std::is_same<T, double>::value, T>::type
+  convert_(const size_t ii, const size_t /*size*/, const size_t /*cols*/) const
+  {
+    const auto entry = entry_(ii);
+    if (entry.flags & has_number)
+      return entry.number;
+    return from_string<T>(std::string(value(ii), entry.value_size));
+  }
+
+  template <class T>
+  typename std::enable_if<!is_integer<T>::value && !std::is_same<T, double>::value, T>::type
+  convert_(const size_t ii, const size_t size, const size_t cols) const
+  {
+    return from_string<T>(std::string(value(ii), entry_(ii).value_size), size, cols);
+  }
+
+  template <class T>
+  static typename std::enable_if<std::is_signed<T>::value, bool>::type fits_(const std::int64_t value)
+  {
+    return value >= std::int64_t(std::numeric_limits<T>::min()) && value <= std::int64_t(std::numeric_limits<T>::max());
+  }
+
+  template <class T>
+  static typename std::enable_if<!std::is_signed<T>::value, bool>::type fits_(const std::int64_t value)
+  {
+    return value >= 0 && std::uint64_t(value) <= std::uint64_t(std::numeric_limits<T>::max());
+  }
+
+  std::shared_ptr<const char> data_;
+  size_t bytes_;
+}; // class BinaryConfiguration
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_BINARY_CONFIGURATION_HH
@@ -0,0 +1,297 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "exceptions.hh"
+#include "binary_logging.hh"
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace {
+
+
+//! the layout of the beginning of a binary log file, written and read as is
+struct BinaryLogHeader
+{
+  char magic[8];
+  std::uint32_t byte_order;
+  std::uint32_t version;
+  std::int32_t rank;
+  std::uint32_t padding;
+  //! nanoseconds since the epoch of the system clock
+  std::int64_t start;
+};
+
+const char binary_log_magic[8] = {'D', 'X', 'T', 'C', 'L', 'O', 'G', '\0'};
+const std::uint32_t binary_log_byte_order = 0x01020304;
+const std::uint32_t binary_log_version = 1;
+
+// each record is framed by its size (not including the size itself) and starts with its kind
+const std::uint8_t binary_log_format_record = 1;
+const std::uint8_t binary_log_message_record = 2;
+
+std::atomic<std::uint32_t> binary_log_format_count(0);
+std::atomic<std::uint32_t> binary_log_thread_count(0);
+
+std::uint32_t binary_log_thread()
+{
+  thread_local const std::uint32_t thread = binary_log_thread_count++;
+  return thread;
+}
+
+//! the record currently written by the thread
+thread_local std::string binary_log_record;
+
+const BinaryLogFormat& binary_log_text_format()
+{
+  static const BinaryLogFormat format("{}");
+  return format;
+}
+
+template <class T>
+T read_binary(const std::string& payload, size_t& position)
+{
+  if (position + sizeof(T) > payload.size())
+    DUNE_THROW(Exceptions::logger_error, "Corrupt record in binary log file!");
+  T value;
+  std::memcpy(&value, payload.data() + position, sizeof(T));
+  position += sizeof(T);
+  return value;
+}
+
+
+} // namespace
+
+
+BinaryLogFormat::BinaryLogFormat(const std::string& format)
+  : id_(binary_log_format_count++)
+  , format_(format)
+{}
+
+std::uint32_t BinaryLogFormat::id() const
+{
+  return id_;
+}
+
+const std::string& BinaryLogFormat::format() const
+{
+  return format_;
+}
+
+BinaryLogSink::BinaryLogSink(const std::string& filename, const int rank)
+  : start_(std::chrono::steady_clock::now())
+  , file_(filename, std::ios_base::binary | std::ios_base::trunc)
+{
+  if (!file_.is_open())
+    DUNE_THROW(Exceptions::external_error, "Could not open '" << filename << "'!");
+  BinaryLogHeader header;
+  std::memcpy(header.magic, binary_log_magic, sizeof(header.magic));
+  header.byte_order = binary_log_byte_order;
+  header.version = binary_log_version;
+  header.rank = rank;
+  header.padding = 0;
+  header.start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+BinaryLogSink::~BinaryLogSink()
+{
+  flush();
+}
+
+void BinaryLogSink::flush()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  file_.flush();
+}
+
+std::string& BinaryLogSink::begin_message_(const int level, const BinaryLogFormat& format)
+{
+  auto& record = binary_log_record;
+  record.clear();
+  // the size is filled in by end_message_()
+  internal::append_binary(record, std::uint32_t(0));
+  internal::append_binary(record, binary_log_message_record);
+  internal::append_binary(record, format.id());
+  internal::append_binary(record, std::int32_t(level));
+  internal::append_binary(record, binary_log_thread());
+  internal::append_binary(
+      record,
+      std::uint64_t(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count()));
+  return record;
+} // ... begin_message_(...)
+
+void BinaryLogSink::end_message_(const BinaryLogFormat& format, std::string& record)
+{
+  const auto size = std::uint32_t(record.size() - sizeof(std::uint32_t));
+  std::memcpy(&record[0], &size, sizeof(size));
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (format.id() >= written_formats_.size())
+    written_formats_.resize(format.id() + 1, false);
+  if (!written_formats_[format.id()]) {
+    const auto format_size = std::uint32_t(1 + sizeof(std::uint32_t) + format.format().size());
+    file_.write(reinterpret_cast<const char*>(&format_size), sizeof(format_size));
+    file_.write(reinterpret_cast<const char*>(&binary_log_format_record), 1);
+    const auto id = format.id();
+    file_.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    file_.write(format.format().data(), format.format().size());
+    written_formats_[format.id()] = true;
+  }
+  file_.write(record.data(), record.size());
+} // ... end_message_(...)
+
+BinaryLogBuffer::BinaryLogBuffer(int loglevel, int& logflags, BinaryLogSink& sink)
+  : SuspendableStrBuffer(loglevel, logflags)
+  , sink_(sink)
+  , loglevel_(loglevel)
+{}
+
+int BinaryLogBuffer::sync()
+{
+  std::lock_guard<std::mutex> guard(sync_mutex_);
+  const auto text = str();
+  if (!text.empty())
+    sink_.write(loglevel_, binary_log_text_format(), text);
+  str("");
+  return 0;
+}
+
+BinaryLogStream::BinaryLogStream(int loglevel, int& logflags, BinaryLogSink& sink)
+  : LogStream(new BinaryLogBuffer(loglevel, logflags, sink))
+  , buffer_(static_cast<BinaryLogBuffer&>(*rdbuf()))
+{}
+
+BinaryLogReader::BinaryLogReader(const std::string& filename)
+  : filename_(filename)
+  , file_(filename, std::ios_base::binary)
+  , rank_(0)
+{
+  if (!file_.is_open())
+    DUNE_THROW(Exceptions::external_error, "Could not open '" << filename << "'!");
+  BinaryLogHeader header;
+  file_.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (file_.gcount() != sizeof(header) || std::memcmp(header.magic, binary_log_magic, sizeof(header.magic)) != 0)
+    DUNE_THROW(Exceptions::logger_error, "'" << filename << "' is not a binary log file!");
+  if (header.byte_order != binary_log_byte_order)
+    DUNE_THROW(Exceptions::logger_error, "'" << filename << "' was written with another byte order!");
+  if (header.version != binary_log_version)
+    DUNE_THROW(Exceptions::logger_error,
+               "'" << filename << "' has version " << header.version << ", only " << binary_log_version
+                   << " is supported!");
+  rank_ = header.rank;
+} // BinaryLogReader(...)
+
+int BinaryLogReader::rank() const
+{
+  return rank_;
+}
+
+bool BinaryLogReader::next(BinaryLogRecord& record)
+{
+  while (true) {
+    const auto kind = read_record_();
+    if (kind == 0)
+      return false;
+    size_t position = 1;
+    const auto id = read_binary<std::uint32_t>(payload_, position);
+    if (kind == binary_log_format_record) {
+      if (id >= formats_.size())
+        formats_.resize(id + 1);
+      formats_[id] = payload_.substr(position);
+    } else if (kind == binary_log_message_record) {
+      if (id >= formats_.size())
+        DUNE_THROW(Exceptions::logger_error, "Unknown format " << id << " in '" << filename_ << "'!");
+      record.rank = rank_;
+      record.level = read_binary<std::int32_t>(payload_, position);
+      record.thread = read_binary<std::uint32_t>(payload_, position);
+      record.time = read_binary<std::uint64_t>(payload_, position);
+      record.text = decode_(formats_[id], position);
+      return true;
+    } else
+      DUNE_THROW(Exceptions::logger_error, "Unknown record kind " << int(kind) << " in '" << filename_ << "'!");
+  }
+} // ... next(...)
+
+std::uint8_t BinaryLogReader::read_record_()
+{
+  std::uint32_t size = 0;
+  file_.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (file_.gcount() != sizeof(size))
+    return 0;
+  if (size == 0)
+    DUNE_THROW(Exceptions::logger_error, "Corrupt record in '" << filename_ << "'!");
+  payload_.resize(size);
+  file_.read(&payload_[0], size);
+  if (file_.gcount() != std::streamsize(size))
+    return 0;
+  return std::uint8_t(payload_[0]);
+}
+
+std::string BinaryLogReader::decode_(const std::string& format, size_t position) const
+{
+  using internal::BinaryLogArgument;
+  // formatted as a LogStream would have
+  std::vector<std::string> arguments;
+  std::ostringstream argument;
+  while (position < payload_.size()) {
+    argument.str("");
+    switch (read_binary<BinaryLogArgument>(payload_, position)) {
+      case BinaryLogArgument::integer:
+        argument << read_binary<std::int64_t>(payload_, position);
+        break;
+      case BinaryLogArgument::unsigned_integer:
+        argument << read_binary<std::uint64_t>(payload_, position);
+        break;
+      case BinaryLogArgument::number:
+        argument << read_binary<double>(payload_, position);
+        break;
+      case BinaryLogArgument::character:
+        argument << read_binary<char>(payload_, position);
+        break;
+      case BinaryLogArgument::boolean:
+        argument << bool(read_binary<std::uint8_t>(payload_, position));
+        break;
+      case BinaryLogArgument::string: {
+        const auto size = read_binary<std::uint32_t>(payload_, position);
+        if (position + size > payload_.size())
+          DUNE_THROW(Exceptions::logger_error, "Corrupt record in '" << filename_ << "'!");
+        argument.write(payload_.data() + position, size);
+        position += size;
+        break;
+      }
+      default:
+        DUNE_THROW(Exceptions::logger_error, "Corrupt record in '" << filename_ << "'!");
+    }
+    arguments.push_back(argument.str());
+  }
+  std::string text;
+  size_t begin = 0;
+  auto next_argument = arguments.begin();
+  for (auto placeholder = format.find("{}"); placeholder != std::string::npos && next_argument != arguments.end();
+       placeholder = format.find("{}", begin)) {
+    text.append(format, begin, placeholder - begin);
+    text.append(*next_argument++);
+    begin = placeholder + 2;
+  }
+  text.append(format, begin, std::string::npos);
+  for (; next_argument != arguments.end(); ++next_argument)
+    text.append(" " + *next_argument);
+  return text;
+} // ... decode_(...)
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,291 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_BINARY_LOGGING_HH
+#define DUNE_XT_COMMON_BINARY_LOGGING_HH
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/logstreams.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace internal {
+
+
+//! the tag preceding each argument in a binary log record
+enum class BinaryLogArgument : std::uint8_t
+{
+  integer = 1,
+  unsigned_integer = 2,
+  number = 3,
+  string = 4,
+  character = 5,
+  boolean = 6
+};
+
+template <class T>
+void append_binary(std::string& out, const T& value)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "");
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void append_binary_log_argument(std::string& out, const bool value)
+{
+  append_binary(out, BinaryLogArgument::boolean);
+  append_binary(out, std::uint8_t(value));
+}
+
+inline void append_binary_log_argument(std::string& out, const char value)
+{
+  append_binary(out, BinaryLogArgument::character);
+  append_binary(out, value);
+}
+
+template <class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+append_binary_log_argument(std::string& out, const T& value)
+{
+  append_binary(out, BinaryLogArgument::integer);
+  append_binary(out, std::int64_t(value));
+}
+
+template <class T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+append_binary_log_argument(std::string& out, const T& value)
+{
+  append_binary(out, BinaryLogArgument::unsigned_integer);
+  append_binary(out, std::uint64_t(value));
+}
+
+template <class T>
+typename std::enable_if<std::is_floating_point<T>::value>::type append_binary_log_argument(std::string& out,
+                                                                                             const T& value)
+{
+  append_binary(out, BinaryLogArgument::number);
+  append_binary(out, double(value));
+}
+
+inline void append_binary_log_argument(std::string& out, const char* value, const size_t size)
+{
+  append_binary(out, BinaryLogArgument::string);
+  append_binary(out, std::uint32_t(size));
+  out.append(value, size);
+}
+
+inline void append_binary_log_argument(std::string& out, const char* value)
+{
+  append_binary_log_argument(out, value, std::char_traits<char>::length(value));
+}
+
+inline void append_binary_log_argument(std::string& out, const std::string& value)
+{
+  append_binary_log_argument(out, value.data(), value.size());
+}
+
+//! all other types are formatted right away
+template <class T>
+typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_convertible<const T&, std::string>::value>::type
+append_binary_log_argument(std::string& out, const T& value)
+{
+  std::ostringstream text;
+  text << value;
+  append_binary_log_argument(out, text.str());
+}
+
+
+} // namespace internal
+
+
+/**
+ * \brief A format string of a binary log record, which is stored only once per BinaryLogSink.
+ *
+ *        Each {} in the format is replaced by the next argument when decoding, surplus arguments are appended.
+ *        Create one object per call site, most conveniently via DXTC_BINARY_LOG_FORMAT.
+ */
+class BinaryLogFormat
+{
+public:
+  explicit BinaryLogFormat(const std::string& format);
+
+  //! unique within the process
+  std::uint32_t id() const;
+
+  const std::string& format() const;
+
+private:
+  const std::uint32_t id_;
+  const std::string format_;
+}; // class BinaryLogFormat
+
+
+/**
+ * \brief Writes log records in a compact binary format to a file, formatting is deferred to BinaryLogReader or the
+ *        decode_binary_log.py script.
+ *
+ *        The file starts with a header (containing the MPI rank), followed by framed records: each format is stored
+ *        once before its first use, each message consists of the format id, the level, a thread number, the
+ *        nanoseconds since the creation of the sink and the raw arguments. Integers, floating point numbers,
+ *        characters, booleans and strings are stored as such, all other arguments are formatted via operator<< right
+ *        away. Use one file per rank:
+\code
+BinaryLogSink sink("log_p" + std::to_string(MPIHelper::getCollectiveCommunication().rank()) + ".bin");
+int flags = LOG_INFO;
+BinaryLogStream info(LOG_INFO, flags, sink);
+info.log(DXTC_BINARY_LOG_FORMAT("residual {} after {} steps"), residual, steps);
+info << "text is stored as a single string" << std::endl;
+\endcode
+ * \note  The format uses the native byte order, which is recorded in the header.
+ */
+class BinaryLogSink
+{
+public:
+  explicit BinaryLogSink(const std::string& filename,
+                         const int rank = MPIHelper::getCollectiveCommunication().rank());
+
+  ~BinaryLogSink();
+
+  template <class... Args>
+  void write(const int level, const BinaryLogFormat& format, const Args&... args)
+  {
+    auto& record = begin_message_(level, format);
+    using Expand = int[];
+    (void)Expand{0, (internal::append_binary_log_argument(record, args), 0)...};
+    end_message_(format, record);
+  }
+
+  void flush();
+
+private:
+  BinaryLogSink(const BinaryLogSink&) = delete;
+  BinaryLogSink& operator=(const BinaryLogSink&) = delete;
+
+  //! the calling thread's record, its frame filled in up to the arguments
+  std::string& begin_message_(const int level, const BinaryLogFormat& format);
+
+  //! writes the record, preceded by its format if that was not written yet
+  void end_message_(const BinaryLogFormat& format, std::string& record);
+
+  const std::chrono::steady_clock::time_point start_;
+  std::mutex mutex_;
+  std::ofstream file_;
+  std::vector<bool> written_formats_;
+}; // class BinaryLogSink
+
+
+//! stream buffer writing its content as a single string to a BinaryLogSink on sync
+class BinaryLogBuffer : public SuspendableStrBuffer
+{
+public:
+  BinaryLogBuffer(int loglevel, int& logflags, BinaryLogSink& sink);
+
+  //! writes a record with deferred formatting, if enabled
+  template <class... Args>
+  void log(const BinaryLogFormat& format, const Args&... args)
+  {
+    if (enabled())
+      sink_.write(loglevel_, format, args...);
+  }
+
+protected:
+  virtual int sync();
+
+private:
+  BinaryLogSink& sink_;
+  const int loglevel_;
+  std::mutex sync_mutex_;
+}; // class BinaryLogBuffer
+
+
+//! ostream compatible class writing to a BinaryLogSink, see BinaryLogSink for an example
+class BinaryLogStream : public LogStream
+{
+public:
+  BinaryLogStream(int loglevel, int& logflags, BinaryLogSink& sink);
+
+  //! \sa BinaryLogBuffer::log
+  template <class... Args>
+  void log(const BinaryLogFormat& format, const Args&... args)
+  {
+    buffer_.log(format, args...);
+  }
+
+private:
+  BinaryLogBuffer& buffer_;
+}; // class BinaryLogStream
+
+
+//! a decoded record of a binary log file
+struct BinaryLogRecord
+{
+  int rank;
+  int level;
+  std::uint32_t thread;
+  //! nanoseconds since the creation of the BinaryLogSink
+  std::uint64_t time;
+  //! the formatted message, text written via operator<< keeps its line breaks
+  std::string text;
+};
+
+
+//! reads the files written by BinaryLogSink
+class BinaryLogReader
+{
+public:
+  explicit BinaryLogReader(const std::string& filename);
+
+  int rank() const;
+
+  /**
+   * \brief decodes the next message into record
+   * \return false at the end of the file, which includes a last record truncated by a crash of the writing process
+   */
+  bool next(BinaryLogRecord& record);
+
+private:
+  //! reads the next framed record into payload_, returns its kind or 0 at the end of the file
+  std::uint8_t read_record_();
+
+  //! replaces the placeholders in format by the arguments in payload_, starting at position
+  std::string decode_(const std::string& format, size_t position) const;
+
+  const std::string filename_;
+  std::ifstream file_;
+  int rank_;
+  std::vector<std::string> formats_;
+  std::string payload_;
+}; // class BinaryLogReader
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+/**
+ * \brief A BinaryLogFormat created once per call site:
+\code
+stream.log(DXTC_BINARY_LOG_FORMAT("residual {} after {} steps"), residual, steps);
+\endcode
+ */
+#define DXTC_BINARY_LOG_FORMAT(format)                                                                                 \
+  ([]() -> const Dune::XT::Common::BinaryLogFormat& {                                                                  \
+    static const Dune::XT::Common::BinaryLogFormat dxtc_binary_log_format(format);                                     \
+    return dxtc_binary_log_format;                                                                                     \
+  }())
+
+#endif // DUNE_XT_COMMON_BINARY_LOGGING_HH
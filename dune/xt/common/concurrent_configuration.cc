@@ -0,0 +1,75 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include <thread>
+
+#include "concurrent_configuration.hh"
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+ConcurrentConfiguration::ConcurrentConfiguration(const Configuration& config)
+  : current_(new SnapshotType(make_state_(config)))
+  , epoch_(0)
+{}
+
+ConcurrentConfiguration::~ConcurrentConfiguration()
+{
+  delete current_.load();
+}
+
+ConcurrentConfiguration::SnapshotType ConcurrentConfiguration::snapshot() const
+{
+  const ReadSection section(*this);
+  return *current_.load();
+}
+
+bool ConcurrentConfiguration::has_key(const std::string& key) const
+{
+  return read([&](const Configuration& config) { return config.has_key(key); });
+}
+
+void ConcurrentConfiguration::add(const Configuration& other, const std::string sub_id, const bool overwrite)
+{
+  modify([&](Configuration& config) { config.add(other, sub_id, overwrite); });
+}
+
+void ConcurrentConfiguration::publish(const Configuration& config)
+{
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  publish_(make_state_(config));
+}
+
+ConcurrentConfiguration::SnapshotType ConcurrentConfiguration::make_state_(const Configuration& config)
+{
+  auto state = std::make_shared<Configuration>(config);
+  state->use_cache_ = false;
+  return state;
+}
+
+void ConcurrentConfiguration::publish_(SnapshotType next)
+{
+  const auto* previous = current_.exchange(new SnapshotType(std::move(next)));
+  // A reader which obtained previous registered in one of the counts before the exchange. New readers register in
+  // the count of the current epoch, so flipping the epoch before waiting for each count guarantees progress.
+  for (size_t ii = 0; ii < 2; ++ii) {
+    const auto epoch = epoch_++;
+    while (readers_[epoch % 2].count.load() != 0)
+      std::this_thread::yield();
+  }
+  // pinned snapshots keep the Configuration alive
+  delete previous;
+} // ... publish_(...)
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
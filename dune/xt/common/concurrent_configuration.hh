@@ -0,0 +1,167 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_CONCURRENT_CONFIGURATION_HH
+#define DUNE_XT_COMMON_CONCURRENT_CONFIGURATION_HH
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <dune/common/visibility.hh>
+
+#include <dune/xt/common/configuration.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+/**
+ * \brief A Configuration which may be read and modified concurrently.
+ *
+ *        The state is an immutable Configuration. Writers copy it, modify the copy and publish it in place of the
+ *        current one (read-copy-update), so readers never block and always see a consistent state. Writers are
+ *        serialized and wait until no reader uses the previous state any more, which is cheap since readers only
+ *        hold it for the duration of a single lookup. A thread may pin the current state for longer, e.g. for the
+ *        duration of a solve, see snapshot():
+\code
+const auto config = ConcurrentConfig().snapshot();
+const auto tolerance = config->get("solver.tolerance", 1e-10);
+\endcode
+ *        The states do not use the typed lookup cache of Configuration, which locks, so each lookup converts the
+ *        stored string.
+ * \note Modifying this from within read() deadlocks.
+ */
+class ConcurrentConfiguration
+{
+public:
+  typedef std::shared_ptr<const Configuration> SnapshotType;
+
+  explicit ConcurrentConfiguration(const Configuration& config = Configuration());
+
+  ConcurrentConfiguration(const ConcurrentConfiguration& other) = delete;
+
+  ~ConcurrentConfiguration();
+
+  ConcurrentConfiguration& operator=(const ConcurrentConfiguration& other) = delete;
+
+  //! \return the current state, which is kept alive and unchanged as long as the returned pointer is held
+  SnapshotType snapshot() const;
+
+  //! calls reader(config) with the current state, without pinning it
+  template <class Reader>
+  auto read(Reader&& reader) const -> decltype(reader(std::declval<const Configuration&>()))
+  {
+    const ReadSection section(*this);
+    return reader(**current_.load());
+  }
+
+  bool has_key(const std::string& key) const;
+
+  //! see Configuration::get(), the remaining arguments are forwarded
+  template <class T, class... Args>
+  typename internal::Typer<T>::type get(const std::string& key, Args&&... args) const
+  {
+    return read([&](const Configuration& config) { return config.get<T>(key, std::forward<Args>(args)...); });
+  }
+
+  //! see Configuration::get(), the remaining arguments are forwarded
+  template <class T, class... Args>
+  typename internal::Typer<T>::type get(const std::string& key, T def, Args&&... args) const
+  {
+    return read([&](const Configuration& config) { return config.get(key, def, std::forward<Args>(args)...); });
+  }
+
+  //! calls modifier(config) with a copy of the current state and publishes the copy afterwards
+  template <class Modifier>
+  void modify(Modifier&& modifier)
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    // writers are serialized, so the current state cannot be released meanwhile
+    auto next = std::make_shared<Configuration>(**current_.load());
+    modifier(*next);
+    next->use_cache_ = false;
+    publish_(std::move(next));
+  }
+
+  //! see Configuration::set()
+  template <class T>
+  void set(const std::string& key, const T& value, const bool overwrite = false)
+  {
+    modify([&](Configuration& config) { config.set(key, value, overwrite); });
+  }
+
+  //! see Configuration::add()
+  void add(const Configuration& other, const std::string sub_id = "", const bool overwrite = false);
+
+  //! replaces the current state by config
+  void publish(const Configuration& config);
+
+private:
+  //! marks the current thread as reader, so that writers do not release the state it may use
+  class ReadSection
+  {
+  public:
+    explicit ReadSection(const ConcurrentConfiguration& config)
+      : readers_(config.readers_[config.epoch_.load() % 2].count)
+    {
+      ++readers_;
+    }
+
+    ~ReadSection()
+    {
+      --readers_;
+    }
+
+  private:
+    std::atomic<size_t>& readers_;
+  }; // class ReadSection
+
+  //! separate cache lines for the reader counts, readers of the same epoch still share one
+  struct alignas(64) ReaderCount
+  {
+    std::atomic<size_t> count{0};
+  };
+
+  //! \return an immutable copy of config, which does not use the typed lookup cache
+  static SnapshotType make_state_(const Configuration& config);
+
+  //! replaces the current state and waits until no reader uses the previous one, callers hold write_mutex_
+  void publish_(SnapshotType next);
+
+  std::atomic<const SnapshotType*> current_;
+  mutable std::array<ReaderCount, 2> readers_;
+  std::atomic<size_t> epoch_;
+  std::mutex write_mutex_;
+}; // class ConcurrentConfiguration
+
+
+/**
+ * \brief global ConcurrentConfiguration instance, safe to use from several threads
+ * \note It is initialized with a copy of Config() on first use, later modifications of Config() are not reflected:
+ *       options read into Config() later (e.g. from a file or the command line) have to be published explicitly via
+ *       ConcurrentConfig().publish(Config()). ThreadManager::set_max_threads only writes threading.max_count to
+ *       ConcurrentConfig(), so publishing Config() afterwards replaces it by the value in Config().
+ */
+DUNE_EXPORT inline ConcurrentConfiguration& ConcurrentConfig()
+{
+  static ConcurrentConfiguration parameters(Config());
+  return parameters;
+}
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#define DXTC_CONCURRENT_CONFIG Dune::XT::Common::ConcurrentConfig()
+
+#endif // DUNE_XT_COMMON_CONCURRENT_CONFIGURATION_HH
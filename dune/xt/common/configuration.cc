@@ -120,6 +120,17 @@ void Configuration::set_logfile(const std::string logfile)
     test_create_directory(directory_only(logfile_));
 }
 
+std::string& Configuration::operator[](const std::string& key)
+{
+  invalidate_cache_();
+  return BaseType::operator[](key);
+}
+
+const std::string& Configuration::operator[](const std::string& key) const
+{
+  return BaseType::operator[](key);
+}
+
 // method definitions for Configuration
 bool Configuration::has_key(const std::string& key) const
 {
@@ -188,6 +199,7 @@ Configuration& Configuration::operator=(const Configuration& other)
     warn_on_default_access_ = other.warn_on_default_access_;
     log_on_exit_ = other.log_on_exit_;
     logfile_ = other.logfile_;
+    invalidate_cache_();
   }
   return *this;
 } // ... operator=(...)
@@ -233,6 +245,7 @@ void Configuration::read_command_line(int argc, char* argv[])
   if (boost::filesystem::exists(argv[1]))
     Dune::ParameterTreeParser::readINITree(argv[1], *this);
   Dune::ParameterTreeParser::readOptions(argc, argv, *this);
+  invalidate_cache_();
   // datadir and logdir may be given from the command line...
   setup_();
 } // readCommandLine
@@ -240,6 +253,7 @@ void Configuration::read_command_line(int argc, char* argv[])
 void Configuration::read_options(int argc, char* argv[])
 {
   Dune::ParameterTreeParser::readOptions(argc, argv, *this);
+  invalidate_cache_();
 }
 
 void Configuration::setup_()
@@ -271,6 +285,13 @@ void Configuration::add_tree_(const Configuration& other, const std::string sub_
   }
 } // ... add_tree_(...)
 
+void Configuration::invalidate_cache_()
+{
+  std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
+  ++cache_generation_;
+  cache_.clear();
+}
+
 ParameterTree Configuration::initialize(const std::string filename)
 {
   ParameterTree param_tree;
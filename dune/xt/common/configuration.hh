@@ -14,8 +14,16 @@
 #ifndef DUNE_XT_COMMON_CONFIGURATION_HH
 #define DUNE_XT_COMMON_CONFIGURATION_HH
 
+#include <atomic>
 #include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
 #include <type_traits>
+#include <typeindex>
+#include <vector>
 
 #include <boost/lexical_cast/bad_lexical_cast.hpp>
 
@@ -49,8 +57,68 @@ struct Typer
   typedef typename std::conditional<std::is_same<T, const char*>::value, std::string, T>::type type;
 };
 
+//! type-erased entry of the typed lookup cache of Configuration
+struct ConfigurationCacheEntryBase
+{
+  virtual ~ConfigurationCacheEntryBase() = default;
+};
+
+template <class T>
+struct ConfigurationCacheEntry : public ConfigurationCacheEntryBase
+{
+  ConfigurationCacheEntry(const size_t generation_in,
+                          T value_in,
+                          std::unique_ptr<const T> def_in,
+                          std::string source_in = std::string())
+    : generation(generation_in)
+    , value(std::move(value_in))
+    , def(std::move(def_in))
+    , source(std::move(source_in))
+  {}
+
+  //! the generation of the Configuration the value was converted in
+  const size_t generation;
+  const T value;
+  //! the default value value was converted from, if the key does not exist
+  const std::unique_ptr<const T> def;
+  //! the string value was converted from, if the key exists
+  const std::string source;
+}; // struct ConfigurationCacheEntry
+
+//! key, type, size and columns of a typed lookup
+typedef std::tuple<std::string, std::type_index, size_t, size_t> ConfigurationCacheKey;
+
+typedef std::map<ConfigurationCacheKey, std::shared_ptr<const ConfigurationCacheEntryBase>> ConfigurationCache;
+
+template <class T>
+auto cached_default_matches(const T& cached, const T& requested, int) -> decltype(bool(cached == requested))
+{
+  return cached == requested;
+}
+
+//! types without comparison always convert the default anew
+template <class T>
+bool cached_default_matches(const T& /*cached*/, const T& /*requested*/, long)
+{
+  return false;
+}
+
 } // namespace internal
 
+template <class T>
+class ConfigHandle;
+
+class ConcurrentConfiguration;
+
+/**
+ * \note The values returned by get() are cached per key, type and size. A cached value is only reused as long as the
+ *       stored string it was converted from is unchanged, so get() also notices modifications which bypass this
+ *       class, i.e. writes through the reference returned by operator[] or through the underlying ParameterTree (e.g.
+ *       by ParameterTreeParser::readINITree() or in a subtree obtained from ParameterTree::sub()). A ConfigHandle
+ *       only resolves its key again after a modification through the methods of this class, so it misses those.
+ * \note Concurrent calls of the const methods are thread-safe, modifications must not happen concurrently to any
+ *       other access. Lookups in the cache lock (see ConcurrentConfiguration for lock-free reads).
+ */
 class Configuration : public Dune::ParameterTree
 {
   typedef Dune::ParameterTree BaseType;
@@ -120,6 +188,12 @@ some_function_which_expects_a_config({{"type", "custom"}, {"tolerance", "1e-10"}
    * \{
    */
 
+  /** \note Modifications through the returned reference are noticed by get(), but not by a ConfigHandle which
+   *        resolves the key in the meantime, see the class documentation. **/
+  std::string& operator[](const std::string& key);
+
+  const std::string& operator[](const std::string& key) const;
+
   //! check if key is existing in tree_
   bool has_key(const std::string& key) const;
 
@@ -212,6 +286,7 @@ some_function_which_expects_a_config({{"type", "custom"}, {"tolerance", "1e-10"}
                                    << "no overwrite!\n======================\n"
                                    << report_string());
     BaseType::operator[](key) = to_string(value);
+    invalidate_cache_();
   } // ... set(..., T, ...)
 
   void set(const std::string& key, const char* value, const bool overwrite = false);
@@ -268,22 +343,47 @@ some_function_which_expects_a_config({{"type", "custom"}, {"tolerance", "1e-10"}
   void read_options(int argc, char* argv[]);
 
 private:
+  template <class T>
+  friend class ConfigHandle;
+  friend class ConcurrentConfiguration;
+
   void setup_();
 
+  //! drops all cached values, to be called after each modification of the tree
+  void invalidate_cache_();
+
   void add_tree_(const Configuration& other, const std::string sub_id, const bool overwrite);
 
-  //! get value from tree and validate with validator
+  //! get value from tree (or the cache) and validate with validator
   template <typename T, class Validator>
   T get_valid_value(const std::string& key,
                     T def,
                     const ValidatorInterface<typename internal::Typer<T>::type, Validator>& validator,
                     const size_t size,
                     const size_t cols) const
+  {
+    if (!use_cache_) {
+      const T val = convert_value_(key, def, size, cols);
+      if (validator(val))
+        return val;
+      else
+        DUNE_THROW(Exceptions::configuration_error, validator.msg(val));
+    }
+    const auto entry = cached_value_(key, &def, size, cols);
+    const T& val = entry->value;
+    if (validator(val))
+      return val;
+    else
+      DUNE_THROW(Exceptions::configuration_error, validator.msg(val));
+  } // ... get_valid_value(...)
+
+  //! get value from tree, bypassing the cache
+  template <typename T>
+  T convert_value_(const std::string& key, const T& def, const size_t size, const size_t cols) const
   {
     std::string valstring = BaseType::get(key, to_string(def));
-    T val;
     try {
-      val = from_string<T>(valstring, size, cols);
+      return from_string<T>(valstring, size, cols);
     } catch (boost::bad_lexical_cast& e) {
       DUNE_THROW(Exceptions::external_error,
                  "Error in boost while converting the string '"
@@ -295,11 +395,50 @@ private:
                      << valstring << "' to type '" << Typename<T>::value() << "':\n"
                      << e.what() << "\non accessing key " << key << " with default " << to_string(def));
     }
-    if (validator(val))
-      return val;
+  } // ... convert_value_(...)
+
+  /** \brief looks up the value of key converted to T in the typed cache, converts and caches it if necessary
+   *  \param def default value, used if key does not exist, or nullptr if there is none
+   *  \note Cached values are only reused if they were converted from the currently stored string, or from an equal
+   *        default if the key does not exist, so modifications bypassing invalidate_cache_() are noticed as well.
+   */
+  template <typename T>
+  std::shared_ptr<const internal::ConfigurationCacheEntry<T>>
+  cached_value_(const std::string& key, const T* def, const size_t size, const size_t cols) const
+  {
+    typedef internal::ConfigurationCacheEntry<T> EntryType;
+    const internal::ConfigurationCacheKey cache_key(key, std::type_index(typeid(T)), size, cols);
+    const std::string* stored = has_key(key) ? &BaseType::operator[](key) : nullptr;
+    if (use_cache_) {
+      std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+      const auto result = cache_.find(cache_key);
+      if (result != cache_.end()) {
+        auto entry = std::static_pointer_cast<const EntryType>(result->second);
+        if (stored ? (!entry->def && entry->source == *stored)
+                   : (entry->def && def && internal::cached_default_matches(*entry->def, *def, 0)))
+          return entry;
+      }
+    }
+    const size_t generation = cache_generation_;
+    std::shared_ptr<const EntryType> entry;
+    if (stored)
+      entry = std::make_shared<EntryType>(
+          generation, convert_value_(key, def ? *def : T(), size, cols), nullptr, *stored);
+    else if (def)
+      entry = std::make_shared<EntryType>(
+          generation, convert_value_(key, *def, size, cols), std::unique_ptr<const T>(new T(*def)));
     else
-      DUNE_THROW(Exceptions::configuration_error, validator.msg(val));
-  } // ... get_valid_value(...)
+      DUNE_THROW(Exceptions::configuration_error,
+                 "This Configuration (see below) does not contain the key '"
+                     << key << "' and there was no default value provided!\n======================\n"
+                     << report_string());
+    if (!use_cache_)
+      return entry;
+    std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    if (cache_generation_ == generation)
+      cache_[cache_key] = entry;
+    return entry;
+  } // ... cached_value_(...)
 
   /** \brief all public get signatures call this one
    *  \param key requested key
@@ -351,6 +490,11 @@ private:
   bool warn_on_default_access_;
   bool log_on_exit_;
   std::string logfile_;
+  //! false for the immutable states of a ConcurrentConfiguration, which are read without locking
+  bool use_cache_ = true;
+  mutable std::shared_timed_mutex cache_mutex_;
+  mutable internal::ConfigurationCache cache_;
+  std::atomic<size_t> cache_generation_{0};
 }; // class Configuration
 
 std::ostream& operator<<(std::ostream& out, const Configuration& config);
@@ -359,6 +503,120 @@ bool operator==(const Configuration& left, const Configuration& right);
 
 bool operator!=(const Configuration& left, const Configuration& right);
 
+/**
+ * \brief Resolves a key of a Configuration once, after which the converted value is available in O(1).
+ *
+ *        The value is taken from the typed lookup cache of the Configuration. Once the Configuration is modified
+ *        through its methods (see the note of Configuration), the key is resolved again on the next access, so the
+ *        handle may be kept, e.g. as a member of a solver:
+\code
+const ConfigHandle<double> tolerance(DXTC_CONFIG, "solver.tolerance", 1e-10);
+while (residual > tolerance.get())
+  ...
+\endcode
+ *        Concurrent calls of get() are thread-safe and do not lock unless the key has to be resolved again.
+ * \note The Configuration has to outlive the handle. Use Configuration::get() for validated access.
+ */
+template <class T>
+class ConfigHandle
+{
+public:
+  typedef typename internal::Typer<T>::type ValueType;
+
+  //! \throws Exceptions::configuration_error if key does not exist
+  ConfigHandle(const Configuration& config, std::string key)
+    : config_(config)
+    , key_(std::move(key))
+    , size_(0)
+    , cols_(0)
+    , current_(nullptr)
+  {
+    resolve();
+  }
+
+  /**
+   * \param size Determines the size of a vector (or the rows of a matrix) as in Configuration::get().
+   * \param cols Determines the number of columns of a matrix as in Configuration::get().
+   */
+  ConfigHandle(const Configuration& config,
+               std::string key,
+               ValueType def,
+               const size_t size = 0,
+               const size_t cols = 0)
+    : config_(config)
+    , key_(std::move(key))
+    , def_(new ValueType(std::move(def)))
+    , size_(size)
+    , cols_(cols)
+    , current_(nullptr)
+  {
+    resolve();
+  }
+
+  ConfigHandle(const ConfigHandle& other)
+    : config_(other.config_)
+    , key_(other.key_)
+    , def_(other.def_ ? new ValueType(*other.def_) : nullptr)
+    , size_(other.size_)
+    , cols_(other.cols_)
+    , current_(nullptr)
+  {
+    resolve();
+  }
+
+  ConfigHandle& operator=(const ConfigHandle& other) = delete;
+
+  /**
+   * \return the current value of key
+   * \note The handle keeps the value of the previous resolution alive, so concurrent calls of get() during a
+   *       resolution are safe. The returned reference is invalidated once the key has been resolved twice more, i.e.
+   *       it must not be kept across two modifications of the Configuration.
+   */
+  const ValueType& get() const
+  {
+    const auto* entry = current_.load(std::memory_order_acquire);
+    if (entry->generation != config_.cache_generation_.load(std::memory_order_acquire))
+      entry = resolve();
+    return entry->value;
+  }
+
+  const ValueType& operator*() const
+  {
+    return get();
+  }
+
+  const std::string& key() const
+  {
+    return key_;
+  }
+
+private:
+  typedef internal::ConfigurationCacheEntry<ValueType> EntryType;
+
+  const EntryType* resolve() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = config_.cached_value_(key_, def_.get(), size_, cols_);
+    // concurrent readers may still use the previous entry, older ones can only be in use across a modification
+    if (entry != current_entry_) {
+      previous_entry_ = std::move(current_entry_);
+      current_entry_ = entry;
+    }
+    current_.store(entry.get(), std::memory_order_release);
+    return entry.get();
+  }
+
+  const Configuration& config_;
+  const std::string key_;
+  const std::unique_ptr<const ValueType> def_;
+  const size_t size_;
+  const size_t cols_;
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<const EntryType> current_entry_;
+  mutable std::shared_ptr<const EntryType> previous_entry_;
+  mutable std::atomic<const EntryType*> current_;
+}; // class ConfigHandle
+
 //! global Configuration instance
 DUNE_EXPORT inline Configuration& Config()
 {
@@ -0,0 +1,162 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_HISTOGRAM_HH
+#define DUNE_XT_COMMON_HISTOGRAM_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+/** \brief fixed-size histogram of unsigned integer values with logarithmically growing, linearly subdivided buckets
+ *
+ *  Values below sub_bucket_count are counted exactly, larger values in buckets whose width is at most a fraction
+ *  2^-(sub_bucket_bits - 1) of their lower bound (as in HdrHistogram). So the whole range of std::uint64_t is covered
+ *  by bucket_count buckets and percentiles are exact up to that relative error. Count, minimum and maximum are exact.
+ *
+ *  Adding a value neither allocates nor locks, the histogram is meant to be owned by a single thread and merged
+ *  afterwards.
+ **/
+class LogLinearHistogram
+{
+public:
+  static constexpr unsigned int sub_bucket_bits = 5;
+  static constexpr std::size_t sub_bucket_count = std::size_t(1) << sub_bucket_bits;
+  static constexpr std::size_t sub_bucket_half_count = sub_bucket_count / 2;
+  static constexpr std::size_t bucket_count = (66 - sub_bucket_bits) * sub_bucket_half_count;
+  typedef std::array<std::uint64_t, bucket_count> CountsType;
+
+  LogLinearHistogram()
+  {
+    clear();
+  }
+
+  //! builds a histogram from (e.g. reduced) bucket counts and the exact minimum and maximum
+  LogLinearHistogram(const CountsType& counts_in, const std::uint64_t min_in, const std::uint64_t max_in)
+    : counts_(counts_in)
+    , count_(0)
+    , min_(min_in)
+    , max_(max_in)
+  {
+    for (const auto& bucket_count_value : counts_)
+      count_ += bucket_count_value;
+  }
+
+  void clear()
+  {
+    counts_.fill(0);
+    count_ = 0;
+    min_ = std::numeric_limits<std::uint64_t>::max();
+    max_ = 0;
+  }
+
+  void add(const std::uint64_t value)
+  {
+    ++counts_[bucket(value)];
+    ++count_;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  void merge(const LogLinearHistogram& other)
+  {
+    for (std::size_t ii = 0; ii < bucket_count; ++ii)
+      counts_[ii] += other.counts_[ii];
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  std::uint64_t count() const
+  {
+    return count_;
+  }
+
+  //! \note is std::numeric_limits<std::uint64_t>::max() if nothing was added
+  std::uint64_t min() const
+  {
+    return min_;
+  }
+
+  std::uint64_t max() const
+  {
+    return max_;
+  }
+
+  const CountsType& counts() const
+  {
+    return counts_;
+  }
+
+  /** \return the smallest value (up to the bucket width) such that at least percent of all added values are less or
+   *          equal, 0 if nothing was added
+   *  \param percent in [0, 100] **/
+  std::uint64_t percentile(const double percent) const
+  {
+    if (count_ == 0)
+      return 0;
+    const auto rank = std::max(
+        std::uint64_t(1),
+        std::min(count_, static_cast<std::uint64_t>(std::ceil(percent / 100. * static_cast<double>(count_)))));
+    std::uint64_t cumulated = 0;
+    for (std::size_t ii = 0; ii < bucket_count; ++ii) {
+      cumulated += counts_[ii];
+      if (cumulated >= rank) {
+        // middle of the bucket, which cannot be below the minimum or above the maximum
+        const auto middle = lower_bound(ii) + (bucket_width(ii) - 1) / 2;
+        return std::max(min_, std::min(max_, middle));
+      }
+    }
+    return max_;
+  } // ... percentile(...)
+
+  static std::size_t bucket(const std::uint64_t value)
+  {
+    if (value < sub_bucket_count)
+      return static_cast<std::size_t>(value);
+    unsigned int magnitude = 0;
+    for (auto tmp = value; tmp > 1; tmp >>= 1)
+      ++magnitude;
+    const unsigned int shift = magnitude - (sub_bucket_bits - 1);
+    return shift * sub_bucket_half_count + static_cast<std::size_t>(value >> shift);
+  }
+
+  static std::uint64_t lower_bound(const std::size_t bucket_index)
+  {
+    if (bucket_index < sub_bucket_count)
+      return bucket_index;
+    const std::size_t shift = bucket_index / sub_bucket_half_count - 1;
+    return std::uint64_t(bucket_index - shift * sub_bucket_half_count) << shift;
+  }
+
+  static std::uint64_t bucket_width(const std::size_t bucket_index)
+  {
+    if (bucket_index < sub_bucket_count)
+      return 1;
+    return std::uint64_t(1) << (bucket_index / sub_bucket_half_count - 1);
+  }
+
+private:
+  CountsType counts_;
+  std::uint64_t count_;
+  std::uint64_t min_;
+  std::uint64_t max_;
+}; // class LogLinearHistogram
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_HISTOGRAM_HH
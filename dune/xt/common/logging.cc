@@ -34,11 +34,18 @@ Logging::Logging()
 
 void Logging::deinit()
 {
+  enabled_streams_() = 0;
   streammap_.clear();
+  // the streams queued their remaining output on destruction
+  if (async_backend_)
+    async_backend_->flush();
+  // writes what was not collated yet on each rank itself
+  aggregator_.reset();
   if ((logflags_ & LOG_FILE) != 0) {
     logfile_ << std::endl;
     logfile_.close();
   }
+  rotating_logfile_.close();
 }
 
 Logging::~Logging()
@@ -46,29 +53,49 @@ Logging::~Logging()
   deinit();
 }
 
-void Logging::create(int logflags, const std::string logfile, const std::string datadir, const std::string _logdir)
+void Logging::create(int logflags,
+                     const std::string logfile,
+                     const std::string datadir,
+                     const std::string _logdir,
+                     const LogRotationOptions rotation)
 {
   using namespace boost::filesystem;
   const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+  const bool aggregate = ((logflags & LOG_AGGREGATE) != 0);
+  // only the aggregating ranks write
+  const bool writing = !aggregate || get_aggregator_().aggregating();
   boost::format log_fn("%s%s");
-  if (comm.size() > 1) {
+  if (comm.size() > 1 && !(aggregate && !aggregator_options_.per_node)) {
     const std::string rank = (boost::format("%08d") % comm.rank()).str();
     log_fn = boost::format("%s_p" + rank + "_%s");
   }
+  // queued output still refers to the previous file
+  if (async_backend_)
+    async_backend_->flush();
   logflags_ = logflags;
   path logdir = path(datadir) / _logdir;
   filename_ = logdir / (log_fn % logfile % ".log").str();
-  test_create_directory(filename_.string());
-  const bool file_logging = ((logflags_ & LOG_FILE) != 0);
+  if (writing)
+    test_create_directory(filename_.string());
+  const bool file_logging = writing && ((logflags_ & LOG_FILE) != 0);
   if (file_logging) {
-    logfile_.open(filename_);
-    DXT_ASSERT(logfile_.is_open());
+    if (logfile_.is_open())
+      logfile_.close();
+    // closing compresses the last segment
+    rotating_logfile_.close();
+    if (rotation.enabled())
+      rotating_logfile_.open(filename_.string(), rotation);
+    else {
+      logfile_.open(filename_);
+      DXT_ASSERT(logfile_.is_open());
+    }
   }
 
   for (const auto id : streamIDs_) {
     flagmap_[id] = logflags;
-    streammap_[id] = Dune::XT::Common::make_unique<DualLogStream>(id, flagmap_[id], std::cout, logfile_);
+    streammap_[id] = make_stream_(id);
   }
+  update_enabled_streams_();
 } // create
 
 void Logging::set_prefix(std::string prefix)
@@ -77,12 +104,47 @@ void Logging::set_prefix(std::string prefix)
   create(logflags_, prefix);
 } // set_prefix
 
+void Logging::set_async(const bool enable, const AsyncLogOptions options)
+{
+  flush();
+  auto previous = std::move(async_backend_);
+  if (enable)
+    async_backend_ = Dune::XT::Common::make_unique<AsyncLogBackend>(options);
+  // streams are only replaced after create()
+  if (!flagmap_.empty())
+    for (const auto id : streamIDs_)
+      streammap_[id] = make_stream_(id);
+  // previous writes out everything the replaced streams queued on destruction
+} // set_async
+
+bool Logging::async() const
+{
+  return bool(async_backend_);
+}
+
+void Logging::set_aggregator_options(const LogAggregatorOptions options)
+{
+  aggregator_options_ = options;
+}
+
+void Logging::collate(const bool complete)
+{
+  if (!aggregator_)
+    return;
+  flush();
+  if (complete)
+    aggregator_->finish();
+  else
+    aggregator_->collate();
+} // collate
+
 void Logging::set_stream_flags(int streamID, int flags)
 {
   DXT_ASSERT(flagmap_.find(streamID) != flagmap_.end());
   // this might result in logging to diff targtes, so we flush the current targets
   flush();
   flagmap_[streamID] = flags;
+  update_enabled_streams_();
 }
 
 int Logging::get_stream_flags(int streamID) const
@@ -111,6 +173,8 @@ void Logging::flush()
     DXT_ASSERT(pair.second);
     pair.second->flush();
   }
+  if (async_backend_)
+    async_backend_->flush();
 } // flush
 
 int Logging::add_stream(int flags)
@@ -120,8 +184,8 @@ int Logging::add_stream(int flags)
   int streamID = streamID_int;
   streamIDs_.push_back(streamID);
   flagmap_[streamID] = (flags | streamID);
-  streammap_[streamID] =
-      Dune::XT::Common::make_unique<DualLogStream>(streamID, flagmap_[streamID], std::cout, logfile_);
+  streammap_[streamID] = make_stream_(streamID);
+  update_enabled_streams_();
   return streamID_int;
 } // add_stream
 
@@ -130,6 +194,7 @@ void Logging::resume(LogStream::PriorityType prio)
   for (auto& pair : streammap_) {
     pair.second->resume(prio);
   }
+  update_enabled_streams_();
 } // resume
 
 void Logging::suspend(LogStream::PriorityType prio)
@@ -137,8 +202,50 @@ void Logging::suspend(LogStream::PriorityType prio)
   for (auto& pair : streammap_) {
     pair.second->suspend(prio);
   }
+  update_enabled_streams_();
 } // suspend
 
+std::unique_ptr<LogStream> Logging::make_stream_(int streamID)
+{
+  if ((flagmap_[streamID] & LOG_AGGREGATE) != 0)
+    return Dune::XT::Common::make_unique<AggregatedLogStream>(streamID, flagmap_[streamID], get_aggregator_());
+  if (async_backend_)
+    return Dune::XT::Common::make_unique<AsyncLogStream>(
+        streamID, flagmap_[streamID], *async_backend_, std::cout, file_());
+  return Dune::XT::Common::make_unique<DualLogStream>(streamID, flagmap_[streamID], std::cout, file_());
+}
+
+LogAggregator& Logging::get_aggregator_()
+{
+  if (!aggregator_)
+    aggregator_ = Dune::XT::Common::make_unique<LogAggregator>(
+        [this](const int flags, const std::string& text) {
+          if ((flags & LOG_CONSOLE) != 0)
+            std::cout << text << std::flush;
+          if ((flags & LOG_FILE) != 0 && (logfile_.is_open() || rotating_logfile_.is_open()))
+            file_() << text << std::flush;
+        },
+        aggregator_options_);
+  return *aggregator_;
+} // get_aggregator_
+
+std::ostream& Logging::file_()
+{
+  if (rotating_logfile_.is_open())
+    return rotating_logfile_;
+  return logfile_;
+}
+
+void Logging::update_enabled_streams_()
+{
+  int streams = 0;
+  // the flags of suspended streams are LOG_NONE
+  for (const auto& pair : flagmap_)
+    if ((pair.second & pair.first) != 0)
+      streams |= pair.first;
+  enabled_streams_() = streams;
+}
+
 } // namespace Common
 } // namespace XT
 } // namespace Dune
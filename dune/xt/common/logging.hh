@@ -16,7 +16,9 @@
 #ifndef DUNE_XT_COMMON_LOGGING_HH
 #define DUNE_XT_COMMON_LOGGING_HH
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <mutex>
 
@@ -27,7 +29,10 @@
 #include <boost/filesystem/fstream.hpp>
 #include <dune/xt/common/reenable_warnings.hh>
 
+#include <dune/xt/common/aggregated_logging.hh>
+#include <dune/xt/common/async_logging.hh>
 #include <dune/xt/common/logstreams.hh>
+#include <dune/xt/common/rotating_logging.hh>
 
 namespace Dune {
 namespace XT {
@@ -52,17 +57,47 @@ public:
   /** \brief setup loglevel, logfilename
    *  \param logflags any OR'd combination of flags
    *  \param logfile filename for log, can contain paths, but creation will fail if dir is non-existant
+   *  \param rotation if enabled, the log file is a RotatingFileStream, see LogRotationOptions
    **/
   void create(int logflags = LogDefault,
               const std::string logfile = "dune_xt_common_log",
               const std::string datadir = "data",
-              const std::string _logdir = std::string("log"));
+              const std::string _logdir = std::string("log"),
+              const LogRotationOptions rotation = LogRotationOptions());
 
   //! \attention This will probably not do wht we want it to!
   void set_prefix(std::string prefix);
+
+  /** \brief switches all streams to asynchronous output via an AsyncLogBackend (or back)
+   *  \note  LogStream::flush() then only queues the output, flush() also waits until it is written.
+   **/
+  void set_async(const bool enable, const AsyncLogOptions options = AsyncLogOptions());
+  bool async() const;
+
+  /** \brief options of the LogAggregator behind all streams with the LOG_AGGREGATE flag
+   *  \note  Only has an effect before the first such stream is created, which creates the LogAggregator collectively.
+   **/
+  void set_aggregator_options(const LogAggregatorOptions options);
+
+  /** \brief passes the output of all streams with the LOG_AGGREGATE flag to the aggregating rank, collective
+   *  \param complete waits until everything is written, otherwise only a new round is started, see
+   *         LogAggregator::collate()
+   *  \note  Call collate(true) on all ranks before the end of the program, the destructor is not collective and writes
+   *         the remaining output on each rank itself, see LogAggregator::~LogAggregator().
+   **/
+  void collate(const bool complete = false);
+
   void set_stream_flags(int streamID, int flags);
   int get_stream_flags(int streamID) const;
 
+  /** \brief whether the stream streamID currently accepts output, a single relaxed atomic load
+   *  \note  Streams suspended directly via LogStream::suspend() still count as enabled, see DXTC_LOG_INFO_IF_ENABLED.
+   **/
+  static bool enabled(const int streamID)
+  {
+    return (enabled_streams_().load(std::memory_order_relaxed) & streamID) != 0;
+  }
+
   /** \name forwarded Log functions
    * \{
    */
@@ -93,7 +128,7 @@ public:
     return emptyLogStream_;
   }
 
-  //! flush all active streams
+  //! flush all active streams (and write all queued output in asynchronous mode)
   void flush();
   //! creates a new LogStream with given flags, returns new ID
   int add_stream(int flags);
@@ -134,9 +169,29 @@ public:
   };
 
 private:
+  //! an AggregatedLogStream, DualLogStream or an AsyncLogStream for streamID, depending on the flags and the mode
+  std::unique_ptr<LogStream> make_stream_(int streamID);
+
+  //! creates aggregator_ on first use, collective
+  LogAggregator& get_aggregator_();
+
+  //! the rotating log file, if open, logfile_ otherwise
+  std::ostream& file_();
+
+  //! has to be called whenever flagmap_ changes
+  void update_enabled_streams_();
+
+  //! the ids of all enabled streams, static (there is only one Logging) to spare the initialization check of Logger()
+  static std::atomic<int>& enabled_streams_()
+  {
+    static std::atomic<int> streams(0);
+    return streams;
+  }
+
   boost::filesystem::path filename_;
   boost::filesystem::path filenameWoTime_;
   boost::filesystem::ofstream logfile_;
+  RotatingFileStream rotating_logfile_;
   typedef std::map<int, int> FlagMap;
   FlagMap flagmap_;
   typedef std::map<int, std::unique_ptr<LogStream>> StreamMap;
@@ -145,6 +200,9 @@ private:
   IdVec streamIDs_;
   int logflags_;
   EmptyLogStream emptyLogStream_;
+  std::unique_ptr<AsyncLogBackend> async_backend_;
+  LogAggregatorOptions aggregator_options_;
+  std::unique_ptr<LogAggregator> aggregator_;
 
   friend Logging& Logger();
   // satisfy stricter warnings wrt copying
@@ -168,6 +226,30 @@ DUNE_EXPORT inline Logging& Logger()
 #define DXTC_LOG_ERROR DXTC_LOG.error()
 #define DXTC_LOG_DEVNULL DXTC_LOG.devnull()
 
+/**
+ * \brief Like DXTC_LOG_INFO etc., but nothing written to the stream is evaluated if the stream is disabled:
+\code
+DXTC_LOG_DEBUG_IF_ENABLED << "residual: " << compute_residual() << std::endl;
+\endcode
+ *        Output below DUNE_XT_COMMON_LOGGING_MIN_LEVEL is removed at compile time, otherwise a disabled stream costs a
+ *        single atomic load, see Logging::enabled().
+ * \note  These are statements, use DXTC_LOG_INFO etc. to obtain the stream itself.
+ */
+#define DXTC_LOG_STREAM_IF_ENABLED(streamID)                                                                           \
+  DXTC_LOG_IF(Dune::XT::Common::Logging::enabled(streamID), DXTC_LOG.get_stream(streamID))
+#define DXTC_LOG_DEBUG_IF_ENABLED                                                                                      \
+  DXTC_LOG_IF(DUNE_XT_COMMON_LOGGING_MIN_LEVEL <= 0                                                                    \
+                  && Dune::XT::Common::Logging::enabled(Dune::XT::Common::LOG_DEBUG),                                  \
+              DXTC_LOG_DEBUG)
+#define DXTC_LOG_INFO_IF_ENABLED                                                                                       \
+  DXTC_LOG_IF(DUNE_XT_COMMON_LOGGING_MIN_LEVEL <= 1                                                                    \
+                  && Dune::XT::Common::Logging::enabled(Dune::XT::Common::LOG_INFO),                                   \
+              DXTC_LOG_INFO)
+#define DXTC_LOG_ERROR_IF_ENABLED                                                                                      \
+  DXTC_LOG_IF(DUNE_XT_COMMON_LOGGING_MIN_LEVEL <= 2                                                                    \
+                  && Dune::XT::Common::Logging::enabled(Dune::XT::Common::LOG_ERROR),                                  \
+              DXTC_LOG_ERROR)
+
 #define DXTC_LOG_INFO_0                                                                                                \
   (Dune::MPIHelper::getCollectiveCommunication().rank() == 0 ? DXTC_LOG.info() : DXTC_LOG.devnull())
 #define DXTC_LOG_DEBUG_0                                                                                               \
@@ -195,7 +195,7 @@ int CombinedBuffer::sync()
   return ret;
 }
 
-DualLogStream::DualLogStream(int loglevel, int& logflags, std::ostream& outstream, std::ofstream& file)
+DualLogStream::DualLogStream(int loglevel, int& logflags, std::ostream& outstream, std::ostream& file)
   : LogStream(new CombinedBuffer(
         loglevel,
         logflags,
@@ -25,6 +25,14 @@
 #include "memory.hh"
 #include "string.hh"
 
+/**
+ * \brief Log output below this level is removed at compile time by DXTC_LOG_DEBUG_IF_ENABLED, DXTC_TIMED_LOG_DEBUG
+ *        and friends: 0 keeps everything, 1 removes debug output, 2 also removes info output, 3 removes all output.
+ */
+#ifndef DUNE_XT_COMMON_LOGGING_MIN_LEVEL
+#  define DUNE_XT_COMMON_LOGGING_MIN_LEVEL 0
+#endif
+
 namespace Dune {
 namespace XT {
 namespace Common {
@@ -37,7 +45,9 @@ enum LogFlags
   LOG_DEBUG = 8,
   LOG_CONSOLE = 16,
   LOG_FILE = 32,
-  LOG_NEXT = 64
+  //! collect the output of all MPI ranks on one rank, see LogAggregator and Logging::collate (collective creation)
+  LOG_AGGREGATE = 64,
+  LOG_NEXT = 128
 };
 static constexpr auto LogMax = LOG_INFO | LOG_ERROR | LOG_DEBUG | LOG_CONSOLE | LOG_FILE;
 static constexpr auto LogDefault = LOG_INFO | LOG_ERROR | LOG_CONSOLE;
@@ -72,12 +82,12 @@ protected:
   virtual std::streamsize xsputn(const char_type* s, std::streamsize count);
   virtual int_type overflow(int_type ch = traits_type::eof());
 
-private:
   inline bool enabled() const
   {
     return (!is_suspended_) && (logflags_ & loglevel_);
   }
 
+private:
   SuspendableStrBuffer(const SuspendableStrBuffer&) = delete;
 
   int& logflags_;
@@ -255,7 +265,7 @@ public:
 class DualLogStream : public LogStream
 {
 public:
-  DualLogStream(int loglevel, int& logflags, std::ostream& out, std::ofstream& file);
+  DualLogStream(int loglevel, int& logflags, std::ostream& out, std::ostream& file);
 }; // class OstreamLogStream
 
 //! /dev/null
@@ -270,8 +280,29 @@ int dev_null_logflag;
 EmptyLogStream dev_null(dev_null_logflag);
 } // namespace
 
+namespace internal {
+
+
+//! turns a stream expression into a void expression, see DXTC_LOG_IF
+struct LogVoidify
+{
+  void operator&(const std::ostream&) const {}
+};
+
+
+} // namespace internal
+
 } // namespace Common
 } // namespace XT
 } // namespace Dune
 
+/**
+ * \brief Writes to stream only if condition holds, the stream and everything written to it is not even evaluated
+ *        otherwise:
+\code
+DXTC_LOG_IF(verbose, std::cout) << expensive_to_compute() << std::endl;
+\endcode
+ */
+#define DXTC_LOG_IF(condition, stream) !(condition) ? (void)0 : Dune::XT::Common::internal::LogVoidify() & (stream)
+
 #endif // LOGSTREAMS_HH
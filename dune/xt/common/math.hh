@@ -21,6 +21,7 @@
 #include <iostream>
 #include <type_traits>
 #include <complex>
+#include <tuple>
 
 #include <dune/xt/common/disable_warnings.hh>
 #include <boost/accumulators/accumulators.hpp>
@@ -38,6 +39,7 @@
 #include <dune/common/deprecated.hh>
 #include <dune/common/promotiontraits.hh>
 
+#include <dune/xt/common/reproducible_sum.hh>
 #include <dune/xt/common/type_traits.hh>
 
 namespace Dune {
@@ -137,14 +139,20 @@ T absolute_difference(T a, T b)
 }
 
 
-//! a vector wrapper for continiously updating min,max,avg of some element type vector
-template <class ElementType>
+/** a vector wrapper for continiously updating min,max,avg of some element type vector
+ *  \tparam mode SummationMode::reproducible computes sum and average of double or float elements exactly (see
+ *          ReproducibleSum), so they do not depend on the order of the elements **/
+template <class ElementType, SummationMode mode = SummationMode::fast>
 class MinMaxAvg
 {
   static_assert(!is_complex<ElementType>::value, "complex accumulation not supported");
+  static constexpr bool exact =
+      (mode == SummationMode::reproducible)
+      && (std::is_same<ElementType, double>::value || std::is_same<ElementType, float>::value);
+  typedef std::integral_constant<bool, exact> ExactType;
 
 protected:
-  typedef MinMaxAvg<ElementType> ThisType;
+  typedef MinMaxAvg<ElementType, mode> ThisType;
 
 public:
   MinMaxAvg() {}
@@ -154,7 +162,8 @@ public:
   {
     static_assert((boost::is_same<ElementType, typename stl_container_type::value_type>::value),
                   "cannot assign mismatching types");
-    acc_ = std::for_each(elements.begin(), elements.end(), acc_);
+    for (const auto& element : elements)
+      operator()(element);
   }
 
   std::size_t count() const
@@ -163,7 +172,7 @@ public:
   }
   ElementType sum() const
   {
-    return boost::accumulators::sum(acc_);
+    return sum(ExactType());
   }
   ElementType min() const
   {
@@ -175,13 +184,13 @@ public:
   }
   ElementType average() const
   {
-    // for integer ElementType this just truncates from floating-point
-    return ElementType(boost::accumulators::mean(acc_));
+    return average(ExactType());
   }
 
   void operator()(const ElementType& el)
   {
     acc_(el);
+    add(el, ExactType());
   }
 
   void output(std::ostream& stream) const
@@ -189,6 +198,35 @@ public:
     stream << boost::format("min: %e\tmax: %e\tavg: %e\n") % min() % max() % average();
   }
 
+private:
+  ElementType sum(std::false_type) const
+  {
+    return boost::accumulators::sum(acc_);
+  }
+
+  ElementType sum(std::true_type) const
+  {
+    return ElementType(exact_sum_.value());
+  }
+
+  ElementType average(std::false_type) const
+  {
+    // for integer ElementType this just truncates from floating-point
+    return ElementType(boost::accumulators::mean(acc_));
+  }
+
+  ElementType average(std::true_type) const
+  {
+    return ElementType(exact_sum_.value() / double(count()));
+  }
+
+  void add(const ElementType& /*el*/, std::false_type) {}
+
+  void add(const ElementType& el, std::true_type)
+  {
+    exact_sum_.add(el);
+  }
+
 protected:
   typedef boost::accumulators::stats<boost::accumulators::tag::max,
                                      boost::accumulators::tag::min,
@@ -197,6 +235,8 @@ protected:
                                      boost::accumulators::tag::sum>
       StatsType;
   boost::accumulators::accumulator_set<ElementType, StatsType> acc_;
+  //! only used for exact summation
+  std::conditional_t<exact, ReproducibleSum, std::tuple<>> exact_sum_;
 };
 
 
@@ -359,8 +399,8 @@ inline bool is_zero(const FieldType& val)
 } // namespace Dune
 
 
-template <class T>
-inline std::ostream& operator<<(std::ostream& s, const Dune::XT::Common::MinMaxAvg<T>& d)
+template <class T, Dune::XT::Common::SummationMode mode>
+inline std::ostream& operator<<(std::ostream& s, const Dune::XT::Common::MinMaxAvg<T, mode>& d)
 {
   d.output(s);
   return s;
@@ -0,0 +1,480 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_PARALLEL_ALGORITHMS_HH
+#define DUNE_XT_COMMON_PARALLEL_ALGORITHMS_HH
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if HAVE_TBB
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
+#  include <tbb/partitioner.h>
+#endif
+
+#include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/parallel/threadmanager.hh>
+#include <dune/xt/common/parallel/threadpool.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+enum class ParallelBackend
+{
+  //! TBB if available, else the ThreadPool if it has workers, else serial
+  automatic,
+  tbb,
+  thread_pool,
+  serial
+};
+
+
+/** \brief controls the execution of parallel_for, parallel_reduce and parallel_scan
+ *
+ *  The range is split into chunks of grain_size consecutive elements, each chunk is processed by a single thread.
+ *  If deterministic is true, the automatic grain size does not depend on the number of threads and partial results of
+ *  the chunks are always combined in the order of the chunks, so that results of parallel_reduce and parallel_scan are
+ *  bitwise reproducible for any number of threads and any backend (given the same grain size).
+ **/
+struct ParallelOptions
+{
+  //! number of chunks a range is split into if grain_size is 0 and deterministic is true
+  static constexpr size_t deterministic_chunks = 256;
+
+  explicit ParallelOptions(const size_t grain_size_in = 0,
+                           const bool deterministic_in = false,
+                           const ParallelBackend backend_in = ParallelBackend::automatic)
+    : grain_size(grain_size_in)
+    , deterministic(deterministic_in)
+    , backend(backend_in)
+  {}
+
+  //! number of elements per chunk, 0 to choose automatically
+  size_t grain_size;
+  bool deterministic;
+  ParallelBackend backend;
+}; // struct ParallelOptions
+
+
+namespace internal {
+
+
+inline ParallelBackend resolve_backend(const ParallelBackend backend)
+{
+  switch (backend) {
+    case ParallelBackend::automatic:
+#if HAVE_TBB
+      return ParallelBackend::tbb;
+#else
+      return (threadPool().num_workers() > 0) ? ParallelBackend::thread_pool : ParallelBackend::serial;
+#endif
+    case ParallelBackend::tbb:
+#if !HAVE_TBB
+      DUNE_THROW(Exceptions::dependency_missing, "the tbb backend requires TBB!");
+#endif
+      return backend;
+    default:
+      return backend;
+  }
+} // ... resolve_backend(...)
+
+inline size_t grain_size(const size_t size, const ParallelOptions& options)
+{
+  if (options.grain_size > 0)
+    return options.grain_size;
+  const size_t chunks = options.deterministic ? ParallelOptions::deterministic_chunks
+                                              : 4 * std::max(threadManager().max_threads(), size_t(1));
+  return std::max((size + chunks - 1) / chunks, size_t(1));
+}
+
+inline size_t num_chunks(const size_t size, const size_t grain)
+{
+  return (size + grain - 1) / grain;
+}
+
+//! state of one loop run by the ThreadPool, shared with all submitted tasks since they may start after the loop is done
+struct ThreadPoolLoopState
+{
+  ThreadPoolLoopState(const size_t num_chunks_in, std::function<void(size_t)> body_in)
+    : num_chunks(num_chunks_in)
+    , body(std::move(body_in))
+    , next(0)
+    , done(0)
+    , failed(false)
+  {}
+
+  //! processes chunks until there are no more, \return false if there was nothing left to do
+  bool run()
+  {
+    bool worked = false;
+    for (size_t chunk = next++; chunk < num_chunks; chunk = next++) {
+      worked = true;
+      if (!failed) {
+        try {
+          body(chunk);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!failed)
+            exception = std::current_exception();
+          failed = true;
+        }
+      }
+      ++done;
+    }
+    return worked;
+  } // ... run(...)
+
+  const size_t num_chunks;
+  const std::function<void(size_t)> body;
+  std::atomic<size_t> next;
+  std::atomic<size_t> done;
+  std::atomic<bool> failed;
+  std::mutex mutex;
+  std::exception_ptr exception;
+}; // struct ThreadPoolLoopState
+
+//! calls body(chunk) for each chunk in [0, num_chunks), in parallel unless backend is serial
+template <class ChunkBody>
+void run_chunks(const size_t num_chunks, ChunkBody&& body, const ParallelBackend backend)
+{
+  if (num_chunks == 0)
+    return;
+  switch (resolve_backend(backend)) {
+    case ParallelBackend::tbb: {
+#if HAVE_TBB
+      threadManager().arena().execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                          [&](const tbb::blocked_range<size_t>& range) {
+                            for (size_t chunk = range.begin(); chunk != range.end(); ++chunk)
+                              body(chunk);
+                          },
+                          tbb::simple_partitioner());
+      });
+#endif
+      return;
+    }
+    case ParallelBackend::thread_pool: {
+      auto& pool = threadPool();
+      const auto state = std::make_shared<ThreadPoolLoopState>(num_chunks, std::ref(body));
+      const auto helpers = std::min(pool.num_workers(), num_chunks - 1);
+      for (size_t ii = 0; ii < helpers; ++ii)
+        pool.submit([state]() { state->run(); });
+      state->run();
+      // helping with other tasks while waiting keeps nested loops from blocking the workers they wait for
+      while (state->done < num_chunks)
+        if (!pool.try_run_one())
+          std::this_thread::yield();
+      if (state->exception)
+        std::rethrow_exception(state->exception);
+      return;
+    }
+    default:
+      for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+        body(chunk);
+  }
+} // ... run_chunks(...)
+
+//! \return the begin of each chunk of grain consecutive elements of [first, last), followed by last
+template <class Iterator>
+std::vector<Iterator> chunk_boundaries(Iterator first, Iterator last, const size_t size, const size_t grain)
+{
+  std::vector<Iterator> boundaries;
+  boundaries.reserve(num_chunks(size, grain) + 1);
+  for (size_t pos = 0; pos < size; pos += grain) {
+    boundaries.push_back(first);
+    std::advance(first, std::min(grain, size - pos));
+  }
+  boundaries.push_back(last);
+  return boundaries;
+}
+
+
+} // namespace internal
+
+
+/** \brief calls body(ii) for each ii in [begin, end), in parallel
+\code
+parallel_for(size_t(0), values.size(), [&](size_t ii) { values[ii] = f(ii); });
+\endcode
+ *  \note exceptions thrown by body are rethrown in the calling thread, some calls of body may be skipped after the
+ *        first exception **/
+template <class IndexType, class Body>
+typename std::enable_if<std::is_integral<IndexType>::value>::type
+parallel_for(const IndexType begin,
+             const IndexType end,
+             Body&& body,
+             const ParallelOptions& options = ParallelOptions())
+{
+  if (end <= begin)
+    return;
+  const auto size = static_cast<size_t>(end - begin);
+  const auto grain = internal::grain_size(size, options);
+  internal::run_chunks(
+      internal::num_chunks(size, grain),
+      [&](const size_t chunk) {
+        const auto chunk_end = static_cast<IndexType>(begin + std::min((chunk + 1) * grain, size));
+        for (auto ii = static_cast<IndexType>(begin + chunk * grain); ii < chunk_end; ++ii)
+          body(ii);
+      },
+      options.backend);
+} // ... parallel_for(...)
+
+//! calls body(*it) for each it in [first, last), in parallel
+template <class Iterator, class Body>
+typename std::enable_if<!std::is_integral<Iterator>::value>::type
+parallel_for(Iterator first, Iterator last, Body&& body, const ParallelOptions& options = ParallelOptions())
+{
+  const auto size = static_cast<size_t>(std::distance(first, last));
+  if (size == 0)
+    return;
+  const auto grain = internal::grain_size(size, options);
+  const auto boundaries = internal::chunk_boundaries(first, last, size, grain);
+  internal::run_chunks(boundaries.size() - 1,
+                       [&](const size_t chunk) {
+                         for (auto it = boundaries[chunk]; it != boundaries[chunk + 1]; ++it)
+                           body(*it);
+                       },
+                       options.backend);
+} // ... parallel_for(...)
+
+/** \brief reduces transform(ii) for all ii in [begin, end) with reduce, in parallel
+\code
+const auto norm2 = parallel_reduce(size_t(0), x.size(), 0., [&](size_t ii) { return x[ii] * x[ii]; }, std::plus<>());
+\endcode
+ *  \param identity neutral element of reduce, each chunk starts with a copy of it
+ *  \param reduce has to be associative, partial results are combined in chunk order unless options.deterministic is
+ *         false and the TBB backend is used **/
+template <class IndexType, class T, class Transform, class Reduce>
+typename std::enable_if<std::is_integral<IndexType>::value, T>::type
+parallel_reduce(const IndexType begin,
+                const IndexType end,
+                const T& identity,
+                Transform&& transform,
+                Reduce&& reduce,
+                const ParallelOptions& options = ParallelOptions())
+{
+  if (end <= begin)
+    return identity;
+  const auto size = static_cast<size_t>(end - begin);
+  const auto grain = internal::grain_size(size, options);
+#if HAVE_TBB
+  if (!options.deterministic && internal::resolve_backend(options.backend) == ParallelBackend::tbb) {
+    T result = identity;
+    threadManager().arena().execute([&]() {
+      result = tbb::parallel_reduce(tbb::blocked_range<IndexType>(begin, end, grain),
+                                    identity,
+                                    [&](const tbb::blocked_range<IndexType>& range, T value) {
+                                      for (auto ii = range.begin(); ii != range.end(); ++ii)
+                                        value = reduce(value, transform(ii));
+                                      return value;
+                                    },
+                                    [&](const T& left, const T& right) { return reduce(left, right); });
+    });
+    return result;
+  }
+#endif // HAVE_TBB
+  const auto chunks = internal::num_chunks(size, grain);
+  std::vector<T> partials(chunks, identity);
+  internal::run_chunks(chunks,
+                       [&](const size_t chunk) {
+                         T value = identity;
+                         const auto chunk_end = static_cast<IndexType>(begin + std::min((chunk + 1) * grain, size));
+                         for (auto ii = static_cast<IndexType>(begin + chunk * grain); ii < chunk_end; ++ii)
+                           value = reduce(value, transform(ii));
+                         partials[chunk] = std::move(value);
+                       },
+                       options.backend);
+  T result = identity;
+  for (auto&& partial : partials)
+    result = reduce(result, partial);
+  return result;
+} // ... parallel_reduce(...)
+
+//! reduces transform(*it) for all it in [first, last) with reduce, in parallel and in chunk order
+template <class Iterator, class T, class Transform, class Reduce>
+typename std::enable_if<!std::is_integral<Iterator>::value, T>::type
+parallel_reduce(Iterator first,
+                Iterator last,
+                const T& identity,
+                Transform&& transform,
+                Reduce&& reduce,
+                const ParallelOptions& options = ParallelOptions())
+{
+  const auto size = static_cast<size_t>(std::distance(first, last));
+  if (size == 0)
+    return identity;
+  const auto boundaries = internal::chunk_boundaries(first, last, size, internal::grain_size(size, options));
+  std::vector<T> partials(boundaries.size() - 1, identity);
+  internal::run_chunks(partials.size(),
+                       [&](const size_t chunk) {
+                         T value = identity;
+                         for (auto it = boundaries[chunk]; it != boundaries[chunk + 1]; ++it)
+                           value = reduce(value, transform(*it));
+                         partials[chunk] = std::move(value);
+                       },
+                       options.backend);
+  T result = identity;
+  for (auto&& partial : partials)
+    result = reduce(result, partial);
+  return result;
+} // ... parallel_reduce(...)
+
+/** \brief reduces all values with reduce, combining pairs of values concurrently
+\code
+std::vector<std::vector<double>> vectors = ...;
+const auto concatenated = parallel_tree_reduce(std::move(vectors), [](auto&& left, auto&& right) {
+  left.insert(left.end(), right.begin(), right.end());
+  return std::move(left);
+}, ParallelOptions(0, true));
+\endcode
+ *  The values are reduced in place, reduce is called as reduce(std::move(left), std::move(right)) and may thus steal
+ *  from its arguments, e.g. to merge right into left and return left.
+ *
+ *  If options.deterministic is true, the values are combined in a balanced binary tree, level by level: values[ii] and
+ *  values[ii + 2^l] for all ii divisible by 2^(l + 1) on level l. This only requires reduce to be associative, and the
+ *  result is bitwise reproducible for the same values (in the same order). Otherwise any two values which are ready
+ *  (not being combined) are combined right away, so no thread waits for a level to complete. This requires reduce to
+ *  be commutative as well.
+ *  \return identity if values is empty **/
+template <class T, class Reduce>
+T parallel_tree_reduce(std::vector<T> values,
+                       const T& identity,
+                       Reduce&& reduce,
+                       const ParallelOptions& options = ParallelOptions())
+{
+  const size_t size = values.size();
+  if (size == 0)
+    return identity;
+  if (options.deterministic) {
+    for (size_t stride = 1; stride < size; stride *= 2) {
+      internal::run_chunks((size + stride - 1) / (2 * stride),
+                           [&](const size_t pair) {
+                             auto& left = values[2 * stride * pair];
+                             left = reduce(std::move(left), std::move(values[2 * stride * pair + stride]));
+                           },
+                           options.backend);
+    }
+    return std::move(values[0]);
+  }
+  // indices of the values waiting for a partner, the last one left holds the result
+  std::vector<size_t> ready;
+  ready.reserve(size);
+  std::mutex ready_mutex;
+  internal::run_chunks(size,
+                       [&](const size_t leaf) {
+                         size_t index = leaf;
+                         while (true) {
+                           size_t partner;
+                           {
+                             std::lock_guard<std::mutex> lock(ready_mutex);
+                             if (ready.empty()) {
+                               ready.push_back(index);
+                               return;
+                             }
+                             partner = ready.back();
+                             ready.pop_back();
+                           }
+                           values[index] = reduce(std::move(values[index]), std::move(values[partner]));
+                         }
+                       },
+                       options.backend);
+  return std::move(values[ready.front()]);
+} // ... parallel_tree_reduce(...)
+
+/** \brief inclusive scan: calls store(ii, init op transform(begin) op ... op transform(ii)) for each ii in [begin, end)
+ *
+ *  Runs in two parallel passes, the first computes the reduction of each chunk, the second the prefixes within each
+ *  chunk, starting from the (serially computed) prefix of the preceding chunks. So transform is called twice per index.
+ *  \param op has to be associative
+ **/
+template <class IndexType, class T, class Transform, class Op, class Store>
+typename std::enable_if<std::is_integral<IndexType>::value>::type parallel_scan(const IndexType begin,
+                                                                              const IndexType end,
+                                                                              const T& init,
+                                                                              Transform&& transform,
+                                                                              Op&& op,
+                                                                              Store&& store,
+                                                                              const ParallelOptions& options
+                                                                              = ParallelOptions())
+{
+  if (end <= begin)
+    return;
+  const auto size = static_cast<size_t>(end - begin);
+  const auto grain = internal::grain_size(size, options);
+  const auto chunks = internal::num_chunks(size, grain);
+  const auto chunk_begin = [&](const size_t chunk) { return static_cast<IndexType>(begin + chunk * grain); };
+  const auto chunk_end = [&](const size_t chunk) {
+    return static_cast<IndexType>(begin + std::min((chunk + 1) * grain, size));
+  };
+  // the reduction of each but the last chunk
+  std::vector<T> offsets(chunks, init);
+  internal::run_chunks(chunks - 1,
+                       [&](const size_t chunk) {
+                         auto ii = chunk_begin(chunk);
+                         T value = transform(ii);
+                         for (++ii; ii < chunk_end(chunk); ++ii)
+                           value = op(value, transform(ii));
+                         offsets[chunk + 1] = std::move(value);
+                       },
+                       options.backend);
+  for (size_t chunk = 1; chunk < chunks; ++chunk)
+    offsets[chunk] = op(offsets[chunk - 1], offsets[chunk]);
+  internal::run_chunks(chunks,
+                       [&](const size_t chunk) {
+                         T value = offsets[chunk];
+                         for (auto ii = chunk_begin(chunk); ii < chunk_end(chunk); ++ii) {
+                           value = op(value, transform(ii));
+                           store(ii, value);
+                         }
+                       },
+                       options.backend);
+} // ... parallel_scan(...)
+
+/** \brief inclusive scan of [first, last) into [d_first, ...), starting from init, see std::inclusive_scan
+ *  \note both iterators have to be random access iterators
+ *  \return the end of the output range **/
+template <class InputIterator, class OutputIterator, class T, class Op>
+typename std::enable_if<!std::is_integral<InputIterator>::value, OutputIterator>::type
+parallel_scan(InputIterator first,
+              InputIterator last,
+              OutputIterator d_first,
+              const T& init,
+              Op&& op,
+              const ParallelOptions& options = ParallelOptions())
+{
+  static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                typename std::iterator_traits<InputIterator>::iterator_category>::value,
+                "parallel_scan requires random access iterators!");
+  const auto size = std::distance(first, last);
+  parallel_scan(decltype(size)(0),
+                size,
+                init,
+                [&](const decltype(size) ii) -> decltype(auto) { return first[ii]; },
+                op,
+                [&](const decltype(size) ii, const T& value) { d_first[ii] = value; },
+                options);
+  return d_first + size;
+} // ... parallel_scan(...)
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_PARALLEL_ALGORITHMS_HH
@@ -0,0 +1,150 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_PARALLEL_CHASE_LEV_DEQUE_HH
+#define DUNE_XT_COMMON_PARALLEL_CHASE_LEV_DEQUE_HH
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+/** \brief lock-free work-stealing deque of pointers after Chase and Lev
+ *
+ *  The owning thread pushes and takes at the bottom (last in, first out), any other thread may steal from the top
+ *  (first in, first out). Follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013).
+ *  The buffer grows as needed, replaced buffers are kept until destruction since thieves may still read from them.
+ *  \note push and take must only be called by the owning thread
+ **/
+template <class T>
+class ChaseLevDeque : public boost::noncopyable
+{
+  class Buffer
+  {
+  public:
+    explicit Buffer(const std::int64_t capacity)
+      : capacity_(capacity)
+      , mask_(capacity - 1)
+      , values_(new std::atomic<T*>[capacity])
+    {}
+
+    std::int64_t capacity() const
+    {
+      return capacity_;
+    }
+
+    T* get(const std::int64_t ii) const
+    {
+      return values_[ii & mask_].load(std::memory_order_relaxed);
+    }
+
+    void put(const std::int64_t ii, T* value)
+    {
+      values_[ii & mask_].store(value, std::memory_order_relaxed);
+    }
+
+  private:
+    const std::int64_t capacity_;
+    const std::int64_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> values_;
+  }; // class Buffer
+
+public:
+  //! \param capacity initial capacity, has to be a power of two
+  explicit ChaseLevDeque(const std::int64_t capacity = 256)
+    : top_(0)
+    , bottom_(0)
+  {
+    buffers_.emplace_back(new Buffer(capacity));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+
+  void push(T* value)
+  {
+    const auto bottom = bottom_.load(std::memory_order_relaxed);
+    const auto top = top_.load(std::memory_order_acquire);
+    auto* buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top > buffer->capacity() - 1)
+      buffer = grow(buffer, top, bottom);
+    buffer->put(bottom, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  //! \return the most recently pushed value or nullptr if empty
+  T* take()
+  {
+    const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    auto* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* value = buffer->get(bottom);
+    if (top == bottom) {
+      // last element, race against thieves
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        value = nullptr;
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return value;
+  } // ... take(...)
+
+  //! \return the least recently pushed value or nullptr if empty or another thread was faster
+  T* steal()
+  {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom)
+      return nullptr;
+    T* value = buffer_.load(std::memory_order_acquire)->get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return nullptr;
+    return value;
+  }
+
+  //! \note only a snapshot if other threads are working on the deque
+  bool empty() const
+  {
+    return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+  }
+
+private:
+  Buffer* grow(Buffer* old, const std::int64_t top, const std::int64_t bottom)
+  {
+    buffers_.emplace_back(new Buffer(2 * old->capacity()));
+    auto* buffer = buffers_.back().get();
+    for (auto ii = top; ii < bottom; ++ii)
+      buffer->put(ii, old->get(ii));
+    buffer_.store(buffer, std::memory_order_release);
+    return buffer;
+  }
+
+  std::atomic<std::int64_t> top_;
+  std::atomic<std::int64_t> bottom_;
+  std::atomic<Buffer*> buffer_;
+  //! owned by the owning thread, all buffers ever used
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+}; // class ChaseLevDeque
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_PARALLEL_CHASE_LEV_DEQUE_HH
@@ -11,7 +11,22 @@
 #ifndef DUNE_XT_COMMON_PARALLEL_PARTITIONER_HH
 #define DUNE_XT_COMMON_PARALLEL_PARTITIONER_HH
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/filesystem.hh>
+#include <dune/xt/common/timings.hh>
 
 namespace Dune {
 namespace XT {
@@ -45,6 +60,464 @@ private:
   const IndexSetType& index_set_;
 };
 
+
+/** \brief Partition into blocks of consecutive indices (w.r.t. the \ref IndexSet)
+ *
+ *  Entities with consecutive indices usually share most of their data (e.g. vertices, degrees of freedom), so a
+ *  block whose data fits into a cache budget can be processed without evictions, see entities_per_block.
+ **/
+template <class GridViewType>
+class BlockPartitioner
+{
+public:
+  typedef typename GridViewType::IndexSet IndexSetType;
+  typedef typename GridViewType::template Codim<0>::Entity EntityType;
+
+  //! default budget per block: a typical share of the L2 cache per core
+  static constexpr std::size_t default_byte_budget = 256 * 1024;
+
+  //! \return the number of entities per block such that the data of a block fits into byte_budget (at least 1)
+  static std::size_t entities_per_block(const std::size_t bytes_per_entity,
+                                        const std::size_t byte_budget = default_byte_budget)
+  {
+    return std::max(byte_budget / std::max(bytes_per_entity, std::size_t(1)), std::size_t(1));
+  }
+
+  BlockPartitioner(const IndexSetType& index_set, const std::size_t entities_per_block_in)
+    : index_set_(index_set)
+    , entities_per_block_(entities_per_block_in)
+  {
+    if (entities_per_block_ == 0)
+      DUNE_THROW(Exceptions::wrong_input_given, "entities_per_block has to be positive!");
+  }
+
+  std::size_t partition(const EntityType& e) const
+  {
+    return index_set_.index(e) / entities_per_block_;
+  }
+
+  std::size_t partitions() const
+  {
+    return (index_set_.size(0) + entities_per_block_ - 1) / entities_per_block_;
+  }
+
+private:
+  const IndexSetType& index_set_;
+  const std::size_t entities_per_block_;
+}; // class BlockPartitioner
+
+
+namespace internal {
+
+
+/** \return the partition of each entity (by index), such that each partition consists of consecutive entities of order
+ *          and all partitions have about the same total weight, see WeightedPartitioner **/
+inline std::vector<std::size_t> partition_by_weight(const std::vector<double>& weights,
+                                                    const std::size_t num_partitions,
+                                                    std::vector<std::size_t> order)
+{
+  const auto size = weights.size();
+  if (num_partitions == 0)
+    DUNE_THROW(Exceptions::wrong_input_given, "num_partitions has to be positive!");
+  if (order.empty()) {
+    order.resize(size);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+  }
+  if (order.size() != size)
+    DUNE_THROW(Exceptions::shapes_do_not_match, "order.size() = " << order.size() << ", weights.size() = " << size);
+  double total = 0;
+  for (const auto& weight : weights) {
+    if (!(weight >= 0))
+      DUNE_THROW(Exceptions::wrong_input_given, "weights have to be non-negative, got " << weight << "!");
+    total += weight;
+  }
+  // each entity goes to the partition its center of weight falls into, all entities count the same if all weights
+  // are zero
+  const bool uniform = !(total > 0);
+  const double target = (uniform ? double(size) : total) / num_partitions;
+  std::vector<std::size_t> partition_of(size, 0);
+  double prefix = 0;
+  for (std::size_t ii = 0; ii < size; ++ii) {
+    const auto index = order[ii];
+    const auto weight = uniform ? 1. : weights[index];
+    const auto partition = static_cast<std::size_t>((prefix + weight / 2) / target);
+    partition_of[index] = std::min(partition, num_partitions - 1);
+    prefix += weight;
+  }
+  return partition_of;
+} // ... partition_by_weight(...)
+
+
+} // namespace internal
+
+
+/** \brief Partition into contiguous pieces of a given ordering of the entities with (about) equal total weight
+ *
+ *  The weights are the (e.g. measured) costs of the entities, so that all partitions take about the same time.
+ *  Each partition consists of consecutive entities of order, the default order being the \ref IndexSet.
+ **/
+template <class GridViewType>
+class WeightedPartitioner
+{
+public:
+  typedef typename GridViewType::IndexSet IndexSetType;
+  typedef typename GridViewType::template Codim<0>::Entity EntityType;
+
+  /** \param weights       non-negative weight of each entity, by index
+   *  \param num_partitions number of partitions (some may be empty if a few entities carry most of the weight)
+   *  \param order         indices of all entities in the order in which they are to be partitioned, empty for the
+   *                       order of the indices **/
+  WeightedPartitioner(const IndexSetType& index_set,
+                      const std::vector<double>& weights,
+                      const std::size_t num_partitions,
+                      std::vector<std::size_t> order = std::vector<std::size_t>())
+    : index_set_(index_set)
+    , num_partitions_(num_partitions)
+    , partition_of_(internal::partition_by_weight(weights, num_partitions, std::move(order)))
+  {
+    if (partition_of_.size() != index_set_.size(0))
+      DUNE_THROW(Exceptions::shapes_do_not_match,
+                 "weights.size() = " << weights.size() << ", index_set.size(0) = " << index_set_.size(0));
+  }
+
+  std::size_t partition(const EntityType& e) const
+  {
+    return partition_of_[index_set_.index(e)];
+  }
+
+  std::size_t partitions() const
+  {
+    return num_partitions_;
+  }
+
+private:
+  const IndexSetType& index_set_;
+  const std::size_t num_partitions_;
+  std::vector<std::size_t> partition_of_;
+}; // class WeightedPartitioner
+
+
+enum class SpaceFillingCurve
+{
+  morton,
+  hilbert
+};
+
+
+/** \return the position of the point with the given integer coordinates (of bits bits each) along the Morton
+ *          (Z-order) curve, dimension times bits must not exceed 64 **/
+template <std::size_t dimension>
+std::uint64_t morton_key(const std::array<std::uint32_t, dimension>& coordinates, const unsigned int bits)
+{
+  std::uint64_t key = 0;
+  for (unsigned int bit = bits; bit-- > 0;)
+    for (std::size_t dd = 0; dd < dimension; ++dd)
+      key = (key << 1) | ((coordinates[dd] >> bit) & 1);
+  return key;
+}
+
+/** \return the position of the point with the given integer coordinates (of bits bits each) along the Hilbert curve,
+ *          dimension times bits must not exceed 64
+ *  \sa J. Skilling, "Programming the Hilbert curve", AIP Conference Proceedings 707 (2004) **/
+template <std::size_t dimension>
+std::uint64_t hilbert_key(std::array<std::uint32_t, dimension> coordinates, const unsigned int bits)
+{
+  auto& x = coordinates;
+  if (bits == 0)
+    return 0;
+  const std::uint32_t highest = std::uint32_t(1) << (bits - 1);
+  // inverse undo excess work
+  for (std::uint32_t q = highest; q > 1; q >>= 1) {
+    const std::uint32_t p = q - 1;
+    for (std::size_t dd = 0; dd < dimension; ++dd) {
+      if (x[dd] & q) {
+        x[0] ^= p;
+      } else {
+        const std::uint32_t t = (x[0] ^ x[dd]) & p;
+        x[0] ^= t;
+        x[dd] ^= t;
+      }
+    }
+  }
+  // Gray encode
+  for (std::size_t dd = 1; dd < dimension; ++dd)
+    x[dd] ^= x[dd - 1];
+  std::uint32_t t = 0;
+  for (std::uint32_t q = highest; q > 1; q >>= 1)
+    if (x[dimension - 1] & q)
+      t ^= q - 1;
+  for (std::size_t dd = 0; dd < dimension; ++dd)
+    x[dd] ^= t;
+  // the transposed key is interleaved like a Morton key
+  return morton_key(x, bits);
+} // ... hilbert_key(...)
+
+
+/** \brief Partition along a space-filling curve through the centers of the entities
+ *
+ *  The entities are ordered along a Morton or Hilbert curve through their centers, and this order is cut into
+ *  num_partitions contiguous pieces of about equal (total) weight, see WeightedPartitioner. So each partition is a
+ *  compact region of the domain, which is good for locality, also across partitions processed one after another
+ *  (especially with the Hilbert curve).
+ **/
+template <class GridViewType>
+class SpaceFillingCurvePartitioner : public WeightedPartitioner<GridViewType>
+{
+  typedef WeightedPartitioner<GridViewType> BaseType;
+  static constexpr std::size_t dimension = GridViewType::dimensionworld;
+  //! bits per coordinate, such that a key fits into 64 bits
+  static constexpr unsigned int bits = std::min(32u, static_cast<unsigned int>(64 / dimension));
+
+public:
+  /** \param weights cost of each entity, by index, empty for equal costs
+   *  \note the index set of grid_view has to be kept alive (as with grid_view.indexSet()) **/
+  SpaceFillingCurvePartitioner(const GridViewType& grid_view,
+                               const std::size_t num_partitions,
+                               const SpaceFillingCurve curve = SpaceFillingCurve::hilbert,
+                               const std::vector<double>& weights = std::vector<double>())
+    : BaseType(grid_view.indexSet(),
+               weights.empty() ? std::vector<double>(grid_view.indexSet().size(0), 1.) : weights,
+               num_partitions,
+               curve_order(grid_view, curve))
+  {}
+
+  /** \return the indices of all entities of grid_view, ordered along the given curve through their centers (ties,
+   *          i.e. centers closer than the resolution of the curve, are ordered by index) **/
+  static std::vector<std::size_t> curve_order(const GridViewType& grid_view, const SpaceFillingCurve curve)
+  {
+    const auto& index_set = grid_view.indexSet();
+    const auto size = index_set.size(0);
+    std::vector<std::array<double, dimension>> centers(size);
+    std::array<double, dimension> lower, upper;
+    lower.fill(std::numeric_limits<double>::max());
+    upper.fill(std::numeric_limits<double>::lowest());
+    const auto end = grid_view.template end<0>();
+    for (auto it = grid_view.template begin<0>(); it != end; ++it) {
+      const auto center = it->geometry().center();
+      auto& stored_center = centers[index_set.index(*it)];
+      for (std::size_t dd = 0; dd < dimension; ++dd) {
+        stored_center[dd] = center[dd];
+        lower[dd] = std::min(lower[dd], stored_center[dd]);
+        upper[dd] = std::max(upper[dd], stored_center[dd]);
+      }
+    }
+    const double max_coordinate = static_cast<double>((std::uint64_t(1) << bits) - 1);
+    std::vector<std::uint64_t> keys(size);
+    for (std::size_t ii = 0; ii < size; ++ii) {
+      std::array<std::uint32_t, dimension> coordinates;
+      for (std::size_t dd = 0; dd < dimension; ++dd) {
+        const auto extent = upper[dd] - lower[dd];
+        coordinates[dd] =
+            (extent > 0) ? static_cast<std::uint32_t>((centers[ii][dd] - lower[dd]) / extent * max_coordinate) : 0;
+      }
+      keys[ii] = (curve == SpaceFillingCurve::morton) ? morton_key(coordinates, bits) : hilbert_key(coordinates, bits);
+    }
+    std::vector<std::size_t> order(size);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](const std::size_t left, const std::size_t right) {
+      return keys[left] < keys[right];
+    });
+    return order;
+  } // ... curve_order(...)
+}; // class SpaceFillingCurvePartitioner
+
+
+/** \brief Partition which adapts to the measured runtime of its partitions
+ *
+ *  Like WeightedPartitioner, but the weights are learned: during a sweep over all partitions the wall time spent in
+ *  each partition is recorded (e.g. by a ScopedTiming per processed partition), and rebalance() turns these times into
+ *  new weights of the entities and moves the boundaries of the partitions accordingly for the next sweep.
+\code
+AdaptivePartitioner<GridViewType> partitioner(grid_view.indexSet(), 4 * threadManager().max_threads());
+partitioner.load_weights("weights.txt"); // optional, from a previous run
+for (auto&& step : steps) {
+  Dune::SeedListPartitioning<GridType, 0> partitioning(grid_view, partitioner);
+  // in each thread, for each partition ii:
+  {
+    AdaptivePartitioner<GridViewType>::ScopedTiming timing(partitioner, ii);
+    // ... process all entities of partition ii
+  }
+  partitioner.rebalance();
+}
+partitioner.save_weights("weights.txt");
+\endcode
+ *  Since nothing is known about the cost of individual entities within a partition, the measured time of a partition
+ *  is distributed to its entities proportionally to their previous weights. Partitions with uneven cost are thus split
+ *  more finely over the course of a few sweeps.
+ *  \note a partitioning built from this partitioner (e.g. a SeedListPartitioning) has to be rebuilt after rebalance()
+ **/
+template <class GridViewType>
+class AdaptivePartitioner
+{
+public:
+  typedef typename GridViewType::IndexSet IndexSetType;
+  typedef typename GridViewType::template Codim<0>::Entity EntityType;
+
+  //! adds the wall time of its lifetime to the given partition
+  class ScopedTiming
+  {
+  public:
+    ScopedTiming(AdaptivePartitioner& partitioner, const std::size_t partition)
+      : partitioner_(partitioner)
+      , partition_(partition)
+      , start_(TimingData::now(false)[0])
+    {}
+
+    ScopedTiming(const ScopedTiming&) = delete;
+    ScopedTiming& operator=(const ScopedTiming&) = delete;
+
+    ~ScopedTiming()
+    {
+      partitioner_.add_time(partition_, static_cast<std::uint64_t>(TimingData::now(false)[0] - start_));
+    }
+
+  private:
+    AdaptivePartitioner& partitioner_;
+    const std::size_t partition_;
+    const TimingData::TimeType start_;
+  }; // class ScopedTiming
+
+  /** \param order   indices of all entities in the order in which they are to be partitioned, empty for the order of
+   *                 the indices, see e.g. SpaceFillingCurvePartitioner::curve_order
+   *  \param weights initial weights of the entities, by index, empty for equal weights **/
+  AdaptivePartitioner(const IndexSetType& index_set,
+                      const std::size_t num_partitions,
+                      std::vector<std::size_t> order = std::vector<std::size_t>(),
+                      std::vector<double> weights = std::vector<double>())
+    : index_set_(index_set)
+    , num_partitions_(num_partitions)
+    , order_(std::move(order))
+    , weights_(std::move(weights))
+    , times_(new std::atomic<std::uint64_t>[num_partitions])
+    , sweeps_(0)
+  {
+    if (weights_.empty())
+      weights_.resize(index_set_.size(0), 1.);
+    if (weights_.size() != index_set_.size(0))
+      DUNE_THROW(Exceptions::shapes_do_not_match,
+                 "weights.size() = " << weights_.size() << ", index_set.size(0) = " << index_set_.size(0));
+    reset_times();
+    partition_of_ = internal::partition_by_weight(weights_, num_partitions_, order_);
+  }
+
+  std::size_t partition(const EntityType& e) const
+  {
+    return partition_of_[index_set_.index(e)];
+  }
+
+  std::size_t partitions() const
+  {
+    return num_partitions_;
+  }
+
+  //! \note thread safe
+  void add_time(const std::size_t partition, const std::uint64_t nanoseconds)
+  {
+    if (partition >= num_partitions_)
+      DUNE_THROW(Exceptions::index_out_of_range, "partition = " << partition << ", partitions() = " << num_partitions_);
+    times_[partition].fetch_add(nanoseconds, std::memory_order_relaxed);
+  }
+
+  //! \return the time recorded for the given partition since the last rebalance(), in nanoseconds
+  std::uint64_t time(const std::size_t partition) const
+  {
+    return times_[partition].load(std::memory_order_relaxed);
+  }
+
+  /** \brief learns new weights from the times recorded since the last call and moves the partition boundaries
+   *  \param damping in [0, 1), the part of the previous weights kept (after scaling them to the recorded times),
+   *                 larger values avoid oscillations if the times fluctuate
+   *  \note does nothing (but resetting the times) if no time was recorded **/
+  void rebalance(const double damping = 0.)
+  {
+    if (!(damping >= 0 && damping < 1))
+      DUNE_THROW(Exceptions::wrong_input_given, "damping has to be in [0, 1), is " << damping << "!");
+    std::vector<double> partition_weights(num_partitions_, 0.);
+    std::vector<std::size_t> partition_sizes(num_partitions_, 0);
+    for (std::size_t ii = 0; ii < weights_.size(); ++ii) {
+      partition_weights[partition_of_[ii]] += weights_[ii];
+      ++partition_sizes[partition_of_[ii]];
+    }
+    double total_time = 0;
+    for (std::size_t pp = 0; pp < num_partitions_; ++pp)
+      total_time += static_cast<double>(time(pp));
+    const double total_weight = std::accumulate(partition_weights.begin(), partition_weights.end(), 0.);
+    if (total_time > 0) {
+      // previous weights in units of time
+      const double scale = (total_weight > 0) ? total_time / total_weight : 0.;
+      for (std::size_t ii = 0; ii < weights_.size(); ++ii) {
+        const auto partition = partition_of_[ii];
+        const double partition_time = static_cast<double>(time(partition));
+        double estimate = weights_[ii] * scale;
+        if (partition_time > 0)
+          estimate = (partition_weights[partition] > 0)
+                         ? partition_time * weights_[ii] / partition_weights[partition]
+                         : partition_time / static_cast<double>(partition_sizes[partition]);
+        weights_[ii] = damping * weights_[ii] * scale + (1 - damping) * estimate;
+      }
+      partition_of_ = internal::partition_by_weight(weights_, num_partitions_, order_);
+      ++sweeps_;
+    }
+    reset_times();
+  } // ... rebalance(...)
+
+  //! \return the learned weight of each entity (by index), in nanoseconds after the first rebalance()
+  const std::vector<double>& weights() const
+  {
+    return weights_;
+  }
+
+  //! \return the number of calls of rebalance() which changed the weights
+  std::size_t sweeps() const
+  {
+    return sweeps_;
+  }
+
+  //! writes the weights, one per line
+  void save_weights(const std::string& filename) const
+  {
+    auto out = make_ofstream(filename);
+    out->precision(std::numeric_limits<double>::max_digits10);
+    for (const auto& weight : weights_)
+      *out << weight << "\n";
+  }
+
+  /** reads weights written by save_weights and moves the partition boundaries accordingly
+   *  \return false (and keeps the weights) if filename does not exist, e.g. on the first run **/
+  bool load_weights(const std::string& filename)
+  {
+    if (!boost::filesystem::exists(filename))
+      return false;
+    auto in = make_ifstream(filename);
+    std::vector<double> weights;
+    double weight;
+    while (*in >> weight)
+      weights.push_back(weight);
+    if (weights.size() != weights_.size())
+      DUNE_THROW(Exceptions::shapes_do_not_match,
+                 "'" << filename << "' contains " << weights.size() << " weights, index_set.size(0) = "
+                     << weights_.size());
+    partition_of_ = internal::partition_by_weight(weights, num_partitions_, order_);
+    weights_ = std::move(weights);
+    return true;
+  } // ... load_weights(...)
+
+private:
+  void reset_times()
+  {
+    for (std::size_t pp = 0; pp < num_partitions_; ++pp)
+      times_[pp].store(0, std::memory_order_relaxed);
+  }
+
+  const IndexSetType& index_set_;
+  const std::size_t num_partitions_;
+  const std::vector<std::size_t> order_;
+  std::vector<double> weights_;
+  std::vector<std::size_t> partition_of_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> times_;
+  std::size_t sweeps_;
+}; // class AdaptivePartitioner
+
 } // namespace Common
 } // namespace XT
 } // namespace Dune
@@ -11,11 +11,15 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <thread>
+#include <vector>
 
 #if HAVE_TBB
-#  include <tbb/concurrent_unordered_map.h>
 #  include <tbb/task_scheduler_init.h>
 #endif
 
@@ -30,36 +34,84 @@
 
 #include <dune/common/exceptions.hh>
 
-#include <dune/xt/common/configuration.hh>
+#include <dune/xt/common/concurrent_configuration.hh>
 
 #include "threadmanager.hh"
+#include "threadpool.hh"
 
 
-#if HAVE_TBB
+namespace {
+
 
-struct ThreadIdHashCompare
+/** hands out thread numbers, always the smallest one not in use
+ *  \note Numbers are returned when the thread holding it exits, so that threads replacing exited ones (as TBB may do)
+ *        reuse their numbers. So the numbers stay below the number of threads alive at the same time.
+ **/
+class ThreadIndexRegistry
 {
-  size_t hash(std::thread::id id) const
+public:
+  ThreadIndexRegistry()
+    : next_(0)
+  {}
+
+  size_t acquire()
   {
-    static std::hash<std::thread::id> hasher;
-    return hasher(id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty())
+      return next_++;
+    const auto index = free_.top();
+    free_.pop();
+    return index;
   }
 
-  size_t operator()(std::thread::id id) const
+  void release(const size_t index)
   {
-    return hash(id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push(index);
   }
 
-  bool equal(std::thread::id a, std::thread::id b) const
+private:
+  std::mutex mutex_;
+  size_t next_;
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> free_;
+};
+
+ThreadIndexRegistry& thread_index_registry()
+{
+  static ThreadIndexRegistry registry;
+  return registry;
+}
+
+constexpr size_t no_thread_index = size_t(-1);
+
+// trivially destructible, so accessing it involves no initialization guard
+thread_local size_t cached_thread_index = no_thread_index;
+
+//! returns the calling thread's number to the registry on thread exit
+struct ThreadIndexReleaser
+{
+  ~ThreadIndexReleaser()
   {
-    return a == b;
+    thread_index_registry().release(cached_thread_index);
+    cached_thread_index = no_thread_index;
   }
 };
 
+size_t acquire_thread_index()
+{
+  static thread_local ThreadIndexReleaser releaser;
+  (void)releaser;
+  cached_thread_index = thread_index_registry().acquire();
+  return cached_thread_index;
+}
+
+
+} // namespace
+
+
 size_t Dune::XT::Common::ThreadManager::max_threads()
 {
-  const auto threads = DXTC_CONFIG_GET("threading.max_count", 1);
-  return threads;
+  return max_threads_.load(std::memory_order_relaxed);
 }
 
 size_t Dune::XT::Common::ThreadManager::current_threads()
@@ -68,27 +120,40 @@ size_t Dune::XT::Common::ThreadManager::current_threads()
   return threads;
 }
 
-template <typename Key, typename T, typename MapType>
-std::pair<typename MapType::iterator, bool> tbb_map_emplace(MapType& map_in, Key key, T value)
+size_t Dune::XT::Common::ThreadManager::thread()
 {
-#  if defined(BOOST_CLANG) && BOOST_CLANG
-  return map_in.insert(typename MapType::value_type(key, value));
-#  else
-  return map_in.emplace(key, value);
-#  endif
+  if (cached_thread_index != no_thread_index)
+    return cached_thread_index;
+  return acquire_thread_index();
 }
 
-size_t Dune::XT::Common::ThreadManager::thread()
+Dune::XT::Common::ThreadPool& Dune::XT::Common::ThreadManager::pool()
+{
+  auto* existing = pool_ptr_.load(std::memory_order_acquire);
+  if (existing)
+    return *existing;
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  if (!pool_) {
+    pool_ = std::make_unique<ThreadPool>(std::max(max_threads(), size_t(1)) - 1);
+    pool_ptr_.store(pool_.get(), std::memory_order_release);
+  }
+  return *pool_;
+}
+
+void Dune::XT::Common::ThreadManager::reset_pool(const size_t count)
 {
-  const std::thread::id tbb_id = std::this_thread::get_id();
-  static tbb::concurrent_unordered_map<std::thread::id, size_t, ThreadIdHashCompare> thread_ids;
-  static std::atomic<size_t> map_size(0);
-  const auto it = thread_ids.find(tbb_id);
-  if (it == thread_ids.end())
-    return tbb_map_emplace(thread_ids, tbb_id, map_size++).first->second;
-  return it->second;
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  if (pool_ && pool_->num_workers() + 1 == std::max(count, size_t(1)))
+    return;
+  pool_ptr_.store(nullptr, std::memory_order_release);
+  pool_.reset();
 }
 
+Dune::XT::Common::ThreadManager::~ThreadManager() = default;
+
+
+#if HAVE_TBB
+
 //! both std::hw_concur and intel's default_thread_count fail for mic
 size_t Dune::XT::Common::ThreadManager::default_max_threads()
 {
@@ -101,15 +166,25 @@ size_t Dune::XT::Common::ThreadManager::default_max_threads()
 
 void Dune::XT::Common::ThreadManager::set_max_threads(const size_t count)
 {
-  DXTC_CONFIG.set("threading.max_count", count, true);
+  // Config() must not be modified while other threads may read it, so only the concurrent copy is updated
+  DXTC_CONCURRENT_CONFIG.set("threading.max_count", count, true);
   max_threads_ = count;
+  arena_ = std::make_unique<tbb::task_arena>(boost::numeric_cast<int>(count));
+  reset_pool(count);
 #  if HAVE_EIGEN
   Eigen::setNbThreads(boost::numeric_cast<int>(count));
 #  endif
 }
 
+tbb::task_arena& Dune::XT::Common::ThreadManager::arena()
+{
+  return *arena_;
+}
+
 Dune::XT::Common::ThreadManager::ThreadManager()
-  : max_threads_(default_max_threads())
+  : max_threads_(DXTC_CONFIG_GET("threading.max_count", 1))
+  , arena_(std::make_unique<tbb::task_arena>(boost::numeric_cast<int>(max_threads_.load())))
+  , pool_ptr_(nullptr)
 {
 #  if HAVE_EIGEN
   // must be called before tbb threads are created via tbb::task_scheduler_init object ctor
@@ -120,34 +195,23 @@ Dune::XT::Common::ThreadManager::ThreadManager()
 
 #else // if HAVE_TBB
 
-size_t Dune::XT::Common::ThreadManager::max_threads()
-{
-  return max_threads_;
-}
-
-size_t Dune::XT::Common::ThreadManager::current_threads()
-{
-  return 1;
-}
-
-size_t Dune::XT::Common::ThreadManager::thread()
+size_t Dune::XT::Common::ThreadManager::default_max_threads()
 {
-  return 0;
+  return std::max(std::thread::hardware_concurrency(), 1u);
 }
 
+//! without TBB, parallel work is done by the workers of threadPool()
 void Dune::XT::Common::ThreadManager::set_max_threads(const size_t count)
 {
-  if (count > 1)
-    DUNE_THROW(InvalidStateException, "Trying to use more than one thread w/o TBB");
-}
-
-size_t Dune::XT::Common::ThreadManager::default_max_threads()
-{
-  return 1;
+  // Config() must not be modified while other threads may read it, so only the concurrent copy is updated
+  DXTC_CONCURRENT_CONFIG.set("threading.max_count", count, true);
+  max_threads_ = count;
+  reset_pool(count);
 }
 
 Dune::XT::Common::ThreadManager::ThreadManager()
-  : max_threads_(1)
+  : max_threads_(DXTC_CONFIG_GET("threading.max_count", 1))
+  , pool_ptr_(nullptr)
 {}
 
 #endif // HAVE_TBB
@@ -11,43 +11,78 @@
 #ifndef DUNE_XT_COMMON_THREADMANAGER_HH
 #define DUNE_XT_COMMON_THREADMANAGER_HH
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <thread>
 
+#if HAVE_TBB
+#  include <tbb/task_arena.h>
+#endif
+
 namespace Dune {
 namespace XT {
 namespace Common {
 
+class ThreadPool;
 struct ThreadManager;
 //! global singleton ThreadManager
 ThreadManager& threadManager();
 
 /** abstractions of threading functionality
- *  currently controls tbb, falls back to single-thread dummy imp
+ *  currently controls tbb, falls back to the work-stealing ThreadPool if tbb is not available
  **/
 struct ThreadManager
 {
   static size_t default_max_threads();
 
-  //! return maximal number of threads possbile in the current run
+  /** return maximal number of threads possbile in the current run
+   *  \note the value is initialized from threading.max_count (default 1) of Config() on construction and afterwards
+   *        only changed by set_max_threads, which writes it to ConcurrentConfig() (but not to Config(), which must not
+   *        be modified concurrently), so that querying it is cheap
+   *  \deprecated reading threading.max_count from Config() to obtain the current number of threads, use this or
+   *              ConcurrentConfig() instead
+   *  \attention setting threading.max_count in the configuration after the ThreadManager was constructed (i.e. after
+   *             the first call of threadManager()) has no effect, call set_max_threads instead **/
   size_t max_threads();
 
   //! return number of current threads
   size_t current_threads();
 
-  //! return thread number
+  /** return thread number, the smallest number not used by any other thread alive
+   *  \note the number is cached per thread, so only the first call in each thread needs to lock **/
   size_t thread();
 
   //! set maximal number of threads available during run
   void set_max_threads(const size_t count);
 
-  ~ThreadManager() = default;
+#if HAVE_TBB
+  /** a task arena with a concurrency of max_threads(), i.e. a hard limit on the number of threads working on tasks
+   *  executed via arena().execute(...), as opposed to the soft limit of tbb::task_scheduler_init
+   *  \note set_max_threads replaces the arena, so it must not be called while tasks run in it **/
+  tbb::task_arena& arena();
+#endif
+
+  /** the pool used by parallel_for and friends without TBB (see threadPool()), with max_threads() - 1 workers
+   *  \note set_max_threads replaces the pool, so it must not be called while tasks run in it or from within a task **/
+  ThreadPool& pool();
+
+  ~ThreadManager();
 
 private:
   friend ThreadManager& threadManager();
   //! init tbb with given thread count, prepare Eigen for smp if possible
   ThreadManager();
 
-  size_t max_threads_;
+  void reset_pool(const size_t count);
+
+  std::atomic<size_t> max_threads_;
+#if HAVE_TBB
+  std::unique_ptr<tbb::task_arena> arena_;
+#endif
+  std::mutex pool_mutex_;
+  std::unique_ptr<ThreadPool> pool_;
+  std::atomic<ThreadPool*> pool_ptr_;
 };
 
 inline ThreadManager& threadManager()
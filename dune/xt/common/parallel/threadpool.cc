@@ -0,0 +1,137 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include "threadpool.hh"
+
+#include <dune/xt/common/parallel/threadmanager.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace {
+
+
+// the pool the calling thread is a worker of, if any
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+
+} // namespace
+
+
+ThreadPool& threadPool()
+{
+  return threadManager().pool();
+}
+
+
+ThreadPool::ThreadPool(const size_t num_workers)
+  : queued_(0)
+  , stop_(false)
+{
+  for (size_t ii = 0; ii < num_workers; ++ii)
+    queues_.emplace_back(new ChaseLevDeque<TaskType>());
+  // all queues have to exist before the first worker may steal
+  for (size_t ii = 0; ii < num_workers; ++ii)
+    workers_.emplace_back([this, ii]() { work(ii); });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_up_.notify_all();
+  for (auto&& worker : workers_)
+    worker.join();
+  // the workers are gone, so this thread may act as owner of their queues
+  for (auto&& queue : queues_)
+    while (auto* task = queue->take())
+      delete task;
+}
+
+size_t ThreadPool::num_workers() const
+{
+  return workers_.size();
+}
+
+size_t ThreadPool::worker_index() const
+{
+  return (current_pool == this) ? current_worker : num_workers();
+}
+
+void ThreadPool::submit(TaskType task)
+{
+  if (queues_.empty()) {
+    task();
+    return;
+  }
+  std::unique_ptr<TaskType> owned_task(new TaskType(std::move(task)));
+  // counted before it can be taken, so the counter never drops below 0
+  ++queued_;
+  if (current_pool == this) {
+    queues_[current_worker]->push(owned_task.release());
+  } else {
+    std::lock_guard<std::mutex> lock(shared_mutex_);
+    shared_tasks_.emplace_back(std::move(owned_task));
+  }
+  // taking the lock ensures no worker is between checking queued_ and going to sleep
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  wake_up_.notify_one();
+} // ... submit(...)
+
+bool ThreadPool::try_run_one()
+{
+  const auto task = next_task(worker_index());
+  if (!task)
+    return false;
+  (*task)();
+  return true;
+}
+
+std::unique_ptr<ThreadPool::TaskType> ThreadPool::next_task(const size_t index)
+{
+  std::unique_ptr<TaskType> task;
+  if (index < queues_.size())
+    task.reset(queues_[index]->take());
+  if (!task && queued_ > 0) {
+    std::lock_guard<std::mutex> lock(shared_mutex_);
+    if (!shared_tasks_.empty()) {
+      task = std::move(shared_tasks_.front());
+      shared_tasks_.pop_front();
+    }
+  }
+  const auto num_queues = queues_.size();
+  for (size_t ii = 1; !task && ii <= num_queues; ++ii) {
+    const auto victim = (index + ii) % num_queues;
+    if (victim != index)
+      task.reset(queues_[victim]->steal());
+  }
+  if (task)
+    --queued_;
+  return task;
+} // ... next_task(...)
+
+void ThreadPool::work(const size_t index)
+{
+  current_pool = this;
+  current_worker = index;
+  while (!stop_) {
+    if (try_run_one())
+      continue;
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_up_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+  }
+}
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,86 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_PARALLEL_THREADPOOL_HH
+#define DUNE_XT_COMMON_PARALLEL_THREADPOOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <dune/xt/common/parallel/chase_lev_deque.hh>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+class ThreadPool;
+
+/** global pool with threadManager().max_threads() - 1 workers (the calling thread being the remaining one)
+ *  \note the pool is replaced by ThreadManager::set_max_threads, so references to it must not be kept across calls
+ *        of set_max_threads **/
+ThreadPool& threadPool();
+
+
+/** \brief pool of worker threads executing tasks, with one lock-free task queue (a ChaseLevDeque) per worker
+ *
+ *  Tasks submitted by a worker are pushed to its own queue and taken from there last in, first out. Workers running
+ *  out of tasks steal the oldest tasks from the queues of other workers. Tasks submitted from other threads are put
+ *  into a shared (locked) queue, which workers check before stealing.
+ *
+ *  There is no way to wait for a single task, instead threads waiting for some condition should call try_run_one()
+ *  until the condition is met. That way, a task waiting for other tasks (e.g. a nested parallel loop) never blocks a
+ *  worker the other tasks depend on.
+ **/
+class ThreadPool : public boost::noncopyable
+{
+public:
+  typedef std::function<void()> TaskType;
+
+  explicit ThreadPool(const size_t num_workers);
+
+  //! waits for all workers to finish their current task, tasks still queued are discarded
+  ~ThreadPool();
+
+  size_t num_workers() const;
+
+  void submit(TaskType task);
+
+  //! runs one queued task in the calling thread, \return false if there was none
+  bool try_run_one();
+
+  //! index of the calling worker in [0, num_workers()) or num_workers() if the calling thread is not a worker
+  size_t worker_index() const;
+
+private:
+  std::unique_ptr<TaskType> next_task(const size_t index);
+  void work(const size_t index);
+
+  std::vector<std::unique_ptr<ChaseLevDeque<TaskType>>> queues_;
+  std::mutex shared_mutex_;
+  std::deque<std::unique_ptr<TaskType>> shared_tasks_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> queued_;
+  std::atomic<bool> stop_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_up_;
+}; // class ThreadPool
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_PARALLEL_THREADPOOL_HH
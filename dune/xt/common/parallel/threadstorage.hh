@@ -17,39 +17,268 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <numeric>
 #include <system_error>
 #include <type_traits>
+#include <vector>
+
+#include <cstdlib>
+#include <new>
+
+#include <unistd.h>
+
+#include <boost/iterator/indirect_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
 
 #include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/parallel/algorithms.hh>
+#include <dune/xt/common/parallel/threadmanager.hh>
+#include <dune/xt/common/reproducible_sum.hh>
 
 // TODO: the following includes can be removed when UnsafePerThreadValue is removed
 #include <deque>
 #include <memory>
 #include <boost/noncopyable.hpp>
-#include <dune/xt/common/parallel/threadmanager.hh>
 
 namespace Dune {
 namespace XT {
 namespace Common {
+
+
+// std::hardware_destructive_interference_size depends on the compiler flags (and warns about that), which would
+// change the layout of all types using it between translation units
+#ifndef DXTC_CACHE_LINE_SIZE
+#  define DXTC_CACHE_LINE_SIZE 64
+#endif
+
+//! size of a cache line, values accessed by different threads should be at least this far apart
+constexpr size_t cache_line_size = DXTC_CACHE_LINE_SIZE;
+
+namespace internal {
+
+
+//! true if Args is a single argument of type Self, to keep forwarding constructors from hiding copy constructors
+template <class Self, class... Args>
+struct is_self : public std::false_type
+{};
+
+template <class Self, class Arg>
+struct is_self<Self, Arg> : public std::is_same<Self, std::decay_t<Arg>>
+{};
+
+//! a value alone on its cache line(s)
+template <class T>
+class alignas(cache_line_size) PaddedValue
+{
+public:
+  template <class... Args, class = std::enable_if_t<!is_self<PaddedValue, Args...>::value>>
+  explicit PaddedValue(Args&&... args)
+    : value_(std::forward<Args>(args)...)
+  {}
+
+  T& get()
+  {
+    return value_;
+  }
+
+  const T& get() const
+  {
+    return value_;
+  }
+
+  // operator new only respects alignas beyond alignof(std::max_align_t) as of C++17
+  static void* operator new(std::size_t size)
+  {
+    void* memory = nullptr;
+    if (posix_memalign(&memory, alignof(PaddedValue), size) != 0)
+      throw std::bad_alloc();
+    return memory;
+  }
+
+  static void operator delete(void* memory)
+  {
+    std::free(memory);
+  }
+
+  static void* operator new(std::size_t /*size*/, void* memory)
+  {
+    return memory;
+  }
+
+  static void operator delete(void* /*memory*/, void* /*place*/) {}
+
+private:
+  T value_;
+}; // class PaddedValue
+
+inline size_t page_size()
+{
+#ifdef _SC_PAGESIZE
+  static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+/** a value on page(s) of its own, which are first touched by the thread constructing it
+ *  \note with a first touch NUMA policy (Linux' default), the value thus resides on the memory node of the thread
+ *        constructing it, which for the values of PerThreadValue is the thread owning it. This does not apply to memory
+ *        allocated by the value itself (e.g. the elements of a std::vector). **/
+template <class T>
+class FirstTouchValue
+{
+public:
+  template <class... Args, class = std::enable_if_t<!is_self<FirstTouchValue, Args...>::value>>
+  explicit FirstTouchValue(Args&&... args)
+    : value_(allocate())
+  {
+    try {
+      new (value_) T(std::forward<Args>(args)...);
+    } catch (...) {
+      std::free(value_);
+      throw;
+    }
+  }
+
+  FirstTouchValue(const FirstTouchValue& other)
+    : FirstTouchValue(other.get())
+  {}
+
+  FirstTouchValue(FirstTouchValue&& other) noexcept
+    : value_(other.value_)
+  {
+    other.value_ = nullptr;
+  }
+
+  FirstTouchValue& operator=(FirstTouchValue other)
+  {
+    std::swap(value_, other.value_);
+    return *this;
+  }
+
+  ~FirstTouchValue()
+  {
+    if (value_) {
+      value_->~T();
+      std::free(value_);
+    }
+  }
+
+  T& get()
+  {
+    return *value_;
+  }
+
+  const T& get() const
+  {
+    return *value_;
+  }
+
+private:
+  static T* allocate()
+  {
+    const auto alignment = std::max(page_size(), alignof(T));
+    void* memory = nullptr;
+    if (posix_memalign(&memory, alignment, ((sizeof(T) + alignment - 1) / alignment) * alignment) != 0)
+      throw std::bad_alloc();
+    return static_cast<T*>(memory);
+  }
+
+  T* value_;
+}; // class FirstTouchValue
+
+
+} // namespace internal
+
+
+/** \name Storage policies for PerThreadValue
+ *  Each policy defines the type SlotType<T> actually stored per thread for a value of type T and how to access the
+ *  value in a slot.
+ *  \{ **/
+
+//! stores the values as they are, adjacent values of different threads may share a cache line
+struct DefaultThreadStorage
+{
+  template <class T>
+  using SlotType = T;
+
+  template <class T>
+  static T& value(T& slot)
+  {
+    return slot;
+  }
+};
+
+//! aligns and pads each value to cache_line_size, so that threads updating their values do not interfere
+struct PaddedThreadStorage
+{
+  template <class T>
+  using SlotType = internal::PaddedValue<T>;
+
+  template <class Slot>
+  static auto& value(Slot& slot)
+  {
+    return slot.get();
+  }
+};
+
+/** puts each value on memory pages of its own, allocated and first touched by the owning thread, so that each value
+ *  resides on the NUMA node of its thread (implies padding, at the cost of at least one page per value and thread) **/
+struct FirstTouchThreadStorage
+{
+  template <class T>
+  using SlotType = internal::FirstTouchValue<T>;
+
+  template <class Slot>
+  static auto& value(Slot& slot)
+  {
+    return slot.get();
+  }
+};
+
+//! \}
+
+
 namespace internal {
 
 
+//! accesses the value of a slot, for use with boost::transform_iterator
+template <class StoragePolicy, class ValueType, class SlotType>
+struct SlotAccess
+{
+  ValueType& operator()(SlotType& slot) const
+  {
+    return StoragePolicy::value(slot);
+  }
+};
+
+
 #if HAVE_TBB
 
-template <class ValueImp>
+template <class ValueImp, class StoragePolicy = DefaultThreadStorage>
 class EnumerableThreadSpecificWrapper
 {
   // enumerable_thread_specific does not compile with ConstValueType as template param
-  using BackendType = typename tbb::enumerable_thread_specific<std::remove_const_t<ValueImp>>;
+  using StorageType = std::remove_const_t<ValueImp>;
+  using SlotType = typename StoragePolicy::template SlotType<StorageType>;
+  using BackendType = typename tbb::enumerable_thread_specific<SlotType>;
 
 public:
   using ValueType = ValueImp;
   using ConstValueType = std::add_const_t<ValueType>;
-  using iterator = typename BackendType::iterator;
-  using const_iterator = typename BackendType::const_iterator;
+  using iterator = boost::transform_iterator<SlotAccess<StoragePolicy, ValueType, SlotType>,
+                                             typename BackendType::iterator,
+                                             ValueType&,
+                                             ValueType>;
+  using const_iterator = boost::transform_iterator<SlotAccess<StoragePolicy, ConstValueType, const SlotType>,
+                                                   typename BackendType::const_iterator,
+                                                   ConstValueType&,
+                                                   ValueType>;
 
   template <class... InitTypes>
   explicit EnumerableThreadSpecificWrapper(InitTypes&&... ctor_args)
@@ -58,108 +287,208 @@ public:
 
   ValueType& local()
   {
-    return values_.local();
+    return StoragePolicy::value(values_.local());
   }
 
   // tbb does not provide a const version of local (as elements may be inserted when a new thread accesses values_), so
   // values_ has to be mutable
   const ValueType& local() const
   {
-    return values_.local();
+    return StoragePolicy::value(values_.local());
   }
 
-  typename BackendType::iterator begin()
+  iterator begin()
   {
-    return values_.begin();
+    return iterator(values_.begin());
   }
 
-  typename BackendType::iterator end()
+  iterator end()
   {
-    return values_.end();
+    return iterator(values_.end());
   }
 
-  typename BackendType::const_iterator begin() const
+  const_iterator begin() const
   {
-    return values_.begin();
+    return const_iterator(static_cast<const BackendType&>(values_).begin());
   }
 
-  typename BackendType::const_iterator end() const
+  const_iterator end() const
   {
-    return values_.end();
+    return const_iterator(static_cast<const BackendType&>(values_).end());
   }
 
   template <class BinaryOperation>
   ValueType combine(BinaryOperation op) const
   {
-    return values_.combine(op);
+    return combine(op, std::is_same<SlotType, StorageType>());
   }
 
 private:
+  template <class BinaryOperation>
+  ValueType combine(BinaryOperation op, std::true_type /*values are stored directly*/) const
+  {
+    return values_.combine(op);
+  }
+
+  template <class BinaryOperation>
+  ValueType combine(BinaryOperation op, std::false_type /*values are stored in slots*/) const
+  {
+    auto result = values_.combine([&](const SlotType& left, const SlotType& right) {
+      return SlotType(op(StoragePolicy::value(left), StoragePolicy::value(right)));
+    });
+    return StoragePolicy::value(result);
+  }
+
   mutable BackendType values_;
 }; // class EnumerableThreadSpecificWrapper<ValueImp>
 
 #else // HAVE_TBB
 
-template <class ValueImp>
+/** \brief one value per thread, created on first access from that thread by copying an exemplar
+ *
+ *  Mimics tbb::enumerable_thread_specific for the workers of ThreadPool (and any other thread): each thread finds
+ *  its value via its ThreadManager::thread() number in a table of segments of growing size, without locking. Only
+ *  creating a value locks.
+ *  \note Thread numbers are reused, so a thread replacing an exited one continues with the value of the exited thread,
+ *        which keeps the number of values bounded by the number of threads alive at the same time.
+ **/
+template <class ValueImp, class StoragePolicy = DefaultThreadStorage>
 class EnumerableThreadSpecificWrapper
 {
-  using BackendType = std::unique_ptr<std::remove_const_t<ValueImp>>;
+  using StorageType = std::remove_const_t<ValueImp>;
+  using SlotType = typename StoragePolicy::template SlotType<StorageType>;
+  using SlotPointerType = std::atomic<SlotType*>;
+  using SlotsType = std::vector<std::unique_ptr<SlotType>>;
+  //! segment ii holds the values of the threads numbered 2^ii - 1, ..., 2^(ii + 1) - 2
+  static constexpr size_t num_segments = 8 * sizeof(size_t);
+
+  struct Storage
+  {
+    Storage()
+    {
+      for (auto&& segment : segments)
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~Storage()
+    {
+      for (auto&& segment : segments)
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<SlotPointerType*>, num_segments> segments;
+    std::mutex mutex;
+    //! in order of creation
+    SlotsType slots;
+  }; // struct Storage
+
+  //! dereferences the unique_ptr and accesses the value of the slot
+  template <class V>
+  struct Access
+  {
+    V& operator()(const std::unique_ptr<SlotType>& slot) const
+    {
+      return StoragePolicy::value(*slot);
+    }
+  };
 
 public:
   using ValueType = ValueImp;
   using ConstValueType = std::add_const_t<ValueType>;
-  using iterator = ValueType*;
-  using const_iterator = const ValueType*;
+  using iterator = boost::transform_iterator<Access<ValueType>, typename SlotsType::iterator, ValueType&, ValueType>;
+  using const_iterator =
+      boost::transform_iterator<Access<ConstValueType>, typename SlotsType::const_iterator, ConstValueType&, ValueType>;
 
   //! Initialization by copy construction of ValueType
   explicit EnumerableThreadSpecificWrapper(ConstValueType& value)
-    : values_(std::make_unique<std::remove_const_t<ValueType>>(value))
+    : exemplar_(std::make_unique<SlotType>(value))
+    , storage_(std::make_unique<Storage>())
   {}
 
   //! Initialization by in-place construction ValueType with \param ctor_args
   template <class... InitTypes>
   explicit EnumerableThreadSpecificWrapper(InitTypes&&... ctor_args)
-    : values_(std::make_unique<std::remove_const_t<ValueType>>(std::forward<InitTypes>(ctor_args)...))
+    : exemplar_(std::make_unique<SlotType>(std::forward<InitTypes>(ctor_args)...))
+    , storage_(std::make_unique<Storage>())
   {}
 
   ValueType& local()
   {
-    return *values_;
+    return StoragePolicy::value(local_slot());
   }
 
   const ValueType& local() const
   {
-    return *values_;
+    return StoragePolicy::value(local_slot());
   }
 
   iterator begin()
   {
-    return values_.get();
+    return iterator(storage_->slots.begin());
   }
 
   iterator end()
   {
-    return values_.get() + 1;
+    return iterator(storage_->slots.end());
   }
 
   const_iterator begin() const
   {
-    return values_.get();
+    return const_iterator(storage_->slots.cbegin());
   }
 
   const_iterator end() const
   {
-    return values_.get() + 1;
+    return const_iterator(storage_->slots.cend());
   }
 
+  //! \return op(...op(op(v_0, v_1), v_2)..., v_n) of all values in order of creation, a copy of the exemplar if none
   template <class BinaryOperation>
-  ValueType combine(BinaryOperation /*op*/) const
+  ValueType combine(BinaryOperation op) const
   {
-    return *values_;
+    const auto& slots = storage_->slots;
+    if (slots.empty())
+      return StoragePolicy::value(*exemplar_);
+    StorageType result = StoragePolicy::value(*slots.front());
+    for (size_t ii = 1; ii < slots.size(); ++ii)
+      result = op(result, StoragePolicy::value(*slots[ii]));
+    return result;
   }
 
 private:
-  BackendType values_;
+  SlotType& local_slot() const
+  {
+    const size_t number = threadManager().thread();
+    size_t segment = 0;
+    for (auto tmp = number + 1; tmp > 1; tmp >>= 1)
+      ++segment;
+    auto& segment_ptr = storage_->segments[segment];
+    auto* segment_slots = segment_ptr.load(std::memory_order_acquire);
+    if (!segment_slots) {
+      auto* new_slots = new SlotPointerType[size_t(1) << segment];
+      for (size_t ii = 0; ii < (size_t(1) << segment); ++ii)
+        new_slots[ii].store(nullptr, std::memory_order_relaxed);
+      if (segment_ptr.compare_exchange_strong(segment_slots, new_slots, std::memory_order_acq_rel))
+        segment_slots = new_slots;
+      else
+        delete[] new_slots;
+    }
+    // only the thread holding the number writes its slot pointer
+    auto& slot_ptr = segment_slots[number + 1 - (size_t(1) << segment)];
+    auto* slot = slot_ptr.load(std::memory_order_relaxed);
+    if (!slot) {
+      // created (and thus first touched) in this thread
+      auto new_slot = std::make_unique<SlotType>(*exemplar_);
+      std::lock_guard<std::mutex> lock(storage_->mutex);
+      storage_->slots.emplace_back(std::move(new_slot));
+      slot = storage_->slots.back().get();
+      slot_ptr.store(slot, std::memory_order_relaxed);
+    }
+    return *slot;
+  } // ... local_slot(...)
+
+  std::unique_ptr<SlotType> exemplar_;
+  std::unique_ptr<Storage> storage_;
 }; // class EnumerableThreadSpecificWrapper<ValueImp>
 
 #endif // HAVE_TBB
@@ -169,11 +498,12 @@ private:
 
 
 /** Automatic Storage of non-static, N thread-local values
+ *  \tparam StoragePolicy one of DefaultThreadStorage, PaddedThreadStorage, FirstTouchThreadStorage
  **/
-template <class ValueImp>
+template <class ValueImp, class StoragePolicy = DefaultThreadStorage>
 class PerThreadValue
 {
-  using ContainerType = internal::EnumerableThreadSpecificWrapper<ValueImp>;
+  using ContainerType = internal::EnumerableThreadSpecificWrapper<ValueImp, StoragePolicy>;
 
 public:
   using ValueType = typename ContainerType::ValueType;
@@ -221,9 +551,41 @@ public:
     return op(init, values_.combine(op));
   }
 
-  ValueType sum() const
+  /** \param mode SummationMode::reproducible sums double and float values exactly, so the result does not depend on
+   *         the order of the values (but still on how the work was distributed among the threads, accumulate into a
+   *         PerThreadValue<ReproducibleSum> if this matters) **/
+  ValueType sum(const SummationMode mode = SummationMode::fast) const
   {
-    return accumulate(ValueType(0), std::plus<ValueType>());
+    return Common::sum<ValueType>(begin(), end(), mode);
+  }
+
+  /** like accumulate, but combines pairs of values concurrently (init counting as the first value), see
+   *  parallel_tree_reduce
+   *  \note the values are combined in the order of their creation, which depends on the order in which the threads
+   *        first accessed their values. **/
+  template <class BinaryOperation>
+  ValueType
+  tree_accumulate(ValueType init, BinaryOperation op, const ParallelOptions& options = ParallelOptions()) const
+  {
+    std::vector<std::remove_const_t<ValueType>> values(1, init);
+    values.insert(values.end(), begin(), end());
+    return parallel_tree_reduce(std::move(values), init, op, options);
+  }
+
+  /** like tree_accumulate, but moves the values instead of copying them, so op may reuse their resources
+   *  \note leaves the values of all threads in a valid but unspecified (moved-from) state **/
+  template <class BinaryOperation>
+  ValueType tree_reduce(ValueType init, BinaryOperation op, const ParallelOptions& options = ParallelOptions())
+  {
+    std::vector<std::remove_const_t<ValueType>> values(1, init);
+    for (auto&& value : *this)
+      values.emplace_back(std::move(value));
+    return parallel_tree_reduce(std::move(values), init, op, options);
+  }
+
+  ValueType tree_sum(const ParallelOptions& options = ParallelOptions()) const
+  {
+    return tree_accumulate(ValueType(0), std::plus<ValueType>(), options);
   }
 
   typename ContainerType::iterator begin()
@@ -246,20 +608,17 @@ public:
 
 private:
   ContainerType values_;
-}; // class PerThreadValue<ValueImp>
+}; // class PerThreadValue<ValueImp, StoragePolicy>
 
 
 /**
  * Previous implementation of PerThreadValue. This implementation suffers from the fact that it is not possible (or
  * at least we did not find a way yet) to set a hard upper limit on the number of threads TBB uses. Setting max_threads
- * via tbb::task_scheduler_init apparently only sets a soft limit on the number of threads. In addition, even if TBB
- * uses only N threads at a time, it might be possible that a thread is destroyed and later in the program another
- * thread with a different id replaces it, which will then get a number greater than or equal to N in our
- * implementation (see ThreadManager::thread()). This occasionally leads to segfaults.
- * We keep this implementation around as it is currently used by TimingData (see dune/xt/common/timings.hh) and the
- * new implementation can't replace it in that context, as the new implementation based on
- * tbb::enumerable_thread_specific lazily initalizes the values in each thread.
- * \todo Either fix TimingData and remove this class or fix this class.
+ * via tbb::task_scheduler_init apparently only sets a soft limit on the number of threads. (Threads replacing exited
+ * ones reuse their numbers, see ThreadManager::thread(), but more than N threads alive at a time still get numbers
+ * greater than or equal to N.) This occasionally leads to segfaults.
+ * It is no longer used within dune-xt-common (Timings keeps its per-thread data in a PerThreadValue, see
+ * dune/xt/common/timings.hh) and is only kept for existing users, use PerThreadValue instead.
  **/
 template <class ValueImp>
 class UnsafePerThreadValue : public boost::noncopyable
@@ -333,9 +692,29 @@ public:
     return std::accumulate(values_.begin(), values_.end(), init, l);
   }
 
-  ValueType sum() const
+  ValueType sum(const SummationMode mode = SummationMode::fast) const
+  {
+    return Common::sum<ValueType>(boost::make_indirect_iterator(values_.begin()),
+                                  boost::make_indirect_iterator(values_.end()),
+                                  mode);
+  }
+
+  //! like accumulate, but combines init and the values concurrently in pairs (in the order of the thread numbers), see
+  //! parallel_tree_reduce
+  template <class BinaryOperation>
+  ValueType
+  tree_accumulate(ValueType init, BinaryOperation op, const ParallelOptions& options = ParallelOptions()) const
+  {
+    std::vector<std::remove_const_t<ValueType>> values(1, init);
+    values.reserve(values_.size() + 1);
+    for (const auto& value : values_)
+      values.emplace_back(*value);
+    return parallel_tree_reduce(std::move(values), init, op, options);
+  }
+
+  ValueType tree_sum(const ParallelOptions& options = ParallelOptions()) const
   {
-    return accumulate(ValueType(0), std::plus<ValueType>());
+    return tree_accumulate(ValueType(0), std::plus<ValueType>(), options);
   }
 
   typename ContainerType::iterator begin()
@@ -0,0 +1,125 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+#include "perf_counters.hh"
+
+#include <cstring>
+
+#if HAVE_PERF_EVENT_OPEN
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace {
+
+
+#if HAVE_PERF_EVENT_OPEN
+
+int open_perf_event(std::uint32_t type, std::uint64_t config, int group_fd)
+{
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  // the group is enabled at once via the leader
+  attr.disabled = (group_fd == -1) ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // pid 0 and cpu -1: the calling thread on any cpu
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+#endif // HAVE_PERF_EVENT_OPEN
+
+
+} // namespace
+
+
+const std::array<std::string, PerfCounterGroup::num_events>& PerfCounterGroup::names()
+{
+  static const std::array<std::string, num_events> event_names = {
+      {"cycles", "instructions", "cache_misses", "branch_misses", "flops"}};
+  return event_names;
+}
+
+PerfCounterGroup::PerfCounterGroup(const FlopEventsType&
+#if HAVE_PERF_EVENT_OPEN
+                                       raw_flop_events
+#endif
+)
+{
+#if HAVE_PERF_EVENT_OPEN
+  const int leader = open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (leader < 0)
+    return;
+  fds_.push_back(leader);
+  targets_.emplace_back(0, 1);
+  const auto add = [&](std::uint32_t type, std::uint64_t config, std::size_t index, std::uint64_t weight) {
+    const int fd = open_perf_event(type, config, leader);
+    if (fd < 0)
+      return;
+    fds_.push_back(fd);
+    targets_.emplace_back(index, weight);
+  };
+  add(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 1, 1);
+  add(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 2, 1);
+  add(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 3, 1);
+  for (const auto& flop_event : raw_flop_events)
+    add(PERF_TYPE_RAW, flop_event.first, 4, flop_event.second);
+  // nr, time_enabled, time_running, one value per event
+  buffer_.resize(3 + fds_.size());
+  ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif // HAVE_PERF_EVENT_OPEN
+}
+
+PerfCounterGroup::~PerfCounterGroup()
+{
+#if HAVE_PERF_EVENT_OPEN
+  for (auto fd = fds_.rbegin(); fd != fds_.rend(); ++fd)
+    close(*fd);
+#endif
+}
+
+bool PerfCounterGroup::available() const
+{
+  return !fds_.empty();
+}
+
+PerfCounterGroup::ValuesType PerfCounterGroup::read() const
+{
+  ValuesType values;
+  values.fill(0);
+#if HAVE_PERF_EVENT_OPEN
+  if (fds_.empty())
+    return values;
+  const auto bytes = static_cast<ssize_t>(buffer_.size() * sizeof(std::uint64_t));
+  if (::read(fds_[0], buffer_.data(), bytes) != bytes || buffer_[0] != fds_.size())
+    return values;
+  const auto enabled = buffer_[1];
+  const auto running = buffer_[2];
+  if (running == 0)
+    return values;
+  const double scale = double(enabled) / double(running);
+  for (std::size_t ii = 0; ii < targets_.size(); ++ii)
+    values[targets_[ii].first] += static_cast<std::uint64_t>(buffer_[3 + ii] * scale) * targets_[ii].second;
+#endif // HAVE_PERF_EVENT_OPEN
+  return values;
+} // ... read(...)
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,74 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_PERF_COUNTERS_HH
+#define DUNE_XT_COMMON_PERF_COUNTERS_HH
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+/** \brief hardware performance counters of the calling thread, based on Linux' perf_event_open
+ *
+ *  Counts cycles, instructions, cache misses, branch misses and (optionally) floating point operations of the thread
+ *  that constructed the group, in user space only. All counters are opened as one group and read with a single system
+ *  call.
+ *
+ *  There is no generic perf event for floating point operations, they have to be given as raw, model specific event
+ *  codes together with the number of flops per count. On recent Intel CPUs, for example
+\code
+PerfCounterGroup counters({{0x01c7, 1},   // FP_ARITH_INST_RETIRED.SCALAR_DOUBLE
+                           {0x04c7, 2},   // FP_ARITH_INST_RETIRED.128B_PACKED_DOUBLE
+                           {0x10c7, 4}}); // FP_ARITH_INST_RETIRED.256B_PACKED_DOUBLE
+\endcode
+ *  \note If perf events are not available (no kernel support, restrictive /proc/sys/kernel/perf_event_paranoid, no
+ *        HAVE_PERF_EVENT_OPEN), available() is false and read() returns zeros. Single events the CPU does not support
+ *        are skipped and read as 0.
+ **/
+class PerfCounterGroup : public boost::noncopyable
+{
+public:
+  static constexpr std::size_t num_events = 5;
+  typedef std::array<std::uint64_t, num_events> ValuesType;
+  //! pairs of (raw event code, flops per count)
+  typedef std::vector<std::pair<std::uint64_t, std::uint64_t>> FlopEventsType;
+
+  //! names of the counted events, in the order of ValuesType
+  static const std::array<std::string, num_events>& names();
+
+  explicit PerfCounterGroup(const FlopEventsType& raw_flop_events = FlopEventsType());
+
+  ~PerfCounterGroup();
+
+  bool available() const;
+
+  //! current counter values since construction, scaled if the kernel had to multiplex the counters
+  ValuesType read() const;
+
+private:
+  //! group leader first
+  std::vector<int> fds_;
+  //! (index in ValuesType, weight) of each opened event
+  std::vector<std::pair<std::size_t, std::uint64_t>> targets_;
+  mutable std::vector<std::uint64_t> buffer_;
+}; // class PerfCounterGroup
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_PERF_COUNTERS_HH
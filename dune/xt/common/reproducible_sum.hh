@@ -0,0 +1,254 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_REPRODUCIBLE_SUM_HH
+#define DUNE_XT_COMMON_REPRODUCIBLE_SUM_HH
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+
+enum class SummationMode
+{
+  //! plain floating-point summation, the result depends on the order of the summands
+  fast,
+  //! exact summation (see ReproducibleSum), the result is bitwise identical for any order of the summands
+  reproducible
+};
+
+
+/** \brief exact accumulator for sums of doubles, thus independent of the order of summation
+ *
+ *  Every double is an integer multiple of 2^-1074, so the sum of doubles is kept exactly as a fixed-point number with
+ *  digits of 32 bits (a superaccumulator). Adding a double updates (at most) three digits without rounding. Since each
+ *  digit is stored in 64 bits, carries only need to be propagated every 2^29 additions. Accumulators can be merged,
+ *  e.g. those of several threads or ranks, and their value() is a deterministic function of the exact sum, correct up
+ *  to a few ulp. So sums are bitwise reproducible regardless of the order of summands, the number of threads or ranks.
+ *
+ *  Adding costs about as much as a few floating-point additions, see the ReproducibleSum.Benchmark test. Infinite
+ *  and NaN summands are summed in floating-point arithmetic and dominate the result, as in a plain sum.
+ **/
+class ReproducibleSum
+{
+public:
+  static constexpr size_t digit_bits = 32;
+  //! positions of the bits of finite doubles (relative to 2^-1074) are below 2046 + 53, two digits headroom for carries
+  static constexpr size_t num_digits = (2046 + 53 + digit_bits - 1) / digit_bits + 2;
+
+  ReproducibleSum()
+    : pending_(0)
+    , special_(0)
+  {
+    digits_.fill(0);
+  }
+
+  //! allows ReproducibleSum(0) as neutral element, e.g. for PerThreadValue<ReproducibleSum>::sum()
+  ReproducibleSum(const double value)
+    : ReproducibleSum()
+  {
+    add(value);
+  }
+
+  void add(const double value)
+  {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto biased_exponent = static_cast<size_t>((bits >> 52) & 0x7ff);
+    if (biased_exponent == 0x7ff) {
+      special_ += value;
+      return;
+    }
+    std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+    // value = +-mantissa * 2^(position - 1074)
+    size_t position = 0;
+    if (biased_exponent > 0) {
+      mantissa |= std::uint64_t(1) << 52;
+      position = biased_exponent - 1;
+    }
+    if (mantissa == 0)
+      return;
+    const auto digit = position / digit_bits;
+    const auto shift = position % digit_bits;
+    const std::uint64_t low = (mantissa & digit_mask) << shift;
+    const std::uint64_t high = (mantissa >> digit_bits) << shift;
+    const std::int64_t sign = (bits >> 63) ? -1 : 1;
+    digits_[digit] += sign * static_cast<std::int64_t>(low & digit_mask);
+    digits_[digit + 1] += sign * static_cast<std::int64_t>((low >> digit_bits) + (high & digit_mask));
+    digits_[digit + 2] += sign * static_cast<std::int64_t>(high >> digit_bits);
+    if (++pending_ == max_pending)
+      normalize();
+  } // ... add(...)
+
+  ReproducibleSum& operator+=(const double value)
+  {
+    add(value);
+    return *this;
+  }
+
+  ReproducibleSum& operator+=(const ReproducibleSum& other)
+  {
+    ReproducibleSum normalized_other(other);
+    normalized_other.normalize();
+    normalize();
+    for (size_t ii = 0; ii < num_digits; ++ii)
+      digits_[ii] += normalized_other.digits_[ii];
+    special_ += normalized_other.special_;
+    pending_ = 1;
+    return *this;
+  }
+
+  //! \return the sum, correctly rounded up to a few ulp
+  double value() const
+  {
+    // NaN != 0 as well
+    if (special_ != 0)
+      return special_;
+    ReproducibleSum normalized(*this);
+    normalized.normalize();
+    // the digits of a negative sum are those of 2^(32 * num_digits) plus the sum, so convert its absolute value
+    const bool negative = normalized.digits_[num_digits - 1] < 0;
+    if (negative) {
+      for (auto&& digit : normalized.digits_)
+        digit = -digit;
+      normalized.normalize();
+    }
+    double result = 0;
+    for (size_t ii = 0; ii < num_digits; ++ii)
+      if (normalized.digits_[ii] != 0)
+        result += std::ldexp(static_cast<double>(normalized.digits_[ii]), int(ii * digit_bits) - 1074);
+    return negative ? -result : result;
+  }
+
+  explicit operator double() const
+  {
+    return value();
+  }
+
+  /** replaces each of sums[0], ..., sums[count - 1] by its sum over all ranks of comm, using a single reduction
+   *  \note exact for up to 2^20 ranks **/
+  template <class CommunicationType>
+  static void all_reduce(ReproducibleSum* sums, const size_t count, const CommunicationType& comm)
+  {
+    // normalized digits are below 2^32, so their sums are exact in double
+    std::vector<double> buffer;
+    buffer.reserve(count * (num_digits + 1));
+    for (size_t ii = 0; ii < count; ++ii) {
+      sums[ii].normalize();
+      buffer.insert(buffer.end(), sums[ii].digits_.begin(), sums[ii].digits_.end());
+      buffer.push_back(sums[ii].special_);
+    }
+    comm.sum(buffer.data(), static_cast<int>(buffer.size()));
+    auto it = buffer.begin();
+    for (size_t ii = 0; ii < count; ++ii) {
+      for (auto&& digit : sums[ii].digits_)
+        digit = static_cast<std::int64_t>(*it++);
+      sums[ii].special_ = *it++;
+      sums[ii].normalize();
+    }
+  } // ... all_reduce(...)
+
+private:
+  static constexpr std::uint64_t digit_mask = (std::uint64_t(1) << digit_bits) - 1;
+  //! each addition changes a digit by less than 2^33
+  static constexpr size_t max_pending = size_t(1) << 29;
+
+  //! propagates carries, so that all digits but the last are in [0, 2^32) and the representation is unique
+  void normalize()
+  {
+    std::int64_t carry = 0;
+    for (size_t ii = 0; ii + 1 < num_digits; ++ii) {
+      const auto digit = digits_[ii] + carry;
+      // floor division, shifting negative values is implementation-defined
+      carry = (digit >= 0) ? (digit >> digit_bits) : -((-digit + std::int64_t(digit_mask)) >> digit_bits);
+      digits_[ii] = digit - carry * (std::int64_t(1) << digit_bits);
+    }
+    digits_[num_digits - 1] += carry;
+    pending_ = 0;
+  } // ... normalize(...)
+
+  std::array<std::int64_t, num_digits> digits_;
+  size_t pending_;
+  double special_;
+}; // class ReproducibleSum
+
+inline ReproducibleSum operator+(ReproducibleSum left, const ReproducibleSum& right)
+{
+  left += right;
+  return left;
+}
+
+
+namespace internal {
+
+
+template <class T, bool = std::is_same<T, double>::value || std::is_same<T, float>::value>
+struct Summation
+{
+  template <class Iterator>
+  static T sum(Iterator first, Iterator last, const SummationMode /*mode*/)
+  {
+    return std::accumulate(first, last, T(0));
+  }
+};
+
+template <class T>
+struct Summation<T, true>
+{
+  template <class Iterator>
+  static T sum(Iterator first, Iterator last, const SummationMode mode)
+  {
+    if (mode == SummationMode::fast)
+      return std::accumulate(first, last, T(0));
+    ReproducibleSum result;
+    for (; first != last; ++first)
+      result.add(*first);
+    return static_cast<T>(result.value());
+  }
+};
+
+
+} // namespace internal
+
+
+/** \return the sum of [first, last) as a T, computed according to mode for double and float (any other type is summed
+ *          in order, starting from T(0)) **/
+template <class T, class Iterator>
+T sum(Iterator first, Iterator last, const SummationMode mode = SummationMode::fast)
+{
+  return internal::Summation<std::remove_cv_t<T>>::sum(first, last, mode);
+}
+
+/** replaces each of values[0], ..., values[count - 1] by its sum over all ranks of comm, computed according to mode
+ *  \note the fast mode is a plain MPI reduction, whose result may depend on the number of ranks **/
+template <class CommunicationType>
+void sum(double* values, const size_t count, const SummationMode mode, const CommunicationType& comm)
+{
+  if (mode == SummationMode::fast) {
+    comm.sum(values, static_cast<int>(count));
+    return;
+  }
+  std::vector<ReproducibleSum> sums(values, values + count);
+  ReproducibleSum::all_reduce(sums.data(), count, comm);
+  for (size_t ii = 0; ii < count; ++ii)
+    values[ii] = sums[ii].value();
+}
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_REPRODUCIBLE_SUM_HH
@@ -0,0 +1,567 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include "config.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#if HAVE_ZLIB
+#  include <zlib.h>
+#endif
+#if HAVE_ZSTD
+#  include <zstd.h>
+#endif
+
+#include "configuration.hh"
+#include "exceptions.hh"
+#include "rotating_logging.hh"
+
+namespace Dune {
+namespace XT {
+namespace Common {
+namespace {
+
+
+const char rotated_log_index_header[] = "# dune-xt-common log index 1";
+
+std::string compression_name(const LogCompression compression)
+{
+  switch (compression) {
+    case LogCompression::gzip:
+      return "gzip";
+    case LogCompression::zstd:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+LogCompression compression_from_name(const std::string& name)
+{
+  if (name == "none")
+    return LogCompression::none;
+  if (name == "gzip")
+    return LogCompression::gzip;
+  if (name == "zstd")
+    return LogCompression::zstd;
+  DUNE_THROW(Exceptions::configuration_error,
+             "Unknown log compression '" << name << "', use one of none, gzip and zstd!");
+}
+
+//! the extension of a compressed segment
+std::string compression_extension(const LogCompression compression)
+{
+  switch (compression) {
+    case LogCompression::gzip:
+      return ".log.gz";
+    case LogCompression::zstd:
+      return ".log.zst";
+    default:
+      return ".log";
+  }
+}
+
+void check_compression(const LogCompression compression)
+{
+#if !HAVE_ZLIB
+  if (compression == LogCompression::gzip)
+    DUNE_THROW(Exceptions::dependency_missing, "gzip compression of log files requires zlib!");
+#endif
+#if !HAVE_ZSTD
+  if (compression == LogCompression::zstd)
+    DUNE_THROW(Exceptions::dependency_missing, "zstd compression of log files requires libzstd!");
+#endif
+  (void)compression;
+}
+
+//! a single gzip member or zstd frame
+std::string compress_block(const LogCompression compression, const std::string& data)
+{
+  std::string compressed;
+#if HAVE_ZLIB
+  if (compression == LogCompression::gzip) {
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    // 16 + 15 selects the gzip format with the largest window
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      DUNE_THROW(Exceptions::external_error, "Could not initialize zlib!");
+    compressed.resize(deflateBound(&stream, uLong(data.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = uInt(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = uInt(compressed.size());
+    const auto result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END)
+      DUNE_THROW(Exceptions::external_error, "Compressing a log block with zlib failed!");
+    return compressed;
+  }
+#endif
+#if HAVE_ZSTD
+  if (compression == LogCompression::zstd) {
+    compressed.resize(ZSTD_compressBound(data.size()));
+    const auto size = ZSTD_compress(&compressed[0], compressed.size(), data.data(), data.size(), 3);
+    if (ZSTD_isError(size))
+      DUNE_THROW(Exceptions::external_error,
+                 "Compressing a log block with zstd failed: " << ZSTD_getErrorName(size) << "!");
+    compressed.resize(size);
+    return compressed;
+  }
+#endif
+  (void)compression;
+  return data;
+} // ... compress_block(...)
+
+std::string decompress_block(const LogCompression compression, const std::string& data, const size_t size)
+{
+  std::string decompressed(size, '\0');
+#if HAVE_ZLIB
+  if (compression == LogCompression::gzip) {
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = uInt(data.size());
+    if (inflateInit2(&stream, 16 + 15) != Z_OK)
+      DUNE_THROW(Exceptions::external_error, "Could not initialize zlib!");
+    stream.next_out = reinterpret_cast<Bytef*>(&decompressed[0]);
+    stream.avail_out = uInt(size);
+    const auto result = inflate(&stream, Z_FINISH);
+    const auto total = stream.total_out;
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END || total != size)
+      DUNE_THROW(Exceptions::logger_error, "Corrupt block in compressed log file!");
+    return decompressed;
+  }
+#endif
+#if HAVE_ZSTD
+  if (compression == LogCompression::zstd) {
+    const auto result = ZSTD_decompress(&decompressed[0], size, data.data(), data.size());
+    if (ZSTD_isError(result) || result != size)
+      DUNE_THROW(Exceptions::logger_error, "Corrupt block in compressed log file!");
+    return decompressed;
+  }
+#endif
+  (void)compression;
+  return data;
+} // ... decompress_block(...)
+
+std::int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+//! the numbers of all segments stem.NNNNNN.extension, ascending
+std::vector<size_t> segment_numbers(const std::string& stem, const std::string& extension)
+{
+  namespace fs = boost::filesystem;
+  std::vector<size_t> numbers;
+  const fs::path stem_path(stem);
+  const auto directory = stem_path.has_parent_path() ? stem_path.parent_path() : fs::path(".");
+  const auto prefix = stem_path.filename().string() + ".";
+  if (!fs::is_directory(directory))
+    return numbers;
+  for (fs::directory_iterator it(directory); it != fs::directory_iterator(); ++it) {
+    const auto name = it->path().filename().string();
+    if (name.size() != prefix.size() + 6 + extension.size() || name.compare(0, prefix.size(), prefix) != 0
+        || name.compare(prefix.size() + 6, std::string::npos, extension) != 0)
+      continue;
+    const auto digits = name.substr(prefix.size(), 6);
+    if (std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; }))
+      numbers.push_back(std::stoul(digits));
+  }
+  std::sort(numbers.begin(), numbers.end());
+  return numbers;
+} // ... segment_numbers(...)
+
+//! "stem" for "stem.log", the filename itself otherwise
+std::string rotated_log_stem(const std::string& filename)
+{
+  const std::string extension = ".log";
+  if (filename.size() > extension.size()
+      && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0)
+    return filename.substr(0, filename.size() - extension.size());
+  return filename;
+}
+
+
+} // namespace
+
+
+LogRotationOptions::LogRotationOptions(size_t max_size_in,
+                                       std::chrono::seconds max_age_in,
+                                       size_t max_segments_in,
+                                       LogCompression compression_in,
+                                       size_t block_size_in)
+  : max_size(max_size_in)
+  , max_age(max_age_in)
+  , max_segments(max_segments_in)
+  , compression(compression_in)
+  , block_size(block_size_in)
+{}
+
+LogRotationOptions::LogRotationOptions(const Configuration& config)
+  : LogRotationOptions()
+{
+  max_size = config.get("max_size", max_size);
+  max_age = std::chrono::seconds(config.get("max_age", size_t(max_age.count())));
+  max_segments = config.get("max_segments", max_segments);
+  compression = compression_from_name(config.get("compression", compression_name(compression)));
+  block_size = config.get("block_size", block_size);
+}
+
+bool LogRotationOptions::enabled() const
+{
+  return max_size > 0 || max_age.count() > 0;
+}
+
+
+RotatingFileBuffer::RotatingFileBuffer()
+  : segment_size_(0)
+  , block_({0, 0, 0, 0})
+  , next_number_(1)
+  , busy_(false)
+  , stop_(false)
+{}
+
+RotatingFileBuffer::RotatingFileBuffer(const std::string& filename, const LogRotationOptions& options)
+  : RotatingFileBuffer()
+{
+  open(filename, options);
+}
+
+RotatingFileBuffer::~RotatingFileBuffer()
+{
+  close();
+}
+
+void RotatingFileBuffer::open(const std::string& filename, const LogRotationOptions& options)
+{
+  check_compression(options.compression);
+  close();
+  std::lock_guard<std::mutex> guard(mutex_);
+  filename_ = filename;
+  stem_ = rotated_log_stem(filename);
+  options_ = options;
+  file_.open(filename_, std::ios_base::binary | std::ios_base::trunc);
+  if (!file_.is_open())
+    DUNE_THROW(Exceptions::external_error, "Could not open '" << filename_ << "'!");
+  const auto indexed = segment_numbers(stem_, ".idx");
+  finished_.assign(indexed.begin(), indexed.end());
+  // uncompressed segments of an interrupted run are not indexed
+  const auto logs = segment_numbers(stem_, ".log");
+  next_number_ = 1 + std::max(indexed.empty() ? 0 : indexed.back(), logs.empty() ? 0 : logs.back());
+  segment_begin_ = std::chrono::steady_clock::now();
+  segment_size_ = 0;
+  block_ = {0, 0, 0, 0};
+  blocks_.clear();
+  stop_ = false;
+  worker_ = std::thread([this]() { work_(); });
+} // ... open(...)
+
+void RotatingFileBuffer::close()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!file_.is_open())
+      return;
+    rotate_();
+    file_.close();
+    // the active segment is empty now
+    boost::system::error_code ignored;
+    boost::filesystem::remove(filename_, ignored);
+    stop_ = true;
+  }
+  queued_.notify_one();
+  worker_.join();
+} // ... close(...)
+
+bool RotatingFileBuffer::is_open() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return file_.is_open();
+}
+
+void RotatingFileBuffer::rotate()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (file_.is_open())
+      rotate_();
+  }
+  queued_.notify_one();
+}
+
+void RotatingFileBuffer::wait()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+}
+
+std::streamsize RotatingFileBuffer::xsputn(const char_type* s, std::streamsize count)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!file_.is_open())
+      return 0;
+    write_(s, count);
+  }
+  queued_.notify_one();
+  return count;
+}
+
+RotatingFileBuffer::int_type RotatingFileBuffer::overflow(int_type ch)
+{
+  if (traits_type::eq_int_type(ch, traits_type::eof()))
+    return traits_type::not_eof(ch);
+  const auto character = traits_type::to_char_type(ch);
+  return (xsputn(&character, 1) == 1) ? ch : traits_type::eof();
+}
+
+int RotatingFileBuffer::sync()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (file_.is_open())
+    file_.flush();
+  return 0;
+}
+
+void RotatingFileBuffer::write_(const char* s, const size_t count)
+{
+  if (count == 0)
+    return;
+  const auto now = now_ns();
+  if (block_.size == 0) {
+    block_.begin = now;
+    block_.offset = segment_size_;
+  }
+  file_.write(s, count);
+  block_.end = now;
+  block_.size += count;
+  segment_size_ += count;
+  if (s[count - 1] != '\n')
+    return;
+  if (block_.size >= options_.block_size)
+    close_block_();
+  if ((options_.max_size > 0 && segment_size_ >= options_.max_size)
+      || (options_.max_age.count() > 0 && std::chrono::steady_clock::now() - segment_begin_ >= options_.max_age))
+    rotate_();
+} // ... write_(...)
+
+void RotatingFileBuffer::rotate_()
+{
+  if (segment_size_ > 0) {
+    close_block_();
+    file_.close();
+    Segment segment{next_number_++, std::move(blocks_)};
+    boost::filesystem::rename(filename_, segment_stem_(segment.number) + ".log");
+    queue_.push_back(std::move(segment));
+    file_.open(filename_, std::ios_base::binary | std::ios_base::trunc);
+    if (!file_.is_open())
+      DUNE_THROW(Exceptions::external_error, "Could not open '" << filename_ << "'!");
+  }
+  blocks_.clear();
+  segment_begin_ = std::chrono::steady_clock::now();
+  segment_size_ = 0;
+} // ... rotate_(...)
+
+void RotatingFileBuffer::close_block_()
+{
+  if (block_.size == 0)
+    return;
+  blocks_.push_back(block_);
+  block_ = {0, 0, 0, 0};
+}
+
+std::string RotatingFileBuffer::segment_stem_(const size_t number) const
+{
+  std::ostringstream stem;
+  stem << stem_ << "." << std::setw(6) << std::setfill('0') << number;
+  return stem.str();
+}
+
+void RotatingFileBuffer::compress_(const Segment& segment) const
+{
+  const auto stem = segment_stem_(segment.number);
+  const auto source_name = stem + ".log";
+  std::ostringstream index;
+  index << rotated_log_index_header << " " << compression_name(options_.compression) << "\n";
+  if (options_.compression == LogCompression::none) {
+    for (const auto& block : segment.blocks)
+      index << block.begin << " " << block.end << " " << block.offset << " " << block.size << " " << block.offset
+            << " " << block.size << "\n";
+  } else {
+    std::ifstream source(source_name, std::ios_base::binary);
+    const auto target_name = stem + compression_extension(options_.compression);
+    std::ofstream target(target_name, std::ios_base::binary | std::ios_base::trunc);
+    if (!source.is_open() || !target.is_open())
+      DUNE_THROW(Exceptions::external_error, "Could not compress '" << source_name << "'!");
+    std::string data;
+    std::uint64_t compressed_offset = 0;
+    for (const auto& block : segment.blocks) {
+      data.resize(block.size);
+      source.read(&data[0], block.size);
+      if (source.gcount() != std::streamsize(block.size))
+        DUNE_THROW(Exceptions::external_error, "Could not read '" << source_name << "'!");
+      const auto compressed = compress_block(options_.compression, data);
+      target.write(compressed.data(), compressed.size());
+      index << block.begin << " " << block.end << " " << block.offset << " " << block.size << " " << compressed_offset
+            << " " << compressed.size() << "\n";
+      compressed_offset += compressed.size();
+    }
+    target.close();
+    if (!target)
+      DUNE_THROW(Exceptions::external_error, "Could not write '" << target_name << "'!");
+  }
+  // the index is written last, a segment without one is not complete
+  std::ofstream index_file(stem + ".idx", std::ios_base::trunc);
+  index_file << index.str();
+  index_file.close();
+  if (!index_file)
+    DUNE_THROW(Exceptions::external_error, "Could not write '" << stem << ".idx'!");
+  if (options_.compression != LogCompression::none)
+    std::remove(source_name.c_str());
+} // ... compress_(...)
+
+void RotatingFileBuffer::remove_old_segments_()
+{
+  while (options_.max_segments > 0 && finished_.size() > options_.max_segments) {
+    const auto stem = segment_stem_(finished_.front());
+    finished_.pop_front();
+    // the index first, the segment is incomplete then
+    std::remove((stem + ".idx").c_str());
+    std::remove((stem + compression_extension(options_.compression)).c_str());
+  }
+}
+
+void RotatingFileBuffer::work_()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // stop_ is set, all segments are done
+      return;
+    }
+    const auto segment = std::move(queue_.front());
+    queue_.pop_front();
+    busy_ = true;
+    lock.unlock();
+    bool compressed = true;
+    // there is no one to report to on this thread
+    try {
+      compress_(segment);
+    } catch (Dune::Exception& ee) {
+      std::cerr << "Could not compress a log segment: " << ee.what() << std::endl;
+      compressed = false;
+    } catch (std::exception& ee) {
+      std::cerr << "Could not compress a log segment: " << ee.what() << std::endl;
+      compressed = false;
+    }
+    lock.lock();
+    if (compressed) {
+      finished_.push_back(segment.number);
+      remove_old_segments_();
+    }
+    busy_ = false;
+    done_.notify_all();
+  }
+} // ... work_(...)
+
+
+RotatingFileStream::RotatingFileStream()
+  : std::ostream(&buffer_)
+{}
+
+RotatingFileStream::RotatingFileStream(const std::string& filename, const LogRotationOptions& options)
+  : std::ostream(&buffer_)
+  , buffer_(filename, options)
+{}
+
+void RotatingFileStream::open(const std::string& filename, const LogRotationOptions& options)
+{
+  buffer_.open(filename, options);
+  clear();
+}
+
+void RotatingFileStream::close()
+{
+  buffer_.close();
+}
+
+bool RotatingFileStream::is_open() const
+{
+  return buffer_.is_open();
+}
+
+RotatingFileBuffer& RotatingFileStream::buffer()
+{
+  return buffer_;
+}
+
+
+size_t extract_rotated_log(const std::string& filename,
+                           const std::chrono::system_clock::time_point begin,
+                           const std::chrono::system_clock::time_point end,
+                           std::ostream& out)
+{
+  const auto stem = rotated_log_stem(filename);
+  const auto begin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(begin.time_since_epoch()).count();
+  const auto end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()).count();
+  size_t written = 0;
+  std::string compressed;
+  for (const auto number : segment_numbers(stem, ".idx")) {
+    std::ostringstream segment_stem;
+    segment_stem << stem << "." << std::setw(6) << std::setfill('0') << number;
+    std::ifstream index(segment_stem.str() + ".idx");
+    std::string line;
+    std::getline(index, line);
+    const std::string header = rotated_log_index_header;
+    if (line.compare(0, header.size(), header) != 0 || line.size() <= header.size())
+      DUNE_THROW(Exceptions::logger_error, "'" << segment_stem.str() << ".idx' is not a log index!");
+    const auto compression = compression_from_name(line.substr(header.size() + 1));
+    check_compression(compression);
+    std::ifstream data;
+    std::int64_t block_begin, block_end;
+    std::uint64_t offset, size, compressed_offset, compressed_size;
+    while (index >> block_begin >> block_end >> offset >> size >> compressed_offset >> compressed_size) {
+      if (block_end < begin_ns || block_begin > end_ns)
+        continue;
+      if (!data.is_open()) {
+        const auto data_name = segment_stem.str() + compression_extension(compression);
+        data.open(data_name, std::ios_base::binary);
+        if (!data.is_open())
+          DUNE_THROW(Exceptions::external_error, "Could not open '" << data_name << "'!");
+      }
+      compressed.resize(compressed_size);
+      data.seekg(compressed_offset);
+      data.read(&compressed[0], compressed_size);
+      if (data.gcount() != std::streamsize(compressed_size))
+        DUNE_THROW(Exceptions::logger_error, "Truncated log segment '" << segment_stem.str() << "'!");
+      const auto block = decompress_block(compression, compressed, size);
+      out.write(block.data(), block.size());
+      written += block.size();
+    }
+  }
+  return written;
+} // ... extract_rotated_log(...)
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,205 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_COMMON_ROTATING_LOGGING_HH
+#define DUNE_XT_COMMON_ROTATING_LOGGING_HH
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Dune {
+namespace XT {
+namespace Common {
+
+class Configuration;
+
+
+enum class LogCompression
+{
+  none,
+  gzip,
+  zstd
+};
+
+
+struct LogRotationOptions
+{
+  LogRotationOptions(size_t max_size_in = 0,
+                     std::chrono::seconds max_age_in = std::chrono::seconds(0),
+                     size_t max_segments_in = 0,
+                     LogCompression compression_in = LogCompression::none,
+                     size_t block_size_in = 1 << 16);
+
+  /**
+   * \brief reads the keys max_size, max_age (in seconds), max_segments, compression (none, gzip or zstd) and
+   *        block_size, missing keys keep the above defaults:
+\code
+Logger().create(LOG_DEBUG | LOG_FILE, "run", "data", "log", LogRotationOptions(DXTC_CONFIG.sub("logging.rotation")));
+\endcode
+   */
+  explicit LogRotationOptions(const Configuration& config);
+
+  //! whether segments are rotated at all
+  bool enabled() const;
+
+  //! a segment is closed once it holds this many bytes, 0 disables this
+  size_t max_size;
+  //! a segment is closed once it is older than this, checked on each write, 0 disables this
+  std::chrono::seconds max_age;
+  //! only the newest closed segments are kept, 0 keeps all
+  size_t max_segments;
+  LogCompression compression;
+  //! the granularity of the segment index and the compression
+  size_t block_size;
+}; // struct LogRotationOptions
+
+
+/**
+ * \brief A file stream buffer which splits its output into segments of bounded size and age.
+ *
+ *        Output goes to the active segment, i.e. the given file. When closing a segment, it is renamed to
+ *        stem.000042.log (for the file stem.log), compressed on a background thread and indexed: the segment is split
+ *        into blocks of about LogRotationOptions::block_size bytes, which are compressed independently (as gzip members
+ *        or zstd frames, so the files can be read by zcat or zstdcat as well). The index stem.000042.idx lists the
+ *        wall clock time span of each block and its position in the compressed file, see extract_rotated_log().
+ *        Numbering continues after the segments already present, LogRotationOptions::max_segments includes these.
+ *
+ * \note  Segments and blocks are only closed at the end of a line.
+ * \note  Closing the buffer closes the active segment as well and waits for the background thread.
+ */
+class RotatingFileBuffer : public std::streambuf
+{
+public:
+  RotatingFileBuffer();
+
+  RotatingFileBuffer(const std::string& filename, const LogRotationOptions& options);
+
+  ~RotatingFileBuffer();
+
+  void open(const std::string& filename, const LogRotationOptions& options);
+
+  void close();
+
+  bool is_open() const;
+
+  //! closes the active segment (if it is not empty) and starts a new one
+  void rotate();
+
+  //! waits until all closed segments are compressed and indexed
+  void wait();
+
+protected:
+  virtual std::streamsize xsputn(const char_type* s, std::streamsize count);
+  virtual int_type overflow(int_type ch = traits_type::eof());
+  virtual int sync();
+
+private:
+  RotatingFileBuffer(const RotatingFileBuffer&) = delete;
+  RotatingFileBuffer& operator=(const RotatingFileBuffer&) = delete;
+
+  //! a part of a segment, times are nanoseconds since the epoch of the system clock
+  struct Block
+  {
+    std::int64_t begin;
+    std::int64_t end;
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  //! a closed segment waiting for compression
+  struct Segment
+  {
+    size_t number;
+    std::vector<Block> blocks;
+  };
+
+  //! has to be called with mutex_ locked
+  void write_(const char* s, const size_t count);
+
+  //! has to be called with mutex_ locked
+  void rotate_();
+
+  //! has to be called with mutex_ locked
+  void close_block_();
+
+  //! stem.000042 for the segment number 42
+  std::string segment_stem_(const size_t number) const;
+
+  void compress_(const Segment& segment) const;
+
+  //! removes the oldest segments beyond LogRotationOptions::max_segments
+  void remove_old_segments_();
+
+  void work_();
+
+  std::string filename_;
+  std::string stem_;
+  LogRotationOptions options_;
+  mutable std::mutex mutex_;
+  std::ofstream file_;
+  std::chrono::steady_clock::time_point segment_begin_;
+  std::uint64_t segment_size_;
+  Block block_;
+  std::vector<Block> blocks_;
+  size_t next_number_;
+  //! the numbers of all segments which are compressed and indexed, ascending
+  std::deque<size_t> finished_;
+  std::deque<Segment> queue_;
+  bool busy_;
+  bool stop_;
+  std::condition_variable queued_;
+  std::condition_variable done_;
+  std::thread worker_;
+}; // class RotatingFileBuffer
+
+
+//! ostream writing to a RotatingFileBuffer, to be used like an std::ofstream
+class RotatingFileStream : public std::ostream
+{
+public:
+  RotatingFileStream();
+
+  RotatingFileStream(const std::string& filename, const LogRotationOptions& options);
+
+  void open(const std::string& filename, const LogRotationOptions& options);
+
+  void close();
+
+  bool is_open() const;
+
+  RotatingFileBuffer& buffer();
+
+private:
+  RotatingFileBuffer buffer_;
+}; // class RotatingFileStream
+
+
+/**
+ * \brief writes all blocks of the closed segments of the RotatingFileBuffer for filename which overlap the time range
+ *        [begin, end] to out, only these blocks are read and decompressed
+ * \return the number of bytes written
+ */
+size_t extract_rotated_log(const std::string& filename,
+                           const std::chrono::system_clock::time_point begin,
+                           const std::chrono::system_clock::time_point end,
+                           std::ostream& out);
+
+
+} // namespace Common
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_COMMON_ROTATING_LOGGING_HH
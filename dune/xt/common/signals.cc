@@ -13,12 +13,32 @@
 
 #include "signals.hh"
 
+#include <atomic>
+
+#include <dune/xt/common/async_logging.hh>
 #include <dune/xt/common/logging.hh>
 #include <dune/xt/common/string.hh>
 
 namespace Dune {
 namespace XT {
 namespace Common {
+namespace {
+
+
+//! the handlers passed to install_signal_handler
+std::atomic<handler_type*> installed_handlers[NSIG] = {};
+
+//! writes the asynchronous log output before calling the installed handler, which may well terminate the program
+void write_logs_and_handle(int signal)
+{
+  AsyncLogBackend::flush_on_signal();
+  const auto handler = installed_handlers[signal].load();
+  if (handler != nullptr)
+    handler(signal);
+}
+
+
+} // namespace
 
 //! reset given signal to default handler
 void reset_signal(int signal)
@@ -35,6 +55,8 @@ void reset_signal(int signal)
 void handle_interrupt(int signal)
 {
   DXTC_LOG_INFO << "forcefully terminated at " << stringFromTime() << std::endl;
+  // the message is only queued in asynchronous mode
+  AsyncLogBackend::flush_on_signal();
   // reset signal handler and commit suicide
   reset_signal(signal);
   kill(getpid(), signal);
@@ -49,7 +71,12 @@ void install_signal_handler(int signal, handler_type handler)
   struct sigaction new_action;
 
   /* Set up the structure to specify the new action. */
-  new_action.sa_handler = handler;
+  if (handler == SIG_DFL || handler == SIG_IGN) {
+    new_action.sa_handler = handler;
+  } else {
+    installed_handlers[signal] = handler;
+    new_action.sa_handler = write_logs_and_handle;
+  }
   sigemptyset(&new_action.sa_mask);
   new_action.sa_flags = 0;
 
@@ -28,7 +28,9 @@ void handle_interrupt(int signal);
 //! type of handler functions
 typedef void handler_type(int);
 
-//! calling this from your main() will install handler as callback when signal is received
+/** calling this from your main() will install handler as callback when signal is received
+ *  \note the records queued by asynchronous logging are written before handler is called, see
+ *        AsyncLogBackend::flush_on_signal() **/
 void install_signal_handler(int signal = SIGINT, handler_type handler = handle_interrupt);
 
 } // namespace Common
@@ -82,10 +82,30 @@ static inline T from_string(std::string ss, const size_t size = 0, const size_t
   return internal::convert_from_string<T>(ss, size, cols);
 }
 
+#if __cplusplus >= 201703L
+
+//! \brief Reads an object from a string without copying it, see from_string(std::string, ...).
+template <class T>
+static inline T from_string(std::string_view ss, const size_t size = 0, const size_t cols = 0)
+{
+  return internal::convert_from_token<T>(ss, size, cols);
+}
+
+//! \brief Reads an object from a string without copying it, see from_string(std::string, ...).
+template <class T>
+static inline T from_string(const char* ss, const size_t size = 0, const size_t cols = 0)
+{
+  return internal::convert_from_token<T>(ss, size, cols);
+}
+
+#endif // __cplusplus >= 201703L
+
 
 /**
  * \brief Converts an object to string.
  * \sa    internal::convert_to_string for implementations
+ * \param precision Number of significant digits of floating point numbers, as with std::setprecision, or
+ *                  shortest_to_string_precision for the shortest representation which is read back as the same value.
  */
 template <class T>
 static inline std::string to_string(const T& ss, const size_t precision = default_to_string_precision)
@@ -94,6 +114,22 @@ static inline std::string to_string(const T& ss, const size_t precision = defaul
 }
 
 
+/**
+ * \brief  Writes an object to the buffer [first, last), the same characters as to_string(ss, precision) returns.
+ * \note   Numbers and vectors or matrices of numbers are written without allocating memory (if std::to_chars is
+ *         available).
+ * \return pointer one past the last written character
+ * \throws Exceptions::conversion_error if the buffer is too small
+ */
+template <class T>
+static inline char* to_chars(char* first, char* last, const T& ss, const size_t precision = default_to_string_precision)
+{
+  internal::BufferSink sink(first, last);
+  internal::write_to(sink, ss, precision);
+  return sink.position();
+}
+
+
 /**
  * \brief Converts each character of a string to lower case using std::tolower.
  * \note  This might not do what you expect, given your locale.
@@ -14,12 +14,21 @@
 #ifndef DUNE_XT_COMMON_STRING_INTERNAL_HH
 #define DUNE_XT_COMMON_STRING_INTERNAL_HH
 
+#include <cctype>
+#include <cmath>
 #include <cstring>
 #include <algorithm>
 #include <iomanip>
+#include <limits>
+#include <ostream>
 #include <vector>
 #include <string>
 
+#if __cplusplus >= 201703L
+#  include <charconv>
+#  include <string_view>
+#endif
+
 #include <dune/xt/common/disable_warnings.hh>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
@@ -47,8 +56,94 @@ tokenize(const std::string& msg,
          const boost::algorithm::token_compress_mode_type mode = boost::algorithm::token_compress_off);
 #endif // DUNE_XT_COMMON_STRING_HH
 
+/**
+ * \brief Precision for to_string, which yields the shortest representation that is read back as the same value.
+ * \note  Without std::to_chars, max_digits10 significant digits are used, which are read back as the same value, too.
+ */
+static constexpr const std::size_t shortest_to_string_precision = std::numeric_limits<std::size_t>::max();
+
 namespace internal {
 
+
+#if __cplusplus >= 201703L
+
+//! a part of a string, which is parsed without copying it
+typedef std::string_view StringToken;
+
+#else // __cplusplus >= 201703L
+
+//! the parts of std::string_view needed for parsing
+class StringToken
+{
+public:
+  static constexpr size_t npos = std::string::npos;
+
+  StringToken(const char* data, const size_t size)
+    : data_(data)
+    , size_(size)
+  {}
+
+  StringToken(const std::string& str)
+    : data_(str.data())
+    , size_(str.size())
+  {}
+
+  const char* data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  char operator[](const size_t pos) const
+  {
+    return data_[pos];
+  }
+
+  char front() const
+  {
+    return data_[0];
+  }
+
+  char back() const
+  {
+    return data_[size_ - 1];
+  }
+
+  size_t find(const char ch, const size_t pos = 0) const
+  {
+    for (size_t ii = pos; ii < size_; ++ii)
+      if (data_[ii] == ch)
+        return ii;
+    return npos;
+  }
+
+  StringToken substr(const size_t pos, const size_t count = npos) const
+  {
+    return StringToken(data_ + pos, std::min(count, size_ - pos));
+  }
+
+private:
+  const char* data_;
+  size_t size_;
+}; // class StringToken
+
+inline std::ostream& operator<<(std::ostream& out, const StringToken& token)
+{
+  return out.write(token.data(), token.size());
+}
+
+#endif // __cplusplus >= 201703L
+
+
 static inline std::string trim_copy_safely(std::string str_in)
 {
   const std::string str_out = boost::algorithm::trim_copy(str_in);
@@ -61,6 +156,109 @@ static inline std::string trim_copy_safely(std::string str_in)
   return str_out;
 } // ... trim_copy_safely(...)
 
+//! same as trim_copy_safely, without copying
+static inline StringToken trim_safely(StringToken token)
+{
+  size_t first = 0;
+  size_t last = token.size();
+  while (first < last && std::isspace(static_cast<unsigned char>(token[first])))
+    ++first;
+  while (last > first && std::isspace(static_cast<unsigned char>(token[last - 1])))
+    --last;
+  token = token.substr(first, last - first);
+  if (token.find(';') != StringToken::npos)
+    DUNE_THROW(Exceptions::conversion_error,
+               "There was an error while parsing the string below. "
+                   << "The value contained a ';': '" << token << "'!\n"
+                   << "This usually happens if you try to get a matrix expression with a vector type "
+                   << "or if you are missing the white space after the ';' in a matrix expression!\n");
+  return token;
+} // ... trim_safely(...)
+
+/**
+ * \brief Splits token at each run of separators into tokens, without copying.
+ * \note  Same as tokenize(token, separator, token_compress_on), i.e., a leading or trailing separator yields an empty
+ *        token.
+ */
+static inline void split_tokens(const StringToken token, const char separator, std::vector<StringToken>& tokens)
+{
+  tokens.clear();
+  size_t begin = 0;
+  while (true) {
+    const auto end = token.find(separator, begin);
+    if (end == StringToken::npos) {
+      tokens.push_back(token.substr(begin));
+      return;
+    }
+    tokens.push_back(token.substr(begin, end - begin));
+    begin = end + 1;
+    while (begin < token.size() && token[begin] == separator)
+      ++begin;
+  }
+} // ... split_tokens(...)
+
+//! types which are parsed by std::from_chars
+template <class T>
+struct has_from_chars
+{
+#if __cplusplus >= 201703L
+  static constexpr bool value =
+      std::is_same<T, int>::value || std::is_same<T, long>::value || std::is_same<T, long long>::value
+      || std::is_same<T, unsigned int>::value || std::is_same<T, unsigned long>::value
+      || std::is_same<T, unsigned long long>::value
+#  ifdef __cpp_lib_to_chars
+      // long double is left to std::stold, since std::from_chars does not support it everywhere
+      || std::is_same<T, float>::value || std::is_same<T, double>::value
+#  endif
+      ;
+#else
+  static constexpr bool value = false;
+#endif
+}; // struct has_from_chars
+
+/**
+ * \brief Parses [first, last) with std::from_chars, if the result is the same as the one of std::sto*.
+ * \return false if T is not supported or if the string does not only contain a number (surrounded by whitespace),
+ *         the caller then falls back to std::sto* for the same results and error messages as before
+ */
+template <class T>
+static inline typename std::enable_if<has_from_chars<T>::value, bool>::type
+parse_number(const char* first, const char* last, T& value)
+{
+#if __cplusplus >= 201703L
+  while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+    ++first;
+  // unlike std::sto*, std::from_chars does not accept a leading '+'
+  if (first != last && *first == '+') {
+    ++first;
+    if (first == last || *first == '+' || *first == '-')
+      return false;
+  }
+  // std::stoul and friends negate unsigned values
+  if (std::is_unsigned<T>::value && first != last && *first == '-')
+    return false;
+  const auto result = std::from_chars(first, last, value);
+  if (result.ec != std::errc())
+    return false;
+  // std::sto* reject subnormal results as out of range
+  if (std::is_floating_point<T>::value && std::fpclassify(value) == FP_SUBNORMAL)
+    return false;
+  for (auto ptr = result.ptr; ptr != last; ++ptr)
+    if (!std::isspace(static_cast<unsigned char>(*ptr)))
+      return false;
+  return true;
+#else
+  return false;
+#endif
+} // ... parse_number(...)
+
+template <class T>
+static inline typename std::enable_if<!has_from_chars<T>::value, bool>::type
+parse_number(const char* /*first*/, const char* /*last*/, T& /*value*/)
+{
+  return false;
+}
+
 template <class T>
 static inline T convert_safely(std::string ss)
 {
@@ -112,6 +310,9 @@ struct Helper<bool, anything>
   {                                                                                                                    \
     static inline tn convert_from_string(std::string ss)                                                               \
     {                                                                                                                  \
+      tn value;                                                                                                        \
+      if (parse_number(ss.data(), ss.data() + ss.size(), value))                                                       \
+        return value;                                                                                                  \
       try {                                                                                                            \
         return std::sto##tns(ss);                                                                                      \
       } catch (const std::exception& ee) {                                                                             \
@@ -138,6 +339,9 @@ struct Helper<unsigned int, anything>
 {
   static inline unsigned int convert_from_string(std::string ss)
   {
+    unsigned int value;
+    if (parse_number(ss.data(), ss.data() + ss.size(), value))
+      return value;
     try {
       return XT::Common::numeric_cast<unsigned int>(std::stoul(ss));
     } catch (const XT::Common::Exceptions::external_error& ee) {
@@ -184,18 +388,29 @@ convert_from_string(std::string ss, const size_t /*size*/ = 0, const size_t /*co
   return V(re, im);
 }
 
+//! scalar variant without copying the token if possible, vectors and matrices are handled below
+template <class T>
+static inline typename std::enable_if<!is_vector<T>::value && !is_matrix<T>::value, T>::type
+convert_from_token(const StringToken token, const size_t rows = 0, const size_t cols = 0)
+{
+  T value;
+  if (parse_number(token.data(), token.data() + token.size(), value))
+    return value;
+  return convert_from_string<T>(std::string(token.data(), token.size()), rows, cols);
+}
+
 template <class VectorType>
 static inline typename std::enable_if<is_vector<VectorType>::value, VectorType>::type
-convert_from_string(std::string ss, const size_t size, const size_t DXTC_DEBUG_ONLY(cols) = 0)
+convert_from_string(StringToken vector_str, const size_t size, const size_t DXTC_DEBUG_ONLY(cols) = 0)
 {
-  auto vector_str = ss;
   typedef typename VectorAbstraction<VectorType>::S S;
   DXT_ASSERT(cols == 0);
   // check if this is a vector
-  if (vector_str.substr(0, 1) == "[" && vector_str.substr(vector_str.size() - 1, 1) == "]") {
+  if (!vector_str.empty() && vector_str.front() == '[' && vector_str.back() == ']') {
     vector_str = vector_str.substr(1, vector_str.size() - 2);
     // we treat this as a vector and split along ' '
-    const auto tokens = tokenize<std::string>(vector_str, " ", boost::algorithm::token_compress_on);
+    std::vector<StringToken> tokens;
+    split_tokens(vector_str, ' ', tokens);
     if (size > 0 && tokens.size() < size)
       DUNE_THROW(Exceptions::conversion_error,
                  "Vector expression (see below) has only " << tokens.size() << " elements but " << size
@@ -214,11 +429,11 @@ convert_from_string(std::string ss, const size_t size, const size_t DXTC_DEBUG_O
                                                            << "'[" << vector_str << "]'");
     VectorType ret = VectorAbstraction<VectorType>::create(actual_size);
     for (size_t ii = 0; ii < actual_size; ++ii)
-      ret[ii] = convert_from_string<S>(trim_copy_safely(tokens[ii]));
+      ret[ii] = convert_from_token<S>(trim_safely(tokens[ii]));
     return ret;
   } else {
     // we treat this as a scalar
-    const auto val = convert_from_string<S>(trim_copy_safely(vector_str));
+    const auto val = convert_from_token<S>(trim_safely(vector_str));
     const size_t automatic_size = (size == 0 ? 1 : size);
     const size_t actual_size =
         VectorAbstraction<VectorType>::has_static_size ? VectorAbstraction<VectorType>::static_size : automatic_size;
@@ -238,14 +453,15 @@ convert_from_string(std::string ss, const size_t size, const size_t DXTC_DEBUG_O
 
 template <class MatrixType>
 static inline typename std::enable_if<is_matrix<MatrixType>::value, MatrixType>::type
-convert_from_string(std::string matrix_str, const size_t rows, const size_t cols)
+convert_from_string(StringToken matrix_str, const size_t rows, const size_t cols)
 {
   typedef typename MatrixAbstraction<MatrixType>::S S;
   // check if this is a matrix
-  if (matrix_str.substr(0, 1) == "[" && matrix_str.substr(matrix_str.size() - 1, 1) == "]") {
+  if (!matrix_str.empty() && matrix_str.front() == '[' && matrix_str.back() == ']') {
     matrix_str = matrix_str.substr(1, matrix_str.size() - 2);
     // we treat this as a matrix and split along ';' to obtain the rows
-    const auto row_tokens = tokenize<std::string>(matrix_str, ";", boost::algorithm::token_compress_on);
+    std::vector<StringToken> row_tokens;
+    split_tokens(matrix_str, ';', row_tokens);
     if (rows > 0 && row_tokens.size() < rows)
       DUNE_THROW(Exceptions::conversion_error,
                  "Matrix expression (see below) has only " << row_tokens.size() << " rows but " << rows
@@ -262,13 +478,13 @@ convert_from_string(std::string matrix_str, const size_t rows, const size_t cols
                                                            << Typename<MatrixType>::value() << ")!"
                                                            << "\n"
                                                            << "'[" << matrix_str << "]'");
-    // compute the number of columns the matrix will have
+    // we treat each row as a vector, so we split along ' ', and compute the number of columns the matrix will have
+    std::vector<std::vector<StringToken>> column_tokens(actual_rows);
     size_t min_cols = std::numeric_limits<size_t>::max();
     for (size_t rr = 0; rr < actual_rows; ++rr) {
-      const auto row_token = boost::algorithm::trim_copy(row_tokens[rr]);
-      // we treat this as a vector, so we split along ' '
-      const auto column_tokens = tokenize<std::string>(row_token, " ", boost::algorithm::token_compress_on);
-      min_cols = std::min(min_cols, column_tokens.size());
+      // the row contains no ';', so this only trims
+      split_tokens(trim_safely(row_tokens[rr]), ' ', column_tokens[rr]);
+      min_cols = std::min(min_cols, column_tokens[rr].size());
     }
     if (cols > 0 && min_cols < cols)
       DUNE_THROW(Exceptions::conversion_error,
@@ -287,18 +503,14 @@ convert_from_string(std::string matrix_str, const size_t rows, const size_t cols
                                                            << "\n"
                                                            << "'[" << matrix_str << "]'");
     MatrixType ret = MatrixAbstraction<MatrixType>::create(actual_rows, actual_cols);
-    // now we do the same again and build the actual matrix
-    for (size_t rr = 0; rr < actual_rows; ++rr) {
-      const std::string row_token = boost::algorithm::trim_copy(row_tokens[rr]);
-      const auto column_tokens = tokenize<std::string>(row_token, " ", boost::algorithm::token_compress_on);
+    for (size_t rr = 0; rr < actual_rows; ++rr)
       for (size_t cc = 0; cc < actual_cols; ++cc)
         MatrixAbstraction<MatrixType>::set_entry(
-            ret, rr, cc, convert_from_string<S>(trim_copy_safely(column_tokens[cc])));
-    }
+            ret, rr, cc, convert_from_token<S>(trim_safely(column_tokens[rr][cc])));
     return ret;
   } else {
     // we treat this as a scalar
-    const S val = convert_from_string<S>(trim_copy_safely(matrix_str));
+    const S val = convert_from_token<S>(trim_safely(matrix_str));
     const size_t automatic_rows = (rows == 0 ? 1 : rows);
     const size_t actual_rows =
         MatrixAbstraction<MatrixType>::has_static_size ? MatrixAbstraction<MatrixType>::static_rows : automatic_rows;
@@ -327,14 +539,166 @@ convert_from_string(std::string matrix_str, const size_t rows, const size_t cols
   }
 } // ... convert_from_string(...)
 
+//! vector and matrix variant of convert_from_token
+template <class T>
+static inline typename std::enable_if<is_vector<T>::value || is_matrix<T>::value, T>::type
+convert_from_token(const StringToken token, const size_t rows = 0, const size_t cols = 0)
+{
+  return convert_from_string<T>(token, rows, cols);
+}
+
+//! writes to a std::string
+class StringSink
+{
+public:
+  explicit StringSink(std::string& str)
+    : str_(str)
+  {}
+
+  void append(const char* data, const size_t size)
+  {
+    str_.append(data, size);
+  }
+
+  void append(const std::string& str)
+  {
+    str_ += str;
+  }
+
+  void append(const char ch)
+  {
+    str_ += ch;
+  }
+
+private:
+  std::string& str_;
+}; // class StringSink
+
+//! writes to the caller-provided buffer [first, last)
+class BufferSink
+{
+public:
+  BufferSink(char* first, char* last)
+    : position_(first)
+    , last_(last)
+  {}
+
+  void append(const char* data, const size_t size)
+  {
+    if (size > size_t(last_ - position_))
+      DUNE_THROW(Exceptions::conversion_error,
+                 "The buffer is too small to write '" << std::string(data, size) << "', only " << (last_ - position_)
+                                                      << " characters are left!");
+    std::memcpy(position_, data, size);
+    position_ += size;
+  }
+
+  void append(const std::string& str)
+  {
+    append(str.data(), str.size());
+  }
+
+  void append(const char ch)
+  {
+    append(&ch, 1);
+  }
+
+  char* position() const
+  {
+    return position_;
+  }
+
+private:
+  char* position_;
+  char* const last_;
+}; // class BufferSink
+
+//! types which are written by std::to_chars, with the same result as by std::ostream
+template <class T>
+struct has_to_chars
+{
+#if __cplusplus >= 201703L
+  static constexpr bool value =
+      std::is_same<T, int>::value || std::is_same<T, long>::value || std::is_same<T, long long>::value
+      || std::is_same<T, unsigned int>::value || std::is_same<T, unsigned long>::value
+      || std::is_same<T, unsigned long long>::value
+#  ifdef __cpp_lib_to_chars
+      || std::is_same<T, float>::value || std::is_same<T, double>::value
+#  endif
+      ;
+#else
+  static constexpr bool value = false;
+#endif
+}; // struct has_to_chars
+
+//! formats with std::ostream, as all types without std::to_chars
+template <class T>
+static inline std::string stream_to_string(const T& ss, const std::size_t precision)
+{
+  std::ostringstream out;
+  // max_digits10 is 0 for anything but floating point types, where it suffices to recover the value
+  if (precision == shortest_to_string_precision)
+    out << std::setprecision(std::numeric_limits<T>::max_digits10) << ss;
+  else
+    out << std::setprecision(boost::numeric_cast<int>(precision)) << ss;
+  return out.str();
+} // ... stream_to_string(...)
+
+#if __cplusplus >= 201703L
+
+template <class T>
+static inline std::to_chars_result
+format_number(char* first, char* last, const T& value, const std::size_t /*precision*/, std::true_type /*integral*/)
+{
+  return std::to_chars(first, last, value);
+}
+
+template <class T>
+static inline std::to_chars_result
+format_number(char* first, char* last, const T& value, const std::size_t precision, std::false_type /*integral*/)
+{
+  if (precision == shortest_to_string_precision)
+    return std::to_chars(first, last, value);
+  // the same as printf("%.*g", precision, value), which is what std::ostream does
+  return std::to_chars(first, last, value, std::chars_format::general, boost::numeric_cast<int>(precision));
+}
+
+//! numbers are formatted on the stack
+template <class Sink, class T>
+static inline void write_number(Sink& sink, const T& value, const std::size_t precision, std::true_type /*to_chars*/)
+{
+  // enough for any number but those with more than 50 significant digits
+  char buffer[64];
+  const auto result = format_number(buffer, buffer + sizeof(buffer), value, precision, std::is_integral<T>());
+  if (result.ec == std::errc())
+    sink.append(buffer, size_t(result.ptr - buffer));
+  else
+    sink.append(stream_to_string(value, precision));
+} // ... write_number(...)
+
+#endif // __cplusplus >= 201703L
+
+template <class T>
+static inline std::string convert_number_to_string(const T& ss, const std::size_t precision, std::false_type)
+{
+  return stream_to_string(ss, precision);
+}
+
+template <class T>
+static inline std::string convert_number_to_string(const T& ss, const std::size_t precision, std::true_type)
+{
+  std::string ret;
+  StringSink sink(ret);
+  write_number(sink, ss, precision, std::true_type());
+  return ret;
+}
+
 // variant for everything that is not a matrix, a vector or any of the types specified below
 template <class T>
 static inline typename std::enable_if<!is_vector<T>::value && !is_matrix<T>::value, std::string>::type
 convert_to_string(const T& ss, const std::size_t precision)
 {
-  std::ostringstream out;
-  out << std::setprecision(boost::numeric_cast<int>(precision)) << ss;
-  return out.str();
+  return convert_number_to_string(ss, precision, std::integral_constant<bool, has_to_chars<T>::value>());
 }
 
 template <typename T>
@@ -373,42 +737,73 @@ inline std::string convert_to_string(const std::string ss, const std::size_t /*p
   return std::string(ss);
 }
 
-// forward such that vectors of matrices can be converted
-template <class M>
-static inline typename std::enable_if<is_matrix<M>::value, std::string>::type
-convert_to_string(const M& /*mat*/, const std::size_t /*precision*/);
+template <class Sink, class T>
+static inline void write_number(Sink& sink, const T& value, const std::size_t precision, std::false_type /*to_chars*/)
+{
+  sink.append(convert_to_string(value, precision));
+}
 
-template <class V>
-static inline typename std::enable_if<is_vector<V>::value, std::string>::type
-convert_to_string(const V& vec, const std::size_t precision)
+template <class Sink, class T>
+static inline typename std::enable_if<!is_vector<T>::value && !is_matrix<T>::value>::type
+write_to(Sink& sink, const T& value, const std::size_t precision)
+{
+  write_number(sink, value, precision, std::integral_constant<bool, has_to_chars<T>::value>());
+}
+
+// forward such that vectors of matrices can be written
+template <class Sink, class M>
+static inline typename std::enable_if<is_matrix<M>::value>::type
+write_to(Sink& sink, const M& mat, const std::size_t precision);
+
+template <class Sink, class V>
+static inline typename std::enable_if<is_vector<V>::value>::type
+write_to(Sink& sink, const V& vec, const std::size_t precision)
 {
-  std::string ret = "[";
+  sink.append('[');
   for (auto ii : value_range(vec.size())) {
     if (ii > 0)
-      ret += " ";
-    ret += convert_to_string(vec[ii], precision);
+      sink.append(' ');
+    write_to(sink, vec[ii], precision);
   }
-  ret += "]";
-  return ret;
-} // ... convert_to_string(...)
+  sink.append(']');
+} // ... write_to(...)
 
-template <class M>
-static inline typename std::enable_if<is_matrix<M>::value, std::string>::type
-convert_to_string(const M& mat, const std::size_t precision)
+template <class Sink, class M>
+static inline typename std::enable_if<is_matrix<M>::value>::type
+write_to(Sink& sink, const M& mat, const std::size_t precision)
 {
-  std::string ret = "[";
+  sink.append('[');
   for (auto rr : value_range(MatrixAbstraction<M>::rows(mat))) {
     if (rr > 0)
-      ret += "; ";
+      sink.append("; ", 2);
     for (auto cc : value_range(MatrixAbstraction<M>::cols(mat))) {
       if (cc > 0)
-        ret += " ";
-      ret += convert_to_string(MatrixAbstraction<M>::get_entry(mat, rr, cc), precision);
+        sink.append(' ');
+      write_to(sink, MatrixAbstraction<M>::get_entry(mat, rr, cc), precision);
     }
   }
-  ret += "]";
+  sink.append(']');
+} // ... write_to(...)
+
+template <class V>
+static inline typename std::enable_if<is_vector<V>::value, std::string>::type
+convert_to_string(const V& vec, const std::size_t precision)
+{
+  std::string ret;
+  StringSink sink(ret);
+  write_to(sink, vec, precision);
+  return ret;
+}
+
+template <class M>
+static inline typename std::enable_if<is_matrix<M>::value, std::string>::type
+convert_to_string(const M& mat, const std::size_t precision)
+{
+  std::string ret;
+  StringSink sink(ret);
+  write_to(sink, mat, precision);
   return ret;
-} // ... convert_to_string(...)
+}
 
 
 } // namespace internal
@@ -0,0 +1,203 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/aggregated_logging.hh>
+#include <dune/xt/common/logging.hh>
+
+using namespace Dune::XT::Common;
+
+typedef std::vector<std::pair<int, std::string>> Lines;
+
+static int rank()
+{
+  return Dune::MPIHelper::getCollectiveCommunication().rank();
+}
+
+static int size()
+{
+  return Dune::MPIHelper::getCollectiveCommunication().size();
+}
+
+//! what the aggregating rank writes for a line of the given ranks
+static std::string expected(const std::string& ranks, const std::string& line)
+{
+  return ((size() > 1) ? "[" + ranks + "] " : std::string()) + line + "\n";
+}
+
+static std::string all_ranks()
+{
+  return (size() > 1) ? "ranks 0-" + std::to_string(size() - 1) : "rank 0";
+}
+
+static LogAggregator::WriterType collect(Lines& lines)
+{
+  return [&lines](const int flags, const std::string& text) { lines.emplace_back(flags, text); };
+}
+
+GTEST_TEST(LogAggregator, Collate)
+{
+  Lines lines;
+  LogAggregator aggregator(collect(lines));
+  EXPECT_EQ(aggregator.aggregating(), rank() == 0);
+  aggregator.push(LOG_INFO, "on all ranks\nrank " + std::to_string(rank()) + "\n");
+  aggregator.push(LOG_ERROR, "on all ranks\n");
+  aggregator.push(LOG_INFO, "on all ranks\n");
+  aggregator.finish();
+  if (rank() != 0) {
+    EXPECT_TRUE(lines.empty());
+    return;
+  }
+  Lines expected_lines = {{LOG_INFO, expected(all_ranks(), "on all ranks")},
+                          {LOG_INFO, expected("rank 0", "rank 0")},
+                          {LOG_ERROR, expected(all_ranks(), "on all ranks")},
+                          {LOG_INFO, expected(all_ranks(), "on all ranks")}};
+  for (int ii = 1; ii < size(); ++ii)
+    expected_lines.emplace_back(LOG_INFO, expected("rank " + std::to_string(ii), "rank " + std::to_string(ii)));
+  EXPECT_EQ(lines, expected_lines);
+}
+
+GTEST_TEST(LogAggregator, NonBlocking)
+{
+  Lines lines;
+  LogAggregator aggregator(collect(lines), LogAggregatorOptions(false, 2));
+  const size_t rounds = 10;
+  for (size_t ii = 0; ii < rounds; ++ii) {
+    aggregator.push(LOG_INFO, "step " + std::to_string(ii));
+    // only ranks with odd numbers take part in even steps
+    if (ii % 2 == 0 && rank() % 2 == 1)
+      aggregator.push(LOG_DEBUG, "odd " + std::to_string(ii));
+    aggregator.collate();
+  }
+  aggregator.finish();
+  if (rank() != 0)
+    return;
+  std::string odd_ranks;
+  for (int ii = 1; ii < size(); ii += 2)
+    odd_ranks += ((ii > 1) ? "," : "") + std::to_string(ii);
+  Lines expected_lines;
+  for (size_t ii = 0; ii < rounds; ++ii) {
+    expected_lines.emplace_back(LOG_INFO, expected(all_ranks(), "step " + std::to_string(ii)));
+    if (ii % 2 == 0 && size() > 1)
+      expected_lines.emplace_back(
+          LOG_DEBUG, expected(((size() / 2 > 1) ? "ranks " : "rank ") + odd_ranks, "odd " + std::to_string(ii)));
+  }
+  // within a round the lines are ordered by rank, so only the order of the steps is fixed
+  std::multiset<std::pair<int, std::string>> written(lines.begin(), lines.end());
+  std::multiset<std::pair<int, std::string>> expected_set(expected_lines.begin(), expected_lines.end());
+  EXPECT_EQ(written, expected_set);
+  std::vector<std::string> steps;
+  for (const auto& line : lines)
+    if (line.first == LOG_INFO)
+      steps.push_back(line.second);
+  ASSERT_EQ(steps.size(), rounds);
+  for (size_t ii = 0; ii < rounds; ++ii)
+    EXPECT_EQ(steps[ii], expected(all_ranks(), "step " + std::to_string(ii)));
+}
+
+GTEST_TEST(LogAggregator, RateLimit)
+{
+  Lines lines;
+  LogAggregator aggregator(collect(lines), LogAggregatorOptions(false, 1, 3, std::chrono::hours(1)));
+  for (size_t ii = 0; ii < 10; ++ii)
+    aggregator.push(LOG_ERROR, "repeated\n");
+  aggregator.push(LOG_INFO, "repeated\n");
+  EXPECT_EQ(aggregator.suppressed(), 7u);
+  aggregator.collate();
+  aggregator.push(LOG_ERROR, "repeated\n");
+  aggregator.finish();
+  EXPECT_EQ(aggregator.suppressed(), 8u);
+  if (rank() != 0)
+    return;
+  const Lines expected_lines = {{LOG_ERROR, expected(all_ranks(), "repeated")},
+                                {LOG_ERROR, expected(all_ranks(), "repeated")},
+                                {LOG_ERROR, expected(all_ranks(), "repeated")},
+                                {LOG_INFO, expected(all_ranks(), "repeated")},
+                                {LOG_ERROR, expected(all_ranks(), "repeated [suppressed 7 repetitions]")},
+                                {LOG_ERROR, expected(all_ranks(), "repeated [suppressed 1 repetition]")}};
+  EXPECT_EQ(lines, expected_lines);
+}
+
+GTEST_TEST(LogAggregator, PendingRound)
+{
+  Lines lines;
+  {
+    LogAggregator aggregator(collect(lines));
+    aggregator.push(LOG_INFO, "rank " + std::to_string(rank()) + "\n");
+    // starts a round which is usually still in flight on destruction
+    aggregator.collate();
+    aggregator.push(LOG_INFO, "not collated on rank " + std::to_string(rank()) + "\n");
+  }
+  // no line is lost, the lines of the round are written by the aggregating rank or by their own rank
+  const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+  const auto written = [&](const std::string& line) {
+    return int(std::count(lines.begin(), lines.end(), std::make_pair(int(LOG_INFO), line)));
+  };
+  for (int ii = 0; ii < size(); ++ii) {
+    const auto other = "rank " + std::to_string(ii);
+    EXPECT_GE(comm.sum(written(expected(other, other))), 1);
+  }
+  const auto own = "rank " + std::to_string(rank());
+  EXPECT_EQ(written(expected(own, "not collated on " + own)), 1);
+}
+
+GTEST_TEST(LogAggregator, PerNode)
+{
+  Lines lines;
+  LogAggregator aggregator(collect(lines), LogAggregatorOptions(true));
+  aggregator.push(LOG_INFO, "on all ranks\n");
+  aggregator.finish();
+  // each aggregating rank writes the line once for the ranks of its node
+  int written = 0;
+  for (const auto& line : lines)
+    written += (line.second.find("on all ranks") != std::string::npos);
+  EXPECT_EQ(written, aggregator.aggregating() ? 1 : 0);
+  EXPECT_EQ(Dune::MPIHelper::getCollectiveCommunication().sum(int(aggregator.aggregating())),
+            Dune::MPIHelper::getCollectiveCommunication().sum(written));
+  if (rank() == 0) {
+    ASSERT_FALSE(lines.empty());
+    EXPECT_EQ(lines[0].second.find(size() > 1 ? "[rank" : "on all ranks"), 0u);
+  }
+}
+
+GTEST_TEST(LogAggregator, Logging)
+{
+  Logger().create(LOG_INFO | LOG_ERROR | LOG_FILE | LOG_AGGREGATE, "test_common_aggregated_logging", "", "");
+  Logger().info() << "from all ranks" << std::endl;
+  Logger().error() << "rank " << rank() << std::endl;
+  Logger().debug() << "not enabled" << std::endl;
+  Logger().collate(true);
+  if (rank() == 0) {
+    std::ifstream log("test_common_aggregated_logging.log");
+    ASSERT_TRUE(log.is_open());
+    std::stringstream content;
+    content << log.rdbuf();
+    EXPECT_NE(content.str().find(expected(all_ranks(), "from all ranks")), std::string::npos);
+    for (int ii = 0; ii < size(); ++ii)
+      EXPECT_NE(content.str().find(expected("rank " + std::to_string(ii), "rank " + std::to_string(ii))),
+                std::string::npos);
+    EXPECT_EQ(content.str().find("not enabled"), std::string::npos);
+  } else {
+    std::ostringstream filename;
+    filename << "test_common_aggregated_logging_p" << std::setw(8) << std::setfill('0') << rank() << "_.log";
+    EXPECT_FALSE(std::ifstream(filename.str()).is_open());
+  }
+  Logger().create(LOG_CONSOLE | LOG_ERROR);
+}
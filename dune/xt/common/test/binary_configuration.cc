@@ -0,0 +1,114 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/binary_configuration.hh>
+#include <dune/xt/common/configuration.hh>
+#include <dune/xt/common/exceptions.hh>
+
+using namespace Dune::XT::Common;
+
+static Configuration example_configuration()
+{
+  return Configuration({{"b.int", "-17"},
+                        {"a", "true"},
+                        {"b.double", "0.1"},
+                        {"b.vector", "[1 2 3]"},
+                        {"c.d.string", "foo bar"},
+                        {"b.large", "12345678901"}});
+}
+
+static bool equal(const BinaryConfiguration& left, const BinaryConfiguration& right)
+{
+  return left.bytes() == right.bytes() && std::memcmp(left.data(), right.data(), left.bytes()) == 0;
+}
+
+GTEST_TEST(BinaryConfiguration, Lookup)
+{
+  const auto config = example_configuration();
+  const BinaryConfiguration binary(config);
+  EXPECT_EQ(binary.size(), 6u);
+  EXPECT_EQ(std::string(binary.key(0)), "a");
+  EXPECT_EQ(std::string(binary.key(5)), "c.d.string");
+  EXPECT_EQ(std::string(binary.value(5)), "foo bar");
+  EXPECT_THROW(binary.key(6), Exceptions::index_out_of_range);
+  EXPECT_TRUE(binary.has_key("b.int"));
+  EXPECT_FALSE(binary.has_key("b"));
+  EXPECT_FALSE(binary.has_key("b.int2"));
+  for (const auto& key : {"a", "b.int", "b.double", "b.vector", "c.d.string", "b.large"})
+    EXPECT_EQ(binary.get<std::string>(key), config.get<std::string>(key)) << key;
+  EXPECT_EQ(binary.get<int>("b.int"), -17);
+  EXPECT_EQ(binary.get<double>("b.int"), -17.);
+  EXPECT_EQ(binary.get<double>("b.double"), config.get<double>("b.double"));
+  EXPECT_EQ(binary.get<float>("b.double"), config.get<float>("b.double"));
+  EXPECT_TRUE(binary.get<bool>("a"));
+  EXPECT_EQ(binary.get<long long>("b.large"), 12345678901);
+  EXPECT_THROW(binary.get<int>("b.large"), Exceptions::conversion_error);
+  EXPECT_EQ(binary.get<std::vector<double>>("b.vector"), std::vector<double>({1., 2., 3.}));
+  EXPECT_EQ(binary.get<std::vector<double>>("b.vector", 2), std::vector<double>({1., 2.}));
+  EXPECT_THROW(binary.get<int>("b.missing"), Exceptions::configuration_error);
+  EXPECT_EQ(binary.get("b.missing", 3), 3);
+  EXPECT_EQ(binary.get("b.int", 3), -17);
+  EXPECT_EQ(binary.get("b.missing", "default"), "default");
+  EXPECT_EQ(binary.configuration(), config);
+  EXPECT_TRUE(BinaryConfiguration().empty());
+  EXPECT_TRUE(BinaryConfiguration().configuration().empty());
+}
+
+GTEST_TEST(BinaryConfiguration, File)
+{
+  const BinaryConfiguration binary(example_configuration());
+  const std::string filename =
+      "binary_configuration_rank_" + std::to_string(Dune::MPIHelper::getCollectiveCommunication().rank()) + ".bin";
+  binary.write(filename);
+  const auto mapped = BinaryConfiguration::read(filename);
+  EXPECT_TRUE(equal(mapped, binary));
+  EXPECT_EQ(mapped.get<int>("b.int"), -17);
+  // the mapping is shared by copies
+  std::unique_ptr<BinaryConfiguration> original(new BinaryConfiguration(BinaryConfiguration::read(filename)));
+  const auto copy = *original;
+  original.reset();
+  EXPECT_EQ(copy.get<std::string>("c.d.string"), "foo bar");
+  EXPECT_THROW(BinaryConfiguration::read("does_not_exist.bin"), Exceptions::external_error);
+  // truncated and corrupt data
+  for (size_t bytes : {size_t(0), size_t(10), binary.bytes() - 1}) {
+    std::ofstream(filename, std::ios_base::binary).write(binary.data(), bytes);
+    EXPECT_THROW(BinaryConfiguration::read(filename), Exceptions::configuration_error) << bytes;
+  }
+  std::unique_ptr<char[]> data(new char[binary.bytes()]);
+  std::memcpy(data.get(), binary.data(), binary.bytes());
+  data[0] = 'X';
+  EXPECT_THROW(BinaryConfiguration(std::move(data), binary.bytes()), Exceptions::configuration_error);
+  data.reset(new char[binary.bytes()]);
+  std::memcpy(data.get(), binary.data(), binary.bytes());
+  data[binary.bytes() - 1] = 'X';
+  EXPECT_THROW(BinaryConfiguration(std::move(data), binary.bytes()), Exceptions::configuration_error);
+}
+
+GTEST_TEST(BinaryConfiguration, Broadcast)
+{
+  const auto comm = Dune::MPIHelper::getCollectiveCommunication();
+  const BinaryConfiguration expected(example_configuration());
+  const auto broadcast = BinaryConfiguration::broadcast(comm.rank() == 0 ? expected : BinaryConfiguration());
+  EXPECT_TRUE(equal(broadcast, expected));
+  const std::string filename = "binary_configuration_" + std::to_string(comm.size()) + ".bin";
+  if (comm.rank() == 0)
+    expected.write(filename);
+  comm.barrier();
+  EXPECT_TRUE(equal(BinaryConfiguration::broadcast(filename), expected));
+  // all ranks fail if root does
+  EXPECT_THROW(BinaryConfiguration::broadcast(std::string("does_not_exist.bin")), Dune::Exception);
+}
@@ -0,0 +1,171 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/binary_logging.hh>
+#include <dune/xt/common/exceptions.hh>
+
+using namespace Dune::XT::Common;
+
+struct Point
+{
+  double x;
+  double y;
+};
+
+std::ostream& operator<<(std::ostream& out, const Point& point)
+{
+  return out << "(" << point.x << ", " << point.y << ")";
+}
+
+static std::string filename(const std::string& name)
+{
+  return "test_common_binary_log_" + name + "_p" + std::to_string(Dune::MPIHelper::getCollectiveCommunication().rank())
+         + ".bin";
+}
+
+static std::vector<BinaryLogRecord> read_all(const std::string& file)
+{
+  BinaryLogReader reader(file);
+  std::vector<BinaryLogRecord> records;
+  BinaryLogRecord record;
+  while (reader.next(record))
+    records.push_back(record);
+  return records;
+}
+
+GTEST_TEST(BinaryLogging, Roundtrip)
+{
+  const auto file = filename("roundtrip");
+  {
+    BinaryLogSink sink(file, 3);
+    int flags = LOG_INFO | LOG_ERROR;
+    BinaryLogStream info(LOG_INFO, flags, sink);
+    BinaryLogStream error(LOG_ERROR, flags, sink);
+    BinaryLogStream debug(LOG_DEBUG, flags, sink);
+    for (int ii = 0; ii < 2; ++ii)
+      info.log(DXTC_BINARY_LOG_FORMAT("step {}: residual {} ({})"), ii, 0.5 / (ii + 1), "converging");
+    error.log(DXTC_BINARY_LOG_FORMAT("{}{} {} {}"), 'x', size_t(42), true, Point{1, 2.5});
+    debug.log(DXTC_BINARY_LOG_FORMAT("not in output {}"), 1);
+    info.log(DXTC_BINARY_LOG_FORMAT("missing {} {}"), -7);
+    info.log(DXTC_BINARY_LOG_FORMAT("surplus"), 1, std::string("two"));
+    info << "text " << 1.5 << std::endl;
+    info.suspend();
+    info.log(DXTC_BINARY_LOG_FORMAT("not in output {}"), 2);
+    info.resume();
+  }
+  BinaryLogReader reader(file);
+  EXPECT_EQ(reader.rank(), 3);
+  const auto records = read_all(file);
+  ASSERT_EQ(records.size(), 6u);
+  const std::vector<std::string> expected = {"step 0: residual 0.5 (converging)",
+                                             "step 1: residual 0.25 (converging)",
+                                             "x42 1 (1, 2.5)",
+                                             "missing -7 {}",
+                                             "surplus 1 two",
+                                             "text 1.5\n"};
+  for (size_t ii = 0; ii < records.size(); ++ii) {
+    EXPECT_EQ(records[ii].text, expected[ii]);
+    EXPECT_EQ(records[ii].rank, 3);
+    EXPECT_EQ(records[ii].thread, records[0].thread);
+  }
+  for (size_t ii = 1; ii < records.size(); ++ii)
+    EXPECT_GE(records[ii].time, records[ii - 1].time);
+  EXPECT_EQ(records[0].level, LOG_INFO);
+  EXPECT_EQ(records[2].level, LOG_ERROR);
+}
+
+GTEST_TEST(BinaryLogging, Threads)
+{
+  const auto file = filename("threads");
+  const size_t num_threads = 4;
+  const size_t num_lines = 1000;
+  {
+    BinaryLogSink sink(file);
+    int flags = LOG_INFO;
+    BinaryLogStream info(LOG_INFO, flags, sink);
+    std::vector<std::thread> threads;
+    for (size_t tt = 0; tt < num_threads; ++tt)
+      threads.emplace_back([&, tt]() {
+        for (size_t ii = 0; ii < num_lines; ++ii)
+          info.log(DXTC_BINARY_LOG_FORMAT("thread {} line {}"), tt, ii);
+      });
+    for (auto&& thread : threads)
+      thread.join();
+  }
+  // each thread has its own number, its records keep their order
+  std::map<std::uint32_t, std::vector<std::string>> lines;
+  for (const auto& record : read_all(file))
+    lines[record.thread].push_back(record.text);
+  ASSERT_EQ(lines.size(), num_threads);
+  std::set<std::string> first_lines;
+  for (const auto& thread_lines : lines) {
+    ASSERT_EQ(thread_lines.second.size(), num_lines);
+    const auto prefix = thread_lines.second[0].substr(0, thread_lines.second[0].find(" line"));
+    first_lines.insert(prefix);
+    for (size_t ii = 0; ii < num_lines; ++ii)
+      EXPECT_EQ(thread_lines.second[ii], prefix + " line " + std::to_string(ii));
+  }
+  EXPECT_EQ(first_lines.size(), num_threads);
+}
+
+GTEST_TEST(BinaryLogging, Errors)
+{
+  EXPECT_THROW(BinaryLogReader("does_not_exist.bin"), Exceptions::external_error);
+  const auto file = filename("errors");
+  std::ofstream(file) << "not a binary log file";
+  EXPECT_THROW(BinaryLogReader reader(file), Exceptions::logger_error);
+  {
+    BinaryLogSink sink(file);
+    int flags = LOG_INFO;
+    BinaryLogStream info(LOG_INFO, flags, sink);
+    info.log(DXTC_BINARY_LOG_FORMAT("complete {}"), 1);
+    info.log(DXTC_BINARY_LOG_FORMAT("truncated {}"), 2);
+  }
+  // as if the writing process crashed
+  std::ifstream in(file, std::ios_base::binary);
+  const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::ofstream(file, std::ios_base::binary).write(data.data(), data.size() - 3);
+  const auto records = read_all(file);
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_EQ(records[0].text, "complete 1");
+}
+
+/** compares writing numbers as text and as binary records to a file
+ *  \note disabled by default, run with --gtest_also_run_disabled_tests --gtest_filter='*Benchmark' **/
+GTEST_TEST(BinaryLogging, DISABLED_Benchmark)
+{
+  const size_t num_lines = 100000;
+  int flags = LOG_INFO;
+  const auto measure = [&](const std::string& name, const std::function<void(size_t)>& write) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < num_lines; ++ii)
+      write(ii);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    std::cout << name << ": " << elapsed.count() / num_lines << " ns per line" << std::endl;
+  };
+  std::ofstream text_file(filename("benchmark") + ".txt");
+  OstreamLogStream text(LOG_INFO, flags, text_file);
+  measure("OstreamLogStream", [&](size_t ii) { text << "step " << ii << ": residual " << 1. / (ii + 1) << std::endl; });
+  BinaryLogSink sink(filename("benchmark"));
+  BinaryLogStream binary(LOG_INFO, flags, sink);
+  measure("BinaryLogStream",
+          [&](size_t ii) { binary.log(DXTC_BINARY_LOG_FORMAT("step {}: residual {}"), ii, 1. / (ii + 1)); });
+}
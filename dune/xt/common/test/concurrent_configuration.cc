@@ -0,0 +1,74 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/xt/common/concurrent_configuration.hh>
+
+using namespace Dune::XT::Common;
+
+GTEST_TEST(ConcurrentConfiguration, Basics)
+{
+  ConcurrentConfiguration config(Configuration({"int", "vector"}, {"1", "[1 2]"}));
+  EXPECT_EQ(config.get<int>("int"), 1);
+  EXPECT_EQ(config.get("missing", 2.), 2.);
+  EXPECT_EQ(config.get<std::vector<int>>("vector", 1), std::vector<int>({1}));
+  EXPECT_TRUE(config.has_key("vector"));
+  EXPECT_THROW(config.get<int>("missing"), Exceptions::configuration_error);
+  // snapshots are not affected by later modifications
+  const auto pinned = config.snapshot();
+  config.set("int", 3, true);
+  config.set("missing", 4.);
+  config.add(Configuration({"sub.key"}, {"5"}));
+  EXPECT_EQ(config.get<int>("int"), 3);
+  EXPECT_EQ(config.get("missing", 2.), 4.);
+  EXPECT_EQ(config.get<int>("sub.key"), 5);
+  EXPECT_EQ(pinned->get<int>("int"), 1);
+  EXPECT_FALSE(pinned->has_key("missing"));
+  EXPECT_THROW(config.set("int", 1), Exceptions::configuration_error);
+  config.publish(Configuration({"other"}, {"6"}));
+  EXPECT_FALSE(config.has_key("int"));
+  EXPECT_EQ(config.read([](const Configuration& state) { return state.get<int>("other"); }), 6);
+}
+
+GTEST_TEST(ConcurrentConfiguration, ConcurrentReadersAndWriters)
+{
+  ConcurrentConfiguration config(Configuration({"first", "second"}, {"0", "0"}));
+  std::atomic<bool> done(false);
+  std::atomic<size_t> inconsistent(0);
+  std::vector<std::thread> readers;
+  for (size_t tt = 0; tt < 4; ++tt)
+    readers.emplace_back([&]() {
+      while (!done) {
+        // both keys are always modified together
+        const auto snapshot = config.snapshot();
+        if (snapshot->get<size_t>("first") != snapshot->get<size_t>("second"))
+          ++inconsistent;
+        const auto value = config.get<size_t>("first");
+        if (config.get<size_t>("first") < value)
+          ++inconsistent;
+      }
+    });
+  std::thread writer([&]() {
+    for (size_t ii = 1; ii <= 1000; ++ii)
+      config.modify([&](Configuration& state) {
+        state.set("first", ii, true);
+        state.set("second", ii, true);
+      });
+  });
+  writer.join();
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+  EXPECT_EQ(inconsistent, 0u);
+  EXPECT_EQ(config.get<size_t>("second"), 1000u);
+}
@@ -13,7 +13,10 @@
 #include <dune/xt/common/test/main.hxx>
 
 #include <array>
+#include <atomic>
 #include <ostream>
+#include <thread>
+#include <vector>
 
 #include <boost/assign/list_of.hpp>
 #include <boost/array.hpp>
@@ -479,3 +482,73 @@ TYPED_TEST(ConfigurationTest, behaves_correctly)
 {
   this->behaves_correctly();
 }
+
+GTEST_TEST(Configuration, TypedCache)
+{
+  Configuration config({"int", "vector"}, {"1", "[1 2 3]"});
+  EXPECT_EQ(config.get<int>("int"), 1);
+  EXPECT_EQ(config.get<double>("int"), 1.);
+  EXPECT_EQ(config.get<std::string>("int"), "1");
+  EXPECT_EQ(config.get<std::vector<int>>("vector"), std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(config.get<std::vector<int>>("vector", 2), std::vector<int>({1, 2}));
+  // the cache is invalidated by all modifications
+  config.set("int", 2, true);
+  EXPECT_EQ(config.get<int>("int"), 2);
+  config["int"] = "3";
+  EXPECT_EQ(config.get<int>("int"), 3);
+  config.add(Configuration({"int"}, {"4"}), "", true);
+  EXPECT_EQ(config.get<int>("int"), 4);
+  config = Configuration({"int"}, {"5"});
+  EXPECT_EQ(config.get<int>("int"), 5);
+  // modifications bypassing the invalidation are noticed as well
+  auto& value = config["int"];
+  EXPECT_EQ(config.get<int>("int"), 5);
+  value = "6";
+  EXPECT_EQ(config.get<int>("int"), 6);
+  static_cast<Dune::ParameterTree&>(config)["int"] = "7";
+  EXPECT_EQ(config.get<int>("int"), 7);
+  // defaults are converted as before, per default value
+  EXPECT_EQ(config.get("missing", 0.123456789), 0.123457);
+  EXPECT_EQ(config.get("missing", 1.5), 1.5);
+  EXPECT_EQ(config.get("missing", 0.123456789), 0.123457);
+  config.set("missing", 7);
+  EXPECT_EQ(config.get("missing", 1.5), 7.);
+  // validation and errors are not affected
+  EXPECT_THROW(config.get("int", 0, ValidateNone<int>()), Exceptions::configuration_error);
+  EXPECT_THROW(config.get<int>("really_missing"), Exceptions::configuration_error);
+  config["string"] = "no_number";
+  EXPECT_THROW(config.get<int>("string"), Exceptions::external_error);
+  EXPECT_THROW(config.get<int>("string"), Exceptions::external_error);
+}
+
+GTEST_TEST(Configuration, ConfigHandle)
+{
+  Configuration config({"tolerance"}, {"1e-10"});
+  const ConfigHandle<double> tolerance(config, "tolerance");
+  const ConfigHandle<double> missing(config, "missing", 2.);
+  const ConfigHandle<std::string> name(config, "name", "default");
+  EXPECT_EQ(tolerance.get(), 1e-10);
+  EXPECT_EQ(*missing, 2.);
+  EXPECT_EQ(name.get(), "default");
+  EXPECT_EQ(tolerance.key(), "tolerance");
+  config.set("tolerance", 1e-8, true);
+  config.set("missing", 3.);
+  EXPECT_EQ(tolerance.get(), 1e-8);
+  EXPECT_EQ(missing.get(), 3.);
+  const ConfigHandle<double> copy(missing);
+  EXPECT_EQ(copy.get(), 3.);
+  EXPECT_THROW(ConfigHandle<int>(config, "name"), Exceptions::configuration_error);
+  // concurrent readers
+  std::atomic<size_t> failures(0);
+  std::vector<std::thread> threads;
+  for (size_t tt = 0; tt < 4; ++tt)
+    threads.emplace_back([&]() {
+      for (size_t ii = 0; ii < 10000; ++ii) {
+        if (tolerance.get() != 1e-8 || config.get("tolerance", 1.) != 1e-8 || config.get("missing", 1.) != 3.)
+          ++failures;
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(failures, 0u);
+}
@@ -11,8 +11,22 @@
 
 #include <dune/xt/common/test/main.hxx>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/xt/common/async_logging.hh>
 #include <dune/xt/common/logging.hh>
 #include <dune/xt/common/logstreams.hh>
+#include <dune/xt/common/signals.hh>
 
 void balh(std::ostream& out)
 {
@@ -70,3 +84,156 @@ GTEST_TEST(LoggerTest, file)
   Logger().create(LOG_INFO | LOG_CONSOLE | LOG_FILE, "test_common_logger", "", "");
   Logger().info() << "This output should be in 'test_common_logger.log'" << std::endl;
 }
+
+//! writes lines from several threads to out, each line identifies its thread and number
+void write_lines(std::ostream& out, const size_t num_threads, const size_t num_lines)
+{
+  std::vector<std::thread> threads;
+  for (size_t tt = 0; tt < num_threads; ++tt)
+    threads.emplace_back([&, tt]() {
+      for (size_t ii = 0; ii < num_lines; ++ii)
+        out << "thread " << tt << " line " << ii << std::endl;
+    });
+  for (auto&& thread : threads)
+    thread.join();
+}
+
+GTEST_TEST(LoggerTest, async)
+{
+  using namespace Dune::XT::Common;
+  std::ostringstream sink;
+  int flags = LOG_INFO;
+  AsyncLogBackend backend(AsyncLogOptions(LogOverflowPolicy::block, 16));
+  AsyncLogStream stream(LOG_INFO, flags, backend, sink);
+  write_lines(stream, 4, 1000);
+  stream << "partial";
+  backend.flush();
+  // lines of different threads are not interleaved
+  std::istringstream lines(sink.str());
+  std::set<std::string> seen;
+  for (std::string line; std::getline(lines, line);)
+    seen.insert(line);
+  EXPECT_EQ(seen.size(), 4000u);
+  EXPECT_EQ(seen.count("thread 3 line 999"), 1u);
+  EXPECT_EQ(backend.dropped(), 0u);
+  stream.suspend();
+  stream << "suspended" << std::endl;
+  stream.resume();
+  stream.flush();
+  backend.flush();
+  EXPECT_EQ(sink.str().substr(sink.str().size() - 7), "partial");
+  EXPECT_EQ(sink.str().find("suspended"), std::string::npos);
+}
+
+//! string buffer which blocks writing while mutex is locked
+struct BlockingStringBuffer : public std::stringbuf
+{
+  std::mutex mutex;
+
+protected:
+  virtual std::streamsize xsputn(const char_type* s, std::streamsize count)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::stringbuf::xsputn(s, count);
+  }
+};
+
+GTEST_TEST(LoggerTest, async_overflow)
+{
+  using namespace Dune::XT::Common;
+  BlockingStringBuffer buffer;
+  std::ostream sink(&buffer);
+  int flags = LOG_INFO;
+  AsyncLogBackend backend(AsyncLogOptions(LogOverflowPolicy::count, 4, 1024, std::chrono::hours(1)));
+  AsyncLogStream stream(LOG_INFO, flags, backend, sink);
+  {
+    // the background thread cannot make room while the sink blocks
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    for (size_t ii = 0; ii < 10; ++ii)
+      stream << "line " << ii << std::endl;
+  }
+  backend.flush();
+  EXPECT_EQ(backend.dropped(), 6u);
+  // the drop is reported after the records written in the same batch
+  auto output = buffer.str();
+  const std::string report = "(6 log records dropped)\n";
+  const auto position = output.find(report);
+  ASSERT_NE(position, std::string::npos);
+  output.erase(position, report.size());
+  EXPECT_EQ(output, "line 0\nline 1\nline 2\nline 3\n");
+}
+
+std::atomic<bool> async_signal_handled(false);
+
+void handle_async_signal(int /*signal*/)
+{
+  async_signal_handled = true;
+}
+
+GTEST_TEST(LoggerTest, async_signal)
+{
+  using namespace Dune::XT::Common;
+  std::ostringstream sink;
+  int flags = LOG_INFO;
+  AsyncLogBackend backend(AsyncLogOptions(LogOverflowPolicy::block, 1024, 1024, std::chrono::hours(1)));
+  AsyncLogStream stream(LOG_INFO, flags, backend, sink);
+  backend.flush();
+  stream << "before the signal" << std::endl;
+  install_signal_handler(SIGUSR1, handle_async_signal);
+  raise(SIGUSR1);
+  EXPECT_TRUE(async_signal_handled);
+  EXPECT_EQ(sink.str(), "before the signal\n");
+  reset_signal(SIGUSR1);
+}
+
+GTEST_TEST(LoggerTest, async_file)
+{
+  using namespace Dune::XT::Common;
+  Logger().set_async(true);
+  EXPECT_TRUE(Logger().async());
+  Logger().create(LOG_INFO | LOG_FILE, "test_common_async_logger", "", "");
+  write_lines(Logger().info(), 4, 100);
+  Logger().flush();
+  std::ifstream file("test_common_async_logger.log");
+  size_t num_lines = 0;
+  for (std::string line; std::getline(file, line);)
+    ++num_lines;
+  EXPECT_EQ(num_lines, 400u);
+  Logger().set_async(false);
+  EXPECT_FALSE(Logger().async());
+}
+
+GTEST_TEST(LoggerTest, disabled_levels)
+{
+  using namespace Dune::XT::Common;
+  size_t evaluations = 0;
+  const auto evaluate = [&]() { return ++evaluations; };
+  Logger().create(LOG_INFO | LOG_CONSOLE);
+  EXPECT_TRUE(Logging::enabled(LOG_INFO));
+  EXPECT_FALSE(Logging::enabled(LOG_DEBUG));
+  DXTC_LOG_DEBUG_IF_ENABLED << "not in output " << evaluate() << std::endl;
+  DXTC_LOG_ERROR_IF_ENABLED << "not in output " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 0u);
+  DXTC_LOG_INFO_IF_ENABLED << "in output " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 1u);
+  Logger().suspend();
+  DXTC_LOG_INFO_IF_ENABLED << "not in output " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 1u);
+  Logger().resume();
+  Logger().set_stream_flags(LOG_DEBUG, LOG_DEBUG | LOG_CONSOLE);
+  DXTC_LOG_DEBUG_IF_ENABLED << "in output " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 2u);
+  const auto id = Logger().add_stream(LOG_CONSOLE);
+  EXPECT_TRUE(Logging::enabled(id));
+  DXTC_LOG_STREAM_IF_ENABLED(id) << "in output " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 3u);
+  Logger().set_stream_flags(id, LOG_CONSOLE);
+  DXTC_LOG_STREAM_IF_ENABLED(id) << "not in output " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 3u);
+  // also usable as the body of an if without braces
+  if (evaluations > 0)
+    DXTC_LOG_IF(false, std::cout) << evaluate();
+  else
+    evaluate();
+  EXPECT_EQ(evaluations, 3u);
+}
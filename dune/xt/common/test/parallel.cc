@@ -12,10 +12,21 @@
 #include <dune/xt/common/test/main.hxx>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
 #include <thread>
 #include <type_traits>
 #include <vector>
 
+#if HAVE_TBB
+#  include <tbb/concurrent_unordered_map.h>
+#  include <tbb/parallel_for.h>
+#endif
+
+#include <dune/xt/common/concurrent_configuration.hh>
+#include <dune/xt/common/parallel/chase_lev_deque.hh>
 #include <dune/xt/common/parallel/threadmanager.hh>
 #include <dune/xt/common/parallel/threadstorage.hh>
 #include <dune/xt/common/parallel/helper.hh>
@@ -65,7 +76,11 @@ void check_eq(ThreadValue& foo, const typename ThreadValue::ValueType& value)
   Checker<ThreadValue>::check_eq(foo, value);
 }
 
-typedef testing::Types<PerThreadValue<int>, PerThreadValue<const int>> TLSTypes;
+typedef testing::Types<PerThreadValue<int>,
+                       PerThreadValue<const int>,
+                       PerThreadValue<int, PaddedThreadStorage>,
+                       PerThreadValue<const int, FirstTouchThreadStorage>>
+    TLSTypes;
 
 template <class T>
 struct ThreadValueTest : public testing::Test
@@ -90,8 +105,18 @@ TYPED_TEST(ThreadValueTest, All)
     PTVType foo(zero);
     size_t num_threads = Dune::XT::Common::threadManager().max_threads();
     std::vector<std::thread> threads(num_threads);
+    // threads which are alive at the same time have values of their own, later ones may continue with those
+    std::atomic<size_t> arrived(0);
+    const auto wait_for_all = [&]() {
+      ++arrived;
+      while (arrived % num_threads != 0)
+        std::this_thread::yield();
+    };
     for (size_t ii = 0; ii < num_threads; ++ii)
-      threads[ii] = std::thread([&foo, &zero]() { EXPECT_EQ(*foo, zero); });
+      threads[ii] = std::thread([&foo, &zero, &wait_for_all]() {
+        EXPECT_EQ(*foo, zero);
+        wait_for_all();
+      });
     for (size_t ii = 0; ii < num_threads; ++ii)
       threads[ii].join();
     auto sum = foo.accumulate(0, std::plus<typename PTVType::ValueType>());
@@ -99,7 +124,10 @@ TYPED_TEST(ThreadValueTest, All)
     typename PTVType::ValueType one = 1;
     PTVType bar(one);
     for (size_t ii = 0; ii < num_threads; ++ii)
-      threads[ii] = std::thread([&bar, &one]() { EXPECT_EQ(*bar, one); });
+      threads[ii] = std::thread([&bar, &one, &wait_for_all]() {
+        EXPECT_EQ(*bar, one);
+        wait_for_all();
+      });
     for (size_t ii = 0; ii < num_threads; ++ii)
       threads[ii].join();
     sum = bar.accumulate(0, std::plus<typename PTVType::ValueType>());
@@ -112,4 +140,146 @@ GTEST_TEST(ThreadManager, All)
   auto& tm = Dune::XT::Common::threadManager();
   EXPECT_LE(tm.current_threads(), tm.max_threads());
   EXPECT_LT(tm.thread(), tm.current_threads());
+  EXPECT_EQ(tm.max_threads(), DXTC_CONCURRENT_CONFIG.get("threading.max_count", size_t(1)));
+#if HAVE_TBB
+  EXPECT_EQ(size_t(tm.arena().max_concurrency()), tm.max_threads());
+  std::atomic<size_t> concurrent(0);
+  std::atomic<size_t> max_concurrent(0);
+  tm.arena().execute([&]() {
+    tbb::parallel_for(size_t(0), size_t(1000), [&](size_t) {
+      const auto current = ++concurrent;
+      auto seen = max_concurrent.load();
+      while (current > seen && !max_concurrent.compare_exchange_weak(seen, current))
+        ;
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      --concurrent;
+    });
+  });
+  EXPECT_LE(max_concurrent, tm.max_threads());
+#endif
+}
+
+GTEST_TEST(ThreadManager, RecycledThreadNumbers)
+{
+  auto& tm = Dune::XT::Common::threadManager();
+  const auto own = tm.thread();
+  EXPECT_EQ(tm.thread(), own);
+  // Other threads (e.g. TBB workers) may hold or return numbers meanwhile, so only numbers known to be free are
+  // checked: the number of a joined thread is free again, so the next thread gets it or a smaller one.
+  std::vector<size_t> numbers;
+  for (size_t ii = 0; ii < 10; ++ii) {
+    std::thread thread([&]() { numbers.push_back(threadManager().thread()); });
+    thread.join();
+    EXPECT_NE(numbers.back(), own);
+    if (ii > 0)
+      EXPECT_LE(numbers[ii], numbers[ii - 1]);
+  }
+  // threads running at the same time get distinct numbers
+  const size_t num_threads = tm.max_threads();
+  std::vector<size_t> concurrent(num_threads);
+  std::vector<std::thread> threads(num_threads);
+  std::atomic<size_t> arrived(0);
+  for (size_t ii = 0; ii < num_threads; ++ii)
+    threads[ii] = std::thread([&, ii]() {
+      concurrent[ii] = threadManager().thread();
+      ++arrived;
+      while (arrived < num_threads)
+        std::this_thread::yield();
+    });
+  for (auto&& thread : threads)
+    thread.join();
+  const std::set<size_t> distinct(concurrent.begin(), concurrent.end());
+  EXPECT_EQ(distinct.size(), num_threads);
+  EXPECT_EQ(distinct.count(own), 0u);
+  // the first thread got the smallest free number
+  EXPECT_LE(*distinct.begin(), numbers.back());
+}
+
+/** compares the cost of ThreadManager::thread() to the previous lookup of the thread id in a concurrent hash map
+ *  \note disabled by default, run with --gtest_also_run_disabled_tests --gtest_filter='*Benchmark' **/
+GTEST_TEST(ThreadManager, DISABLED_ThreadNumberBenchmark)
+{
+  const size_t iterations = 10000000;
+  auto& tm = Dune::XT::Common::threadManager();
+  const auto own = tm.thread();
+  const auto measure = [&](const std::string& name, auto lookup) {
+    size_t sum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < iterations; ++ii)
+      sum += lookup();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_EQ(sum, iterations * own);
+    std::cout << name << ": " << elapsed.count() / iterations << " ns per call" << std::endl;
+  };
+  measure("ThreadManager::thread()", [&]() { return tm.thread(); });
+#if HAVE_TBB
+  tbb::concurrent_unordered_map<std::thread::id, size_t, std::hash<std::thread::id>> thread_ids;
+  thread_ids.insert(std::make_pair(std::this_thread::get_id(), own));
+  measure("concurrent_unordered_map lookup", [&]() { return thread_ids.find(std::this_thread::get_id())->second; });
+#endif
+}
+
+/** compares the storage policies of PerThreadValue for threads concurrently updating their values
+ *  \note disabled by default, run with --gtest_also_run_disabled_tests --gtest_filter='*Benchmark' **/
+GTEST_TEST(PerThreadValue, DISABLED_StoragePolicyBenchmark)
+{
+  const size_t iterations = 10000000;
+  const size_t num_threads = threadManager().max_threads();
+  const auto measure = [&](const std::string& name, auto&& values) {
+    std::vector<std::thread> threads;
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < num_threads; ++ii)
+      threads.emplace_back([&]() {
+        auto& value = *values;
+        for (size_t jj = 0; jj < iterations; ++jj) {
+          // volatile keeps the compiler from merging the updates, as concurrent updates of a shared counter would
+          auto& volatile_value = static_cast<volatile size_t&>(value);
+          volatile_value = volatile_value + 1;
+        }
+      });
+    for (auto&& thread : threads)
+      thread.join();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_EQ(values.sum(), num_threads * iterations);
+    std::cout << name << ": " << elapsed.count() / iterations << " ns per update (" << num_threads << " threads)"
+              << std::endl;
+  };
+  measure("DefaultThreadStorage", PerThreadValue<size_t>(0));
+  measure("PaddedThreadStorage", PerThreadValue<size_t, PaddedThreadStorage>(0));
+  measure("FirstTouchThreadStorage", PerThreadValue<size_t, FirstTouchThreadStorage>(0));
+}
+
+GTEST_TEST(ChaseLevDeque, OwnerAndThieves)
+{
+  const size_t num_items = 100000;
+  const size_t num_thieves = 3;
+  std::vector<size_t> items(num_items);
+  std::vector<std::atomic<size_t>> seen(num_items);
+  for (size_t ii = 0; ii < num_items; ++ii) {
+    items[ii] = ii;
+    seen[ii] = 0;
+  }
+  // small initial capacity to exercise growing
+  ChaseLevDeque<size_t> deque(4);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> thieves;
+  for (size_t ii = 0; ii < num_thieves; ++ii)
+    thieves.emplace_back([&]() {
+      while (!done || !deque.empty())
+        if (auto* item = deque.steal())
+          ++seen[*item];
+    });
+  for (size_t ii = 0; ii < num_items; ++ii) {
+    deque.push(&items[ii]);
+    if (ii % 3 == 0)
+      if (auto* item = deque.take())
+        ++seen[*item];
+  }
+  while (auto* item = deque.take())
+    ++seen[*item];
+  done = true;
+  for (auto&& thief : thieves)
+    thief.join();
+  for (size_t ii = 0; ii < num_items; ++ii)
+    EXPECT_EQ(seen[ii], 1u) << ii;
 }
@@ -0,0 +1,182 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <numeric>
+#include <vector>
+
+#include <dune/xt/common/parallel/algorithms.hh>
+#include <dune/xt/common/parallel/threadstorage.hh>
+
+using namespace Dune::XT::Common;
+
+static std::vector<ParallelBackend> available_backends()
+{
+  std::vector<ParallelBackend> backends = {ParallelBackend::automatic, ParallelBackend::thread_pool};
+#if HAVE_TBB
+  backends.push_back(ParallelBackend::tbb);
+#endif
+  backends.push_back(ParallelBackend::serial);
+  return backends;
+}
+
+GTEST_TEST(ParallelAlgorithms, ParallelFor)
+{
+  for (auto backend : available_backends()) {
+    std::vector<size_t> values(1000, 0);
+    parallel_for(size_t(0), values.size(), [&](size_t ii) { values[ii] += ii; }, ParallelOptions(0, false, backend));
+    for (size_t ii = 0; ii < values.size(); ++ii)
+      EXPECT_EQ(values[ii], ii);
+    // iterator ranges need not be random access
+    std::list<int> list(1000, 1);
+    std::atomic<int> sum(0);
+    parallel_for(list.begin(), list.end(), [&](int value) { sum += value; }, ParallelOptions(7, false, backend));
+    EXPECT_EQ(sum, 1000);
+    // empty ranges
+    parallel_for(5, 5, [&](int) { ADD_FAILURE(); }, ParallelOptions(0, false, backend));
+    parallel_for(list.end(), list.end(), [&](int) { ADD_FAILURE(); }, ParallelOptions(0, false, backend));
+  }
+}
+
+GTEST_TEST(ParallelAlgorithms, Nested)
+{
+  for (auto backend : available_backends()) {
+    std::atomic<size_t> count(0);
+    const ParallelOptions options(1, false, backend);
+    parallel_for(0, 8, [&](int) { parallel_for(0, 100, [&](int) { ++count; }, options); }, options);
+    EXPECT_EQ(count, 800u);
+  }
+}
+
+GTEST_TEST(ParallelAlgorithms, Exceptions)
+{
+  for (auto backend : available_backends())
+    EXPECT_THROW(parallel_for(0,
+                              100,
+                              [](int ii) {
+                                if (ii == 50)
+                                  DUNE_THROW(Dune::InvalidStateException, "");
+                              },
+                              ParallelOptions(1, false, backend)),
+                 Dune::InvalidStateException);
+}
+
+GTEST_TEST(ParallelAlgorithms, ParallelReduce)
+{
+  std::vector<double> values(100000);
+  for (size_t ii = 0; ii < values.size(); ++ii)
+    values[ii] = 1. / double(ii + 1);
+  const auto term = [&](size_t ii) { return values[ii]; };
+  const auto serial = std::accumulate(values.begin(), values.end(), 0.);
+  const auto reference = parallel_reduce(size_t(0),
+                                         values.size(),
+                                         0.,
+                                         term,
+                                         std::plus<double>(),
+                                         ParallelOptions(0, true, ParallelBackend::serial));
+  for (auto backend : available_backends()) {
+    // the deterministic result is the same for all backends and numbers of threads
+    EXPECT_EQ(
+        parallel_reduce(size_t(0), values.size(), 0., term, std::plus<double>(), ParallelOptions(0, true, backend)),
+        reference);
+    EXPECT_EQ(parallel_reduce(values.begin(),
+                              values.end(),
+                              0.,
+                              [](double value) { return value; },
+                              std::plus<double>(),
+                              ParallelOptions(0, true, backend)),
+              reference);
+    EXPECT_NEAR(
+        parallel_reduce(size_t(0), values.size(), 0., term, std::plus<double>(), ParallelOptions(0, false, backend)),
+        serial,
+        1e-12);
+  }
+  EXPECT_EQ(parallel_reduce(3, 3, 42, [](int ii) { return ii; }, std::plus<int>()), 42);
+}
+
+GTEST_TEST(ParallelAlgorithms, ParallelScan)
+{
+  std::vector<long> values(10007);
+  std::iota(values.begin(), values.end(), -500);
+  std::vector<long> expected(values.size());
+  std::partial_sum(values.begin(), values.end(), expected.begin());
+  for (auto& value : expected)
+    value += 3;
+  for (auto backend : available_backends()) {
+    std::vector<long> scanned(values.size());
+    const auto end = parallel_scan(
+        values.begin(), values.end(), scanned.begin(), 3l, std::plus<long>(), ParallelOptions(13, false, backend));
+    EXPECT_EQ(end, scanned.end());
+    EXPECT_EQ(scanned, expected);
+    std::vector<long> indexed(values.size());
+    parallel_scan(size_t(0),
+                  values.size(),
+                  3l,
+                  [&](size_t ii) { return values[ii]; },
+                  std::plus<long>(),
+                  [&](size_t ii, long value) { indexed[ii] = value; },
+                  ParallelOptions(0, false, backend));
+    EXPECT_EQ(indexed, expected);
+  }
+}
+
+GTEST_TEST(ParallelAlgorithms, PerThreadValue)
+{
+  for (auto backend : available_backends()) {
+    PerThreadValue<size_t> count(0);
+    parallel_for(0, 10000, [&](int) { ++(*count); }, ParallelOptions(10, false, backend));
+    EXPECT_EQ(count.sum(), 10000u);
+    EXPECT_LE(size_t(std::distance(count.begin(), count.end())), 10000u);
+  }
+}
+
+GTEST_TEST(ParallelAlgorithms, TreeReduce)
+{
+  const auto concatenate = [](std::vector<size_t>&& left, std::vector<size_t>&& right) {
+    left.insert(left.end(), right.begin(), right.end());
+    return std::move(left);
+  };
+  std::vector<double> doubles(37);
+  for (size_t ii = 0; ii < doubles.size(); ++ii)
+    doubles[ii] = 1. / (ii + 1);
+  const auto serial_sum = parallel_tree_reduce(doubles, 0., std::plus<double>(), ParallelOptions(0, true));
+  for (auto backend : available_backends()) {
+    // deterministic pairing only requires associativity, so the order is kept
+    std::vector<std::vector<size_t>> vectors(37);
+    for (size_t ii = 0; ii < vectors.size(); ++ii)
+      vectors[ii] = {2 * ii, 2 * ii + 1};
+    const auto concatenated =
+        parallel_tree_reduce(std::move(vectors), std::vector<size_t>(), concatenate, ParallelOptions(0, true, backend));
+    ASSERT_EQ(concatenated.size(), 74u);
+    for (size_t ii = 0; ii < concatenated.size(); ++ii)
+      EXPECT_EQ(concatenated[ii], ii);
+    EXPECT_EQ(parallel_tree_reduce(doubles, 0., std::plus<double>(), ParallelOptions(0, true, backend)), serial_sum);
+    // otherwise any order
+    std::vector<size_t> numbers(1000);
+    std::iota(numbers.begin(), numbers.end(), size_t(1));
+    EXPECT_EQ(parallel_tree_reduce(numbers, size_t(0), std::plus<size_t>(), ParallelOptions(0, false, backend)),
+              500500u);
+    EXPECT_EQ(parallel_tree_reduce(std::vector<size_t>(), size_t(3), std::plus<size_t>()), 3u);
+    // PerThreadValue
+    PerThreadValue<std::vector<size_t>> indices;
+    parallel_for(
+        size_t(0), size_t(1000), [&](size_t ii) { indices->push_back(ii); }, ParallelOptions(10, false, backend));
+    auto all = indices.tree_accumulate(std::vector<size_t>(), concatenate, ParallelOptions(0, true, backend));
+    EXPECT_EQ(all.size(), 1000u);
+    all = indices.tree_reduce(std::vector<size_t>(), concatenate, ParallelOptions(0, false, backend));
+    std::sort(all.begin(), all.end());
+    for (size_t ii = 0; ii < all.size(); ++ii)
+      EXPECT_EQ(all[ii], ii);
+    PerThreadValue<size_t> count(0);
+    parallel_for(0, 1000, [&](int) { ++(*count); }, ParallelOptions(10, false, backend));
+    EXPECT_EQ(count.tree_sum(ParallelOptions(0, false, backend)), 1000u);
+  }
+}
@@ -0,0 +1,234 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <dune/xt/common/parallel/partitioner.hh>
+
+using namespace Dune::XT::Common;
+
+//! the parts of the grid view interface used by the partitioners, for a structured grid of n x n unit squares
+struct SquaresGridView
+{
+  static constexpr int dimensionworld = 2;
+
+  struct Geometry
+  {
+    std::array<double, 2> center() const
+    {
+      return center_;
+    }
+    std::array<double, 2> center_;
+  };
+
+  struct Entity
+  {
+    Geometry geometry() const
+    {
+      return {{{x + 0.5, y + 0.5}}};
+    }
+    std::size_t index, x, y;
+  };
+
+  template <int codim>
+  struct Codim
+  {
+    typedef SquaresGridView::Entity Entity;
+  };
+
+  struct IndexSet
+  {
+    std::size_t index(const Entity& entity) const
+    {
+      return entity.index;
+    }
+    std::size_t size(int /*codim*/) const
+    {
+      return size_;
+    }
+    std::size_t size_;
+  };
+
+  explicit SquaresGridView(const std::size_t n)
+    : index_set_{n * n}
+  {
+    // row-wise numbering
+    for (std::size_t yy = 0; yy < n; ++yy)
+      for (std::size_t xx = 0; xx < n; ++xx)
+        entities_.push_back({yy * n + xx, xx, yy});
+  }
+
+  template <int codim>
+  std::vector<Entity>::const_iterator begin() const
+  {
+    return entities_.begin();
+  }
+
+  template <int codim>
+  std::vector<Entity>::const_iterator end() const
+  {
+    return entities_.end();
+  }
+
+  const IndexSet& indexSet() const
+  {
+    return index_set_;
+  }
+
+  IndexSet index_set_;
+  std::vector<Entity> entities_;
+};
+
+GTEST_TEST(Partitioner, Block)
+{
+  const SquaresGridView grid_view(10);
+  EXPECT_EQ(BlockPartitioner<SquaresGridView>::entities_per_block(64, 1024), 16u);
+  EXPECT_EQ(BlockPartitioner<SquaresGridView>::entities_per_block(2048, 1024), 1u);
+  const BlockPartitioner<SquaresGridView> partitioner(grid_view.indexSet(), 16);
+  EXPECT_EQ(partitioner.partitions(), 7u);
+  for (const auto& entity : grid_view.entities_)
+    EXPECT_EQ(partitioner.partition(entity), entity.index / 16);
+  EXPECT_THROW(BlockPartitioner<SquaresGridView>(grid_view.indexSet(), 0), Exceptions::wrong_input_given);
+}
+
+GTEST_TEST(Partitioner, Weighted)
+{
+  const SquaresGridView grid_view(10);
+  std::vector<double> weights(100, 1.);
+  weights[0] = 50.;
+  weights[99] = 10.;
+  const WeightedPartitioner<SquaresGridView> partitioner(grid_view.indexSet(), weights, 4);
+  EXPECT_EQ(partitioner.partitions(), 4u);
+  std::vector<double> partition_weights(4, 0.);
+  std::size_t previous = 0;
+  for (const auto& entity : grid_view.entities_) {
+    const auto partition = partitioner.partition(entity);
+    // contiguous in index order
+    EXPECT_GE(partition, previous);
+    previous = partition;
+    partition_weights[partition] += weights[entity.index];
+  }
+  const auto max_weight = *std::max_element(weights.begin(), weights.end());
+  for (const auto& partition_weight : partition_weights)
+    EXPECT_LE(std::abs(partition_weight - 157. / 4), max_weight / 2 + 1) << partition_weight;
+  // zero weights count the same
+  const WeightedPartitioner<SquaresGridView> uniform(grid_view.indexSet(), std::vector<double>(100, 0.), 4);
+  for (const auto& entity : grid_view.entities_)
+    EXPECT_EQ(uniform.partition(entity), entity.index / 25);
+  EXPECT_THROW(WeightedPartitioner<SquaresGridView>(grid_view.indexSet(), std::vector<double>(99, 1.), 4),
+               Exceptions::shapes_do_not_match);
+}
+
+GTEST_TEST(Partitioner, SpaceFillingCurveKeys)
+{
+  const std::array<std::uint32_t, 2> corner{{1, 0}};
+  EXPECT_EQ(morton_key(corner, 1), 2u);
+  // consecutive cells along the Hilbert curve are neighbors
+  for (unsigned int bits : {1u, 2u, 4u}) {
+    const std::uint32_t n = std::uint32_t(1) << bits;
+    std::vector<std::array<std::uint32_t, 2>> cells(n * n);
+    for (std::uint32_t xx = 0; xx < n; ++xx)
+      for (std::uint32_t yy = 0; yy < n; ++yy) {
+        const auto key = hilbert_key(std::array<std::uint32_t, 2>{{xx, yy}}, bits);
+        ASSERT_LT(key, n * n);
+        cells[key] = {{xx, yy}};
+      }
+    for (std::size_t ii = 1; ii < cells.size(); ++ii) {
+      const auto distance = std::abs(int(cells[ii][0]) - int(cells[ii - 1][0]))
+                            + std::abs(int(cells[ii][1]) - int(cells[ii - 1][1]));
+      EXPECT_EQ(distance, 1) << "bits " << bits << ", key " << ii;
+    }
+  }
+  const std::uint32_t n = 8;
+  std::vector<std::array<std::uint32_t, 3>> cells(n * n * n);
+  for (std::uint32_t xx = 0; xx < n; ++xx)
+    for (std::uint32_t yy = 0; yy < n; ++yy)
+      for (std::uint32_t zz = 0; zz < n; ++zz)
+        cells[hilbert_key(std::array<std::uint32_t, 3>{{xx, yy, zz}}, 3)] = {{xx, yy, zz}};
+  for (std::size_t ii = 1; ii < cells.size(); ++ii) {
+    int distance = 0;
+    for (std::size_t dd = 0; dd < 3; ++dd)
+      distance += std::abs(int(cells[ii][dd]) - int(cells[ii - 1][dd]));
+    EXPECT_EQ(distance, 1) << "key " << ii;
+  }
+}
+
+GTEST_TEST(Partitioner, SpaceFillingCurve)
+{
+  const SquaresGridView grid_view(16);
+  for (auto curve : {SpaceFillingCurve::hilbert, SpaceFillingCurve::morton}) {
+    const SpaceFillingCurvePartitioner<SquaresGridView> partitioner(grid_view, 4, curve);
+    EXPECT_EQ(partitioner.partitions(), 4u);
+    // both curves visit the quadrants one after another
+    std::vector<std::array<std::size_t, 5>> bounds(4, {{16, 16, 0, 0, 0}});
+    for (const auto& entity : grid_view.entities_) {
+      auto& bound = bounds[partitioner.partition(entity)];
+      bound[0] = std::min(bound[0], entity.x);
+      bound[1] = std::min(bound[1], entity.y);
+      bound[2] = std::max(bound[2], entity.x);
+      bound[3] = std::max(bound[3], entity.y);
+      ++bound[4];
+    }
+    for (const auto& bound : bounds) {
+      EXPECT_EQ(bound[4], 64u);
+      EXPECT_EQ(bound[2] - bound[0], 7u);
+      EXPECT_EQ(bound[3] - bound[1], 7u);
+    }
+  }
+}
+
+GTEST_TEST(Partitioner, Adaptive)
+{
+  const SquaresGridView grid_view(10);
+  // the first rows are ten times as expensive as the others
+  const auto cost = [](const SquaresGridView::Entity& entity) { return entity.y < 2 ? 10000u : 1000u; };
+  AdaptivePartitioner<SquaresGridView> partitioner(grid_view.indexSet(), 4);
+  EXPECT_EQ(partitioner.partitions(), 4u);
+  const auto sweep = [&]() {
+    std::vector<double> partition_costs(4, 0.);
+    for (const auto& entity : grid_view.entities_) {
+      partitioner.add_time(partitioner.partition(entity), cost(entity));
+      partition_costs[partitioner.partition(entity)] += cost(entity);
+    }
+    return *std::max_element(partition_costs.begin(), partition_costs.end());
+  };
+  // total cost is 280000
+  EXPECT_EQ(sweep(), 205000.);
+  partitioner.rebalance();
+  EXPECT_EQ(partitioner.sweeps(), 1u);
+  // the costs within the partitions are only learned over a few sweeps
+  EXPECT_LE(sweep(), 100000.);
+  for (size_t ii = 0; ii < 3; ++ii) {
+    sweep();
+    partitioner.rebalance(0.5);
+  }
+  EXPECT_LE(sweep(), 75000.);
+  partitioner.rebalance();
+  for (size_t pp = 0; pp < 4; ++pp)
+    EXPECT_EQ(partitioner.time(pp), 0u);
+  {
+    AdaptivePartitioner<SquaresGridView>::ScopedTiming timing(partitioner, 1);
+  }
+  EXPECT_THROW(partitioner.add_time(4, 1), Exceptions::index_out_of_range);
+  // persisted weights
+  const std::string filename = "partitioner_weights.txt";
+  partitioner.save_weights(filename);
+  AdaptivePartitioner<SquaresGridView> loaded(grid_view.indexSet(), 4);
+  EXPECT_FALSE(loaded.load_weights("does_not_exist.txt"));
+  EXPECT_TRUE(loaded.load_weights(filename));
+  EXPECT_EQ(loaded.weights(), partitioner.weights());
+  for (const auto& entity : grid_view.entities_)
+    EXPECT_EQ(loaded.partition(entity), partitioner.partition(entity));
+  AdaptivePartitioner<SquaresGridView> other_size(SquaresGridView(3).indexSet(), 4);
+  EXPECT_THROW(other_size.load_weights(filename), Exceptions::shapes_do_not_match);
+}
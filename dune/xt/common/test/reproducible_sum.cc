@@ -0,0 +1,129 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/math.hh>
+#include <dune/xt/common/parallel/algorithms.hh>
+#include <dune/xt/common/parallel/threadstorage.hh>
+#include <dune/xt/common/reproducible_sum.hh>
+
+using namespace Dune::XT::Common;
+
+//! values of widely varying magnitude and sign, whose plain sum depends on the order
+static std::vector<double> ill_conditioned_values(const size_t size)
+{
+  std::mt19937_64 generator(42);
+  std::uniform_real_distribution<double> mantissa(-1., 1.);
+  std::uniform_int_distribution<int> exponent(-40, 40);
+  std::vector<double> values(size);
+  for (auto&& value : values)
+    value = std::ldexp(mantissa(generator), exponent(generator));
+  return values;
+}
+
+GTEST_TEST(ReproducibleSum, Exact)
+{
+  ReproducibleSum sum;
+  for (double value : {1e16, 1., -1e16})
+    sum += value;
+  EXPECT_EQ(sum.value(), 1.);
+  // intermediate results beyond the range of double
+  const auto max = std::numeric_limits<double>::max();
+  EXPECT_EQ((ReproducibleSum(max) + max + -max).value(), max);
+  EXPECT_EQ((ReproducibleSum(max) + max).value(), std::numeric_limits<double>::infinity());
+  // subnormals
+  const auto denorm_min = std::numeric_limits<double>::denorm_min();
+  EXPECT_EQ((ReproducibleSum(denorm_min) + denorm_min).value(), 2 * denorm_min);
+  EXPECT_EQ((ReproducibleSum(1.) + denorm_min + -1.).value(), denorm_min);
+  EXPECT_EQ((ReproducibleSum(-3.5) + 1.25).value(), -2.25);
+  EXPECT_EQ(ReproducibleSum().value(), 0.);
+  EXPECT_EQ((ReproducibleSum(1.) + std::numeric_limits<double>::infinity()).value(),
+            std::numeric_limits<double>::infinity());
+  EXPECT_TRUE(std::isnan((ReproducibleSum(std::numeric_limits<double>::infinity())
+                          + -std::numeric_limits<double>::infinity())
+                             .value()));
+}
+
+GTEST_TEST(ReproducibleSum, OrderIndependence)
+{
+  auto values = ill_conditioned_values(100000);
+  const auto expected = sum<double>(values.begin(), values.end(), SummationMode::reproducible);
+  EXPECT_NEAR(expected, sum<double>(values.begin(), values.end()), 1e-10 * std::abs(expected));
+  std::mt19937_64 generator(4711);
+  for (size_t run = 0; run < 5; ++run) {
+    std::shuffle(values.begin(), values.end(), generator);
+    EXPECT_EQ(sum<double>(values.begin(), values.end(), SummationMode::reproducible), expected);
+    // partial sums as computed by threads or ranks
+    std::vector<ReproducibleSum> partials(run + 2);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+      partials[ii % partials.size()] += values[ii];
+    EXPECT_EQ(std::accumulate(partials.begin(), partials.end(), ReproducibleSum()).value(), expected);
+  }
+  const auto comm = Dune::MPIHelper::getCollectiveCommunication();
+  std::vector<double> local(values.begin() + comm.rank(), values.begin() + comm.rank() + 3);
+  std::vector<double> fast(local);
+  Dune::XT::Common::sum(local.data(), local.size(), SummationMode::reproducible, comm);
+  Dune::XT::Common::sum(fast.data(), fast.size(), SummationMode::fast, comm);
+  for (size_t ii = 0; ii < local.size(); ++ii)
+    EXPECT_NEAR(local[ii], fast[ii], 1e-10);
+}
+
+GTEST_TEST(ReproducibleSum, PerThreadValue)
+{
+  const auto values = ill_conditioned_values(100000);
+  const auto expected = sum<double>(values.begin(), values.end(), SummationMode::reproducible);
+  for (size_t grain : {1, 7, 1000}) {
+    PerThreadValue<ReproducibleSum> sums(0.);
+    parallel_for(size_t(0), values.size(), [&](size_t ii) { *sums += values[ii]; }, ParallelOptions(grain));
+    EXPECT_EQ(sums.sum().value(), expected);
+    EXPECT_EQ(sums.tree_sum().value(), expected);
+    PerThreadValue<double> plain(0.);
+    parallel_for(size_t(0), values.size(), [&](size_t ii) { *plain += values[ii]; }, ParallelOptions(grain));
+    EXPECT_NEAR(plain.sum(SummationMode::reproducible), expected, 1e-10 * std::abs(expected));
+  }
+}
+
+GTEST_TEST(ReproducibleSum, MinMaxAvg)
+{
+  auto values = ill_conditioned_values(1000);
+  const MinMaxAvg<double, SummationMode::reproducible> expected(values);
+  std::reverse(values.begin(), values.end());
+  const MinMaxAvg<double, SummationMode::reproducible> reversed(values);
+  EXPECT_EQ(reversed.sum(), expected.sum());
+  EXPECT_EQ(reversed.average(), expected.average());
+  EXPECT_EQ(reversed.min(), expected.min());
+  EXPECT_EQ(reversed.max(), expected.max());
+  EXPECT_EQ(reversed.count(), 1000u);
+  EXPECT_NEAR(MinMaxAvg<double>(values).sum(), expected.sum(), 1e-10 * std::abs(expected.sum()));
+}
+
+/** compares the throughput of plain and exact summation
+ *  \note disabled by default, run with --gtest_also_run_disabled_tests --gtest_filter='*Benchmark' **/
+GTEST_TEST(ReproducibleSum, DISABLED_Benchmark)
+{
+  const auto values = ill_conditioned_values(10000000);
+  const auto measure = [&](const std::string& name, const SummationMode mode) {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto result = sum<double>(values.begin(), values.end(), mode);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    std::cout << name << ": " << elapsed.count() / values.size() << " ns per value (sum " << result << ")" << std::endl;
+  };
+  measure("SummationMode::fast", SummationMode::fast);
+  measure("SummationMode::reproducible", SummationMode::reproducible);
+}
@@ -0,0 +1,195 @@
+// This file is part of the dune-xt-common project:
+//   https://github.com/dune-community/dune-xt-common
+// Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/xt/common/configuration.hh>
+#include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/logging.hh>
+#include <dune/xt/common/rotating_logging.hh>
+
+using namespace Dune::XT::Common;
+
+//! an empty directory per test and rank
+static std::string directory(const std::string& name)
+{
+  const auto path = "test_common_rotating_logging_p"
+                    + std::to_string(Dune::MPIHelper::getCollectiveCommunication().rank()) + "/" + name;
+  boost::filesystem::remove_all(path);
+  boost::filesystem::create_directories(path);
+  return path;
+}
+
+static size_t count_files(const std::string& path, const std::string& extension)
+{
+  size_t count = 0;
+  for (boost::filesystem::directory_iterator it(path); it != boost::filesystem::directory_iterator(); ++it)
+    count += (it->path().string().size() > extension.size()
+              && it->path().string().compare(
+                     it->path().string().size() - extension.size(), extension.size(), extension)
+                     == 0);
+  return count;
+}
+
+static std::string write_lines(std::ostream& out, const size_t first, const size_t count)
+{
+  std::string written;
+  for (size_t ii = first; ii < first + count; ++ii) {
+    const auto line = "line " + std::to_string(1000 + ii) + "\n";
+    out << line << std::flush;
+    written += line;
+  }
+  return written;
+}
+
+static std::string extract_all(const std::string& filename)
+{
+  std::ostringstream out;
+  extract_rotated_log(
+      filename, std::chrono::system_clock::time_point(), std::chrono::system_clock::now() + std::chrono::hours(1), out);
+  return out.str();
+}
+
+static void test_rotation(const std::string& name, const LogCompression compression, const std::string& extension)
+{
+  const auto path = directory(name);
+  const auto filename = path + "/run.log";
+  std::string written;
+  {
+    RotatingFileStream file(filename, LogRotationOptions(100, std::chrono::seconds(0), 0, compression, 30));
+    ASSERT_TRUE(file.is_open());
+    written = write_lines(file, 0, 100);
+  }
+  // 10 bytes per line, a segment is closed at 100 bytes
+  EXPECT_EQ(count_files(path, ".idx"), 10u);
+  EXPECT_EQ(count_files(path, extension), 10u);
+  EXPECT_FALSE(boost::filesystem::exists(filename));
+  EXPECT_EQ(extract_all(filename), written);
+  // numbering continues
+  {
+    RotatingFileStream file(filename, LogRotationOptions(100, std::chrono::seconds(0), 0, compression, 30));
+    written += write_lines(file, 100, 5);
+  }
+  EXPECT_TRUE(boost::filesystem::exists(path + "/run.000011" + extension));
+  EXPECT_EQ(extract_all(filename), written);
+} // ... test_rotation(...)
+
+GTEST_TEST(RotatingLogging, Rotation)
+{
+  test_rotation("rotation", LogCompression::none, ".log");
+}
+
+#if HAVE_ZLIB
+GTEST_TEST(RotatingLogging, Gzip)
+{
+  test_rotation("gzip", LogCompression::gzip, ".log.gz");
+}
+#endif
+
+#if HAVE_ZSTD
+GTEST_TEST(RotatingLogging, Zstd)
+{
+  test_rotation("zstd", LogCompression::zstd, ".log.zst");
+}
+#endif
+
+GTEST_TEST(RotatingLogging, MaxSegments)
+{
+  const auto path = directory("max_segments");
+  {
+    RotatingFileStream file(path + "/run.log", LogRotationOptions(100, std::chrono::seconds(0), 3));
+    write_lines(file, 0, 100);
+    file.buffer().wait();
+    EXPECT_LE(count_files(path, ".idx"), 3u);
+  }
+  EXPECT_EQ(count_files(path, ".idx"), 3u);
+  EXPECT_EQ(count_files(path, ".log"), 3u);
+  EXPECT_TRUE(boost::filesystem::exists(path + "/run.000010.log"));
+  EXPECT_EQ(extract_all(path + "/run.log").substr(0, 10), "line 1070\n");
+}
+
+GTEST_TEST(RotatingLogging, MaxAge)
+{
+  const auto path = directory("max_age");
+  RotatingFileStream file(path + "/run.log", LogRotationOptions(0, std::chrono::seconds(1)));
+  write_lines(file, 0, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  // the segment is closed after this line
+  write_lines(file, 1, 1);
+  write_lines(file, 2, 1);
+  file.buffer().wait();
+  EXPECT_EQ(count_files(path, ".idx"), 1u);
+  EXPECT_EQ(extract_all(path + "/run.log"), "line 1000\nline 1001\n");
+}
+
+GTEST_TEST(RotatingLogging, TimeRange)
+{
+  const auto path = directory("time_range");
+  // each line is a block of its own
+  RotatingFileStream file(path + "/run.log",
+                          LogRotationOptions(1 << 20, std::chrono::seconds(0), 0, LogCompression::none, 1));
+  write_lines(file, 0, 10);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto middle = std::chrono::system_clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto second_half = write_lines(file, 10, 10);
+  file.buffer().rotate();
+  file.buffer().wait();
+  std::ostringstream out;
+  EXPECT_EQ(extract_rotated_log(path + "/run.log", middle, std::chrono::system_clock::now(), out),
+            second_half.size());
+  EXPECT_EQ(out.str(), second_half);
+}
+
+GTEST_TEST(RotatingLogging, Configuration)
+{
+  Configuration config;
+  config.set("max_size", 1000);
+  config.set("max_segments", 4);
+  config.set("compression", "gzip");
+  const LogRotationOptions options(config);
+  EXPECT_EQ(options.max_size, 1000u);
+  EXPECT_EQ(options.max_age.count(), 0);
+  EXPECT_EQ(options.max_segments, 4u);
+  EXPECT_EQ(options.compression, LogCompression::gzip);
+  EXPECT_TRUE(options.enabled());
+  EXPECT_FALSE(LogRotationOptions().enabled());
+  config.set("compression", "lzma", true);
+  EXPECT_THROW(LogRotationOptions{config}, Exceptions::configuration_error);
+}
+
+GTEST_TEST(RotatingLogging, Logging)
+{
+  const auto path = directory("logging");
+  Logger().create(LOG_INFO | LOG_FILE, "run", path, "", LogRotationOptions(200));
+  for (size_t ii = 0; ii < 50; ++ii)
+    Logger().info() << "line " << 1000 + ii << std::endl;
+  // closes the rotating file
+  Logger().create(LOG_INFO | LOG_FILE, "other", path, "", LogRotationOptions(200));
+  Logger().create(LOG_CONSOLE | LOG_ERROR);
+  const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+  std::ostringstream filename;
+  filename << path << "/run";
+  if (comm.size() > 1)
+    filename << "_p" << std::setw(8) << std::setfill('0') << comm.rank() << "_";
+  const auto extracted = extract_all(filename.str() + ".log");
+  EXPECT_EQ(extracted.substr(0, 10), "line 1000\n");
+  EXPECT_NE(extracted.find("line 1049\n"), std::string::npos);
+  EXPECT_GE(count_files(path, ".idx"), 2u);
+}
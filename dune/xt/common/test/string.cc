@@ -11,8 +11,17 @@
 
 #include <dune/xt/common/test/main.hxx>
 
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
 #include <vector>
 
+#include <boost/lexical_cast.hpp>
+
 #include <dune/common/fmatrix.hh>
 #include <dune/common/densematrix.hh>
 #include <dune/common/fvector.hh>
@@ -130,6 +139,14 @@ GTEST_TEST(StringTest, ConvertTo)
 
 GTEST_TEST(StringTest, ConvertFrom)
 {
+  EXPECT_EQ(12, from_string<int>(" +12 "));
+  EXPECT_EQ(12, from_string<int>("12abc"));
+  EXPECT_EQ(-0.5, from_string<double>("-.5"));
+  EXPECT_EQ(16., from_string<double>("0x10"));
+  EXPECT_THROW(from_string<double>("1e400"), Exceptions::conversion_error);
+  EXPECT_THROW(from_string<unsigned int>("4294967296"), Exceptions::conversion_error);
+  EXPECT_THROW(from_string<std::vector<double>>("[1 2;3]"), Exceptions::conversion_error);
+  EXPECT_THROW(from_string<std::vector<double>>("[ 1 2]"), Exceptions::conversion_error);
   EXPECT_EQ(9, from_string<int>("9"));
   EXPECT_EQ(0, from_string<int>("0"));
   EXPECT_EQ('p', from_string<char>(to_string('p')));
@@ -148,6 +165,37 @@ GTEST_TEST(StringTest, ConvertFrom)
   EXPECT_EQ(Complex(0, -1), from_string<Complex>("0-1i"));
 }
 
+GTEST_TEST(StringTest, ToChars)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> mantissa(-1., 1.);
+  std::uniform_int_distribution<int> exponent(-300, 300);
+  for (size_t ii = 0; ii < 1000; ++ii) {
+    const double value = std::ldexp(mantissa(generator), exponent(generator));
+    // explicit precisions give the same result as before
+    for (size_t precision : {1, 6, 15, 17, 30}) {
+      std::ostringstream expected;
+      expected << std::setprecision(int(precision)) << value;
+      EXPECT_EQ(to_string(value, precision), expected.str());
+      char buffer[64];
+      const auto end = to_chars(buffer, buffer + sizeof(buffer), value, precision);
+      EXPECT_EQ(std::string(buffer, end), expected.str());
+    }
+    EXPECT_EQ(from_string<double>(to_string(value, shortest_to_string_precision)), value);
+  }
+#if defined(__cpp_lib_to_chars)
+  EXPECT_EQ("0.1", to_string(0.1, shortest_to_string_precision));
+  EXPECT_EQ("0.3333333333333333", to_string(1. / 3., shortest_to_string_precision));
+#endif
+  EXPECT_EQ("[1 2.5 -3]", to_string(std::vector<double>({1., 2.5, -3.})));
+  EXPECT_EQ("[1 2; 3 4]", to_string(FieldMatrix<double, 2, 2>({{1., 2.}, {3., 4.}})));
+  char buffer[10];
+  const auto end = to_chars(buffer, buffer + sizeof(buffer), FieldMatrix<int, 2, 2>({{1, 2}, {3, 4}}));
+  EXPECT_EQ("[1 2; 3 4]", std::string(buffer, end));
+  EXPECT_THROW(to_chars(buffer, buffer + sizeof(buffer), std::vector<int>({10, 20, 30, 40})),
+               Exceptions::conversion_error);
+}
+
 // Hex, whitespacify, tokenize, stringFromTime tests
 GTEST_TEST(StringTest, Hex)
 {
@@ -187,3 +235,41 @@ GTEST_TEST(StringTest, TimeString)
 {
   string ts = stringFromTime(-1);
 }
+
+/** compares from_string for vectors to the previous implementation, which tokenized into strings and converted each
+ *  of them with std::stod (or boost::lexical_cast for types without std::sto*)
+ *  \note disabled by default, run with --gtest_also_run_disabled_tests --gtest_filter='*Benchmark' **/
+GTEST_TEST(StringTest, DISABLED_FromStringBenchmark)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-1e3, 1e3);
+  std::vector<double> expected(100000);
+  std::string str = "[";
+  for (size_t ii = 0; ii < expected.size(); ++ii) {
+    expected[ii] = from_string<double>(to_string(distribution(generator), 15));
+    str += (ii > 0 ? " " : "") + to_string(expected[ii], 15);
+  }
+  str += "]";
+  // the steps of the previous convert_from_string for vectors, with the previous conversion of each token
+  const auto previous = [](const std::string& ss, const auto& convert) {
+    auto vector_str = ss;
+    vector_str = vector_str.substr(1, vector_str.size() - 2);
+    const auto tokens = tokenize<std::string>(vector_str, " ", boost::algorithm::token_compress_on);
+    std::vector<double> ret(tokens.size());
+    for (size_t ii = 0; ii < tokens.size(); ++ii)
+      ret[ii] = convert(internal::trim_copy_safely(tokens[ii]));
+    return ret;
+  };
+  const auto stod = [](std::string token) { return std::stod(token); };
+  const auto lexical_cast = [](std::string token) { return boost::lexical_cast<double, std::string>(token); };
+  const auto measure = [&](const std::string& name, const std::function<std::vector<double>()>& parse) {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto result = parse();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+    std::cout << name << ": " << elapsed.count() << " ms for " << expected.size() << " values" << std::endl;
+    EXPECT_EQ(result, expected);
+  };
+  measure("previous, std::stod", [&]() { return previous(str, stod); });
+  measure("previous, boost::lexical_cast", [&]() { return previous(str, lexical_cast); });
+  measure("from_string", [&]() { return from_string<std::vector<double>>(str); });
+}
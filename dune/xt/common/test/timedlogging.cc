@@ -100,6 +100,33 @@ GTEST_TEST(TimedLogger, fool_level_tracking)
   fool_level_tracking();
 }
 
+GTEST_TEST(TimedLogger, disabled_levels)
+{
+  size_t evaluations = 0;
+  const auto evaluate = [&]() { return ++evaluations; };
+  // warnings were disabled in after_create
+  EXPECT_FALSE(TimedLogger().warn_enabled());
+  DXTC_TIMED_LOG_WARN("disabled_levels") << "this warning should not be visible " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 0u);
+  EXPECT_TRUE(TimedLogger().info_enabled());
+  DXTC_TIMED_LOG_INFO("disabled_levels") << "this info should be visible in blue " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 1u);
+  auto outer = TimedLogger().get("outer");
+  auto inner = TimedLogger().get("inner");
+  const bool expected = TimedLogger().debug_enabled();
+  auto innermost = TimedLogger().get("innermost");
+  EXPECT_EQ(innermost.debug_enabled(), expected);
+  // the max debug level is 1
+  EXPECT_FALSE(innermost.debug_enabled());
+  EXPECT_FALSE(TimedLogger().debug_enabled());
+  DXTC_TIMED_LOG_DEBUG("disabled_levels") << "this debug should not be visible " << evaluate() << std::endl;
+  DXTC_LOG_IF(innermost.debug_enabled(), innermost.debug()) << "this debug should not be visible " << evaluate();
+  EXPECT_EQ(evaluations, 1u);
+  EXPECT_TRUE(innermost.info_enabled());
+  DXTC_LOG_IF(innermost.info_enabled(), innermost.info()) << "this info should be visible " << evaluate() << std::endl;
+  EXPECT_EQ(evaluations, 2u);
+}
+
 int main(int argc, char** argv)
 {
 #if DUNE_XT_COMMON_TEST_MAIN_CATCH_EXCEPTIONS
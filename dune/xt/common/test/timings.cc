@@ -9,8 +9,14 @@
 //   René Fritze     (2012 - 2016, 2018)
 //   Tobias Leibner  (2014, 2016, 2018)
 
+#define DUNE_XT_COMMON_DO_TIMING 1
+
 #include <dune/xt/common/test/main.hxx>
 
+#include <sstream>
+#include <thread>
+#include <vector>
+
 #include <dune/xt/common/filesystem.hh>
 #include <dune/xt/common/math.hh>
 #include <dune/xt/common/ranges.hh>
@@ -78,6 +84,155 @@ GTEST_TEST(ProfilerTest, NestedTiming)
   EXPECT_GT(outer, inner);
 }
 
+//! without TBB, this relies on the thread-safe fallback of PerThreadValue (see EnumerableThreadSpecificWrapper)
+GTEST_TEST(ProfilerTest, PerThreadTiming)
+{
+  auto& prof = DXTC_TIMINGS;
+  prof.reset();
+  const size_t num_threads = 4;
+  const size_t calls = 10;
+  std::vector<std::thread> threads(num_threads);
+  for (auto&& thread : threads)
+    thread = std::thread([]() {
+      for (auto i DUNE_UNUSED : value_range(calls))
+        scoped_busywait("PerThreadTiming.Section", 10);
+    });
+  for (auto&& thread : threads)
+    thread.join();
+  // wall times of all threads are summed up on query
+  EXPECT_GE(prof.walltime("PerThreadTiming.Section"), long(num_threads * calls * 10 * confidence_margin()));
+  prof.output_all_measures(dev_null);
+}
+
+void macro_busywait(size_t ms)
+{
+  DUNE_XT_COMMON_TIMING_SCOPE("ProfilerTest.Macro");
+  busywait(ms);
+}
+
+GTEST_TEST(ProfilerTest, SectionHandle)
+{
+  auto& prof = DXTC_TIMINGS;
+  prof.reset();
+  static const TimingSection section("ProfilerTest.SectionHandle");
+  EXPECT_EQ(section.name(), "ProfilerTest.SectionHandle");
+  EXPECT_EQ(section.id(), prof.section_id("ProfilerTest.SectionHandle"));
+  for (auto i DUNE_UNUSED : value_range(3)) {
+    ScopedTiming scoped_timing(section);
+    busywait(wait_ms);
+  }
+  // handle and name based access share the same data
+  EXPECT_GE(prof.walltime("ProfilerTest.SectionHandle"), long(3 * wait_ms * confidence_margin()));
+  for (auto i DUNE_UNUSED : value_range(3))
+    macro_busywait(wait_ms);
+  EXPECT_GE(prof.walltime("ProfilerTest.Macro"), long(3 * wait_ms * confidence_margin()));
+}
+
+GTEST_TEST(ProfilerTest, CallTree)
+{
+  auto& prof = DXTC_TIMINGS;
+  prof.reset();
+  prof.set_call_tree_mode(true);
+  {
+    ScopedTiming outer("CallTree.Outer");
+    busywait(wait_ms);
+    for (auto i DUNE_UNUSED : value_range(2))
+      scoped_busywait("CallTree.Inner", wait_ms);
+  }
+  // the same section called from another parent is recorded as a different call path
+  scoped_busywait("CallTree.Inner", wait_ms);
+  prof.set_call_tree_mode(false);
+  std::stringstream tree;
+  prof.output_call_tree(tree);
+  std::stringstream collapsed;
+  prof.output_collapsed_stacks(collapsed);
+  if (Dune::MPIHelper::getCollectiveCommunication().rank() == 0) {
+    EXPECT_NE(tree.str().find("CallTree.Outer;CallTree.Inner,2,"), std::string::npos) << tree.str();
+    EXPECT_NE(tree.str().find("\nCallTree.Inner,1,"), std::string::npos) << tree.str();
+    EXPECT_NE(collapsed.str().find("CallTree.Outer;CallTree.Inner "), std::string::npos) << collapsed.str();
+  }
+  // inclusive times of the flat sections are unaffected
+  EXPECT_GE(prof.walltime("CallTree.Inner"), long(3 * wait_ms * confidence_margin()));
+  EXPECT_GE(prof.walltime("CallTree.Outer"), long(3 * wait_ms * confidence_margin()));
+}
+
+GTEST_TEST(ProfilerTest, EventRecording)
+{
+  auto& prof = DXTC_TIMINGS;
+  prof.reset();
+  const size_t capacity = 4;
+  prof.set_event_recording(true, capacity);
+  for (auto i DUNE_UNUSED : value_range(2 * capacity))
+    scoped_busywait("EventRecording.Section", 1);
+  {
+    auto logger = TimedLogger().get("EventRecording.Logger");
+    busywait(1);
+  }
+  prof.set_event_recording(false);
+  std::stringstream trace;
+  prof.output_trace_simple(trace);
+  const auto json = trace.str();
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"EventRecording.Logger\", \"cat\": \"TimedLogger\""), std::string::npos) << json;
+  // the ring buffer only keeps the latest capacity events
+  size_t events = 0;
+  for (auto pos = json.find("\"cat\": \"timings\""); pos != std::string::npos;
+       pos = json.find("\"cat\": \"timings\"", pos + 1))
+    ++events;
+  EXPECT_EQ(events, capacity - 1);
+  prof.output_trace("trace", true);
+}
+
+GTEST_TEST(ProfilerTest, PerfCounters)
+{
+  auto& prof = DXTC_TIMINGS;
+  prof.reset();
+  prof.set_perf_counters(true);
+  for (auto i DUNE_UNUSED : value_range(3))
+    scoped_busywait("PerfCounters.Section", 1);
+  prof.set_perf_counters(false);
+  std::stringstream csv;
+  prof.output_all_measures(csv, Dune::MPIHelper::getCollectiveCommunication());
+  EXPECT_NE(csv.str().find("PerfCounters.Section_ipc"), std::string::npos) << csv.str();
+  // the counters may be unavailable in restricted environments
+  const PerfCounterGroup counters;
+  if (counters.available()) {
+    const auto first = counters.read();
+    busywait(1);
+    const auto second = counters.read();
+    EXPECT_GT(second[0], first[0]);
+    EXPECT_GT(second[1], first[1]);
+  }
+}
+
+GTEST_TEST(ProfilerTest, Histograms)
+{
+  LogLinearHistogram values;
+  for (auto value : value_range(std::uint64_t(100000)))
+    values.add(value);
+  EXPECT_EQ(values.count(), 100000u);
+  EXPECT_EQ(values.min(), 0u);
+  EXPECT_EQ(values.max(), 99999u);
+  const double accuracy = 1. / LogLinearHistogram::sub_bucket_half_count;
+  for (auto percent : {50., 90., 99.})
+    EXPECT_NEAR(values.percentile(percent), percent * 1000, percent * 1000 * accuracy);
+
+  auto& prof = DXTC_TIMINGS;
+  prof.reset();
+  prof.set_histograms(true);
+  for (auto i : value_range(1, 6))
+    scoped_busywait("Histograms.Section", i);
+  prof.set_histograms(false);
+  const auto histogram = prof.histogram("Histograms.Section");
+  EXPECT_EQ(histogram.count(), 5u);
+  EXPECT_LE(histogram.min(), histogram.percentile(50));
+  EXPECT_LE(histogram.percentile(50), histogram.max());
+  EXPECT_GE(histogram.min(), 1000000u);
+  std::stringstream csv;
+  prof.output_all_measures(csv, Dune::MPIHelper::getCollectiveCommunication());
+  EXPECT_NE(csv.str().find("Histograms.Section_call_p99_wall"), std::string::npos) << csv.str();
+}
+
 GTEST_TEST(ProfilerTest, Example)
 {
   timings().reset();
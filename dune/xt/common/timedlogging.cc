@@ -19,10 +19,32 @@
 #include "memory.hh"
 #include "exceptions.hh"
 #include "filesystem.hh"
+#include "timings.hh"
 
 namespace Dune {
 namespace XT {
 namespace Common {
+namespace internal {
+
+
+struct TimedLogTraceScope
+{
+  explicit TimedLogTraceScope(const std::string& id)
+    : section(timings().section_id(id))
+    , begin(TimingData::now(false)[0])
+  {}
+
+  ~TimedLogTraceScope()
+  {
+    timings().record_event(section, "TimedLogger", begin, TimingData::now(false)[0]);
+  }
+
+  const std::size_t section;
+  const TimingData::TimeType begin;
+}; // struct TimedLogTraceScope
+
+
+} // namespace internal
 
 
 TimedLogManager::TimedLogManager(const Timer& timer,
@@ -35,19 +57,23 @@ TimedLogManager::TimedLogManager(const Timer& timer,
                                  std::atomic<ssize_t>& current_level,
                                  std::ostream& disabled_out,
                                  std::ostream& enabled_out,
-                                 std::ostream& warn_out)
+                                 std::ostream& warn_out,
+                                 const std::string trace_id)
   : timer_(timer)
   , current_level_(current_level)
-  , info_(std::make_shared<TimedPrefixedLogStream>(
-        timer_, info_prefix, current_level_ <= max_info_level ? enabled_out : disabled_out))
+  , info_enabled_(current_level_ <= max_info_level)
+  , debug_enabled_(current_level_ <= max_debug_level)
+  , warn_enabled_(enable_warnings)
+  , info_(std::make_shared<TimedPrefixedLogStream>(timer_, info_prefix, info_enabled_ ? enabled_out : disabled_out))
   , debug_(std::make_shared<TimedPrefixedLogStream>(timer_,
                                                     debug_prefix,
 #if DUNE_XT_COMMON_TIMEDLOGGING_ENABLE_DEBUG
-                                                    current_level_ <= max_debug_level ? enabled_out : disabled_out))
+                                                    debug_enabled_ ? enabled_out : disabled_out))
 #else
-                                                    current_level_ <= max_debug_level ? enabled_out : dev_null))
+                                                    debug_enabled_ ? enabled_out : dev_null))
 #endif
-  , warn_(std::make_shared<TimedPrefixedLogStream>(timer_, warning_prefix, enable_warnings ? warn_out : disabled_out))
+  , warn_(std::make_shared<TimedPrefixedLogStream>(timer_, warning_prefix, warn_enabled_ ? warn_out : disabled_out))
+  , trace_scope_(timings().event_recording() ? std::make_shared<internal::TimedLogTraceScope>(trace_id) : nullptr)
 {}
 
 TimedLogManager::~TimedLogManager()
@@ -70,6 +96,21 @@ std::ostream& TimedLogManager::warn()
   return *warn_;
 }
 
+bool TimedLogManager::info_enabled() const
+{
+  return info_enabled_;
+}
+
+bool TimedLogManager::debug_enabled() const
+{
+  return debug_enabled_;
+}
+
+bool TimedLogManager::warn_enabled() const
+{
+  return warn_enabled_;
+}
+
 
 TimedLogging::TimedLogging()
   : max_info_level_(default_max_info_level)
@@ -121,7 +162,27 @@ TimedLogManager TimedLogging::get(const std::string id)
                          max_info_level_,
                          max_debug_level_,
                          enable_warnings_,
-                         current_level_);
+                         current_level_,
+                         dev_null,
+                         std::cout,
+                         std::cerr,
+                         id.empty() ? "TimedLogManager" : id);
+}
+
+// get() increases the level before creating the TimedLogManager
+bool TimedLogging::info_enabled() const
+{
+  return current_level_.load(std::memory_order_relaxed) + 1 <= max_info_level_;
+}
+
+bool TimedLogging::debug_enabled() const
+{
+  return current_level_.load(std::memory_order_relaxed) + 1 <= max_debug_level_;
+}
+
+bool TimedLogging::warn_enabled() const
+{
+  return enable_warnings_;
 }
 
 void TimedLogging::update_colors()
@@ -42,6 +42,14 @@
 namespace Dune {
 namespace XT {
 namespace Common {
+namespace internal {
+
+
+//! records the lifetime of a TimedLogManager (including all its copies) as an event, see Timings::set_event_recording
+struct TimedLogTraceScope;
+
+
+} // namespace internal
 
 
 /**
@@ -62,7 +70,8 @@ public:
                   std::atomic<ssize_t>& current_level,
                   std::ostream& disabled_out = dev_null,
                   std::ostream& enabled_out = std::cout,
-                  std::ostream& warn_out = std::cerr);
+                  std::ostream& warn_out = std::cerr,
+                  const std::string trace_id = "TimedLogManager");
 
   ~TimedLogManager();
 
@@ -72,12 +81,23 @@ public:
 
   std::ostream& warn();
 
+  //! whether info() writes to enabled_out, see DXTC_LOG_IF
+  bool info_enabled() const;
+
+  bool debug_enabled() const;
+
+  bool warn_enabled() const;
+
 private:
   const Timer& timer_;
   std::atomic<ssize_t>& current_level_;
+  const bool info_enabled_;
+  const bool debug_enabled_;
+  const bool warn_enabled_;
   std::shared_ptr<std::ostream> info_;
   std::shared_ptr<std::ostream> debug_;
   std::shared_ptr<std::ostream> warn_;
+  std::shared_ptr<internal::TimedLogTraceScope> trace_scope_;
 }; // class TimedLogManager
 
 
@@ -127,6 +147,13 @@ public:
 
   TimedLogManager get(const std::string id);
 
+  //! whether the info() stream of a TimedLogManager obtained by get() now would be enabled, see DXTC_TIMED_LOG_INFO
+  bool info_enabled() const;
+
+  bool debug_enabled() const;
+
+  bool warn_enabled() const;
+
 private:
   void update_colors();
 
@@ -228,9 +255,15 @@ int main()
   logger.info() << "<- The 'main' prefix left of this should be blue!" << std::endl;
   logger.warn() << "<- The 'warn' prefix left of this should be red!"  << std::endl;
 }
+\endcode
+ *          To not even evaluate the output of disabled streams, use DXTC_TIMED_LOG_INFO and friends instead of get():
+\code
+for (const auto& element : elements(grid_view))
+  DXTC_TIMED_LOG_DEBUG("assembler") << "element " << compute_index(element) << std::endl;
 \endcode
  * \note Debug logging is only enabled if DUNE_XT_COMMON_TIMEDLOGGING_ENABLE_DEBUG is true (which is by default the case
- *       if NDEBUG is not defined) but you might still want to guard calls to logger.debug() for performance reasons.
+ *       if NDEBUG is not defined) but you might still want to guard calls to logger.debug() for performance reasons,
+ *       e.g. via DXTC_LOG_IF(logger.debug_enabled(), logger.debug()).
  */
 DUNE_EXPORT inline TimedLogging& TimedLogger()
 {
@@ -359,4 +392,22 @@ private:
 } // namespace XT
 } // namespace Dune
 
+/**
+ * \brief Writes to the respective stream of TimedLogger().get(id) only if it is enabled, nothing written to the stream
+ *        is evaluated (and no TimedLogManager is created) otherwise.
+ *
+ *        Debug output is removed at compile time unless DUNE_XT_COMMON_TIMEDLOGGING_ENABLE_DEBUG is true, all output
+ *        below DUNE_XT_COMMON_LOGGING_MIN_LEVEL is removed at compile time (warnings count as level 2).
+ */
+#define DXTC_TIMED_LOG_DEBUG(id)                                                                                       \
+  DXTC_LOG_IF(DUNE_XT_COMMON_TIMEDLOGGING_ENABLE_DEBUG && DUNE_XT_COMMON_LOGGING_MIN_LEVEL <= 0                        \
+                  && Dune::XT::Common::TimedLogger().debug_enabled(),                                                  \
+              Dune::XT::Common::TimedLogger().get(id).debug())
+#define DXTC_TIMED_LOG_INFO(id)                                                                                        \
+  DXTC_LOG_IF(DUNE_XT_COMMON_LOGGING_MIN_LEVEL <= 1 && Dune::XT::Common::TimedLogger().info_enabled(),                 \
+              Dune::XT::Common::TimedLogger().get(id).info())
+#define DXTC_TIMED_LOG_WARN(id)                                                                                        \
+  DXTC_LOG_IF(DUNE_XT_COMMON_LOGGING_MIN_LEVEL <= 2 && Dune::XT::Common::TimedLogger().warn_enabled(),                 \
+              Dune::XT::Common::TimedLogger().get(id).warn())
+
 #endif // DUNE_XT_COMMON_TIMED_LOGGING_HH
@@ -17,13 +17,13 @@
 
 #if HAVE_LIKWID && ENABLE_PERFMON
 #  include <likwid.h>
-#  define DXTC_LIKWID_BEGIN_SECTION(name) LIKWID_MARKER_START(name.c_str());
-#  define DXTC_LIKWID_END_SECTION(name) LIKWID_MARKER_STOP(name.c_str());
+#  define DXTC_LIKWID_BEGIN_SECTION(name) LIKWID_MARKER_START(name);
+#  define DXTC_LIKWID_END_SECTION(name) LIKWID_MARKER_STOP(name);
 #  define DXTC_LIKWID_INIT LIKWID_MARKER_INIT
 #  define DXTC_LIKWID_CLOSE LIKWID_MARKER_CLOSE
 #else
-#  define DXTC_LIKWID_BEGIN_SECTION(name)
-#  define DXTC_LIKWID_END_SECTION(name)
+#  define DXTC_LIKWID_BEGIN_SECTION(name) static_cast<void>(name);
+#  define DXTC_LIKWID_END_SECTION(name) static_cast<void>(name);
 #  define DXTC_LIKWID_INIT
 #  define DXTC_LIKWID_CLOSE
 #endif
@@ -36,10 +36,19 @@
 #include <dune/xt/common/logging.hh>
 #include <dune/xt/common/parallel/threadmanager.hh>
 #include <dune/xt/common/parallel/threadstorage.hh>
+#include <dune/xt/common/reproducible_sum.hh>
 
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <limits>
 #include <map>
+#include <set>
 #include <string>
 
+#include <sys/resource.h>
+#include <time.h>
+
 #include <dune/xt/common/disable_warnings.hh>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
@@ -50,30 +59,198 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/config.hpp>
 #include <boost/timer/timer.hpp>
+#include <boost/numeric/conversion/cast.hpp>
 #include <dune/xt/common/reenable_warnings.hh>
 
 namespace Dune {
 namespace XT {
 namespace Common {
+namespace {
 
-TimingData::TimingData(std::string _name)
-  : timer_(new boost::timer::cpu_timer)
-  , name(_name)
+
+//! concatenation of local of all ranks of comm on rank 0, empty on all other ranks
+std::string gather_on_rank_0(const std::string& local, const CollectiveCommunication<MPIHelper::MPICommunicator>& comm)
 {
-  timer_->start();
+  std::vector<char> send_buffer(local.begin(), local.end());
+  send_buffer.push_back('\0');
+  int send_length = boost::numeric_cast<int>(local.size());
+  std::vector<int> lengths(comm.size(), 0);
+  comm.gather(&send_length, lengths.data(), 1, 0);
+  std::vector<int> displacements(comm.size(), 0);
+  for (auto ii : value_range(1, comm.size()))
+    displacements[ii] = displacements[ii - 1] + lengths[ii - 1];
+  std::vector<char> gathered(displacements.back() + lengths.back() + 1, '\0');
+  comm.gatherv(send_buffer.data(), send_length, gathered.data(), lengths.data(), displacements.data(), 0);
+  if (comm.rank() != 0)
+    return std::string();
+  return std::string(gathered.begin(), gathered.end() - 1);
 }
 
+//! sums the bucket counts over all ranks of comm
+LogLinearHistogram reduced_histogram(const std::shared_ptr<LogLinearHistogram>& local,
+                                     const CollectiveCommunication<MPIHelper::MPICommunicator>& comm)
+{
+  const LogLinearHistogram empty;
+  const auto& histogram = local ? *local : empty;
+  // counts are exact in double up to 2^53
+  std::vector<double> counts(histogram.counts().begin(), histogram.counts().end());
+  comm.sum(counts.data(), boost::numeric_cast<int>(counts.size()));
+  double min = static_cast<double>(histogram.min());
+  double max = static_cast<double>(histogram.max());
+  min = comm.min(min);
+  max = comm.max(max);
+  LogLinearHistogram::CountsType reduced_counts;
+  for (auto ii : value_range(counts.size()))
+    reduced_counts[ii] = static_cast<std::uint64_t>(counts[ii]);
+  const bool empty_range = min > max;
+  return LogLinearHistogram(reduced_counts,
+                            empty_range ? std::numeric_limits<std::uint64_t>::max() : static_cast<std::uint64_t>(min),
+                            empty_range ? 0 : static_cast<std::uint64_t>(max));
+} // ... reduced_histogram(...)
+
+std::string json_escaped(const std::string& str)
+{
+  std::string ret;
+  for (const char& c : str) {
+    if (c == '"' || c == '\\')
+      ret += std::string("\\") + c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      ret += (boost::format("\\u%04x") % int(c)).str();
+    else
+      ret += c;
+  }
+  return ret;
+}
+
+
+} // namespace
+
+TimingData::TimingData(std::string _name)
+  : name(_name)
+  , start_(now())
+  , stop_(start_)
+  , running_(true)
+{}
+
 void TimingData::stop()
 {
-  timer_->stop();
+  if (running_)
+    stop_ = now();
+  running_ = false;
 }
 
 TimingData::DeltaType TimingData::delta() const
+{
+  const auto end = running_ ? now() : stop_;
+  return to_milliseconds({{end[0] - start_[0], end[1] - start_[1], end[2] - start_[2]}});
+}
+
+TimingData::DeltaType TimingData::now(bool with_cpu_times)
+{
+  struct timespec wall;
+  clock_gettime(CLOCK_MONOTONIC, &wall);
+  if (!with_cpu_times)
+    return {{TimeType(wall.tv_sec) * 1000000000 + TimeType(wall.tv_nsec), 0, 0}};
+  struct rusage usage;
+#ifdef RUSAGE_THREAD
+  getrusage(RUSAGE_THREAD, &usage);
+#else
+  getrusage(RUSAGE_SELF, &usage);
+#endif
+  const auto nano = [](const struct timeval& tv) {
+    return TimeType(tv.tv_sec) * 1000000000 + TimeType(tv.tv_usec) * 1000;
+  };
+  return {{TimeType(wall.tv_sec) * 1000000000 + TimeType(wall.tv_nsec), nano(usage.ru_utime), nano(usage.ru_stime)}};
+}
+
+TimingData::DeltaType TimingData::to_milliseconds(const DeltaType& nanoseconds)
 {
   const auto scale = 1.0 / double(boost::timer::nanosecond_type(1e6));
-  const auto elapsed = timer_->elapsed();
-  const auto cast = [=](double var) { return static_cast<typename TimingData::DeltaType::value_type>(var); };
-  return {{cast(elapsed.wall * scale), cast(elapsed.user * scale), cast(elapsed.system * scale)}};
+  const auto cast = [=](TimeType var) { return static_cast<TimeType>(var * scale); };
+  return {{cast(nanoseconds[0]), cast(nanoseconds[1]), cast(nanoseconds[2])}};
+}
+
+TimingSection::TimingSection(const std::string& section_name)
+{
+  const auto& interned = timings().intern(section_name);
+  id_ = interned.id;
+  name_ = interned.name;
+}
+
+const std::string& TimingSection::name() const
+{
+  return timings().section_name(id_);
+}
+
+std::size_t Timings::section_id(const std::string& section_name)
+{
+  return intern(section_name).id;
+}
+
+const internal::InternedSection& Timings::intern(const std::string& section_name)
+{
+  auto& ids = local_data().ids;
+  const auto cached = ids.find(section_name);
+  if (cached != ids.end())
+    return cached->second;
+  internal::InternedSection section;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto known = section_ids_.find(section_name);
+    if (known != section_ids_.end())
+      section.id = known->second;
+    else {
+      section.id = section_names_.size();
+      section_names_.push_back(section_name);
+      section_ids_.emplace(section_name, section.id);
+    }
+    // elements of a deque do not move on push_back
+    section.name = section_names_[section.id].c_str();
+  }
+  return ids.emplace(section_name, section).first->second;
+} // ... intern(...)
+
+const std::string& Timings::section_name(std::size_t id) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (id >= section_names_.size())
+    DUNE_THROW(Dune::RangeError, "no timing section with id " << id << " was registered\n");
+  return section_names_[id];
+}
+
+bool Timings::find_section_id(const std::string& section_name, std::size_t& id) const
+{
+  const auto& ids = local_data().ids;
+  const auto cached = ids.find(section_name);
+  if (cached != ids.end()) {
+    id = cached->second.id;
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto known = section_ids_.find(section_name);
+  if (known == section_ids_.end())
+    return false;
+  id = known->second;
+  return true;
+}
+
+internal::TimingThreadData& Timings::local_data() const
+{
+  // timings() is a singleton and the per-thread data never moves, so the pointer stays valid for the thread's lifetime
+  static thread_local internal::TimingThreadData* data = nullptr;
+  if (data == nullptr) {
+    data = &*thread_data_;
+    data->index = thread_count_++;
+  }
+  return *data;
+}
+
+internal::TimingSlot& Timings::local_slot(std::size_t id)
+{
+  auto& slots = local_data().slots;
+  if (id >= slots.size())
+    slots.resize(id + 1);
+  return slots[id];
 }
 
 void Timings::reset(std::string section_name)
@@ -83,45 +260,156 @@ void Timings::reset(std::string section_name)
   } catch (Dune::RangeError&) {
     // ok, timer simply wasn't running
   }
-  commited_deltas_[section_name] = {{0, 0, 0}};
+  std::size_t id;
+  if (!find_section_id(section_name, id))
+    return;
+  for (auto&& data : thread_data_) {
+    if (id < data.slots.size()) {
+      data.slots[id].calls = 0;
+      data.slots[id].accumulated = {{0, 0, 0}};
+      data.slots[id].counted_calls = 0;
+      data.slots[id].counters = {};
+    }
+    for (auto&& node : data.tree) {
+      if (node.section == id) {
+        node.calls = 0;
+        node.inclusive = {{0, 0, 0}};
+      }
+    }
+  }
 }
 
 void Timings::start(std::string section_name)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  const KnownTimersMap::iterator section = known_timers_map_.find(section_name);
-  if (section != known_timers_map_.end()) {
-    if (section->second.first) // timer currently running
-      return;
-    section->second.first = true; // set active, start with new
-    section->second.second = TimingData(section_name);
-  } else {
-    // init new section
-    known_timers_map_[section_name] = std::make_pair(true, TimingData(section_name));
-  }
-  DXTC_LIKWID_BEGIN_SECTION(section_name)
+  start(TimingSection(section_name));
 } // StartTiming
 
+void Timings::start(const TimingSection& section)
+{
+  auto& slot = local_slot(section.id());
+  if (slot.running) // timer currently running
+    return;
+  slot.running = true;
+  DXTC_LIKWID_BEGIN_SECTION(section.name_)
+  slot.counting = perf_counters_.load(std::memory_order_relaxed);
+  if (slot.counting) {
+    auto& data = local_data();
+    if (!data.counters)
+      data.counters = std::make_shared<PerfCounterGroup>(raw_flop_events_);
+    slot.counters_start = data.counters->read();
+  }
+  if (!slot.histogram && histograms_.load(std::memory_order_relaxed))
+    slot.histogram = std::make_shared<LogLinearHistogram>();
+  slot.start = TimingData::now(measure_cpu_times_.load(std::memory_order_relaxed));
+  if (call_tree_mode_.load(std::memory_order_relaxed))
+    push_tree_node(local_data(), section.id(), slot.start);
+}
+
 long Timings::stop(std::string section_name)
 {
-  DXTC_LIKWID_END_SECTION(section_name)
-  if (known_timers_map_.find(section_name) == known_timers_map_.end())
+  const auto stamp = TimingData::now(measure_cpu_times_.load(std::memory_order_relaxed));
+  std::size_t id;
+  if (!find_section_id(section_name, id))
     DUNE_THROW(Dune::RangeError, "trying to stop timer " << section_name << " that wasn't started\n");
-
-  known_timers_map_[section_name].first = false; // marks as not running
-  TimingData& timing = *(known_timers_map_[section_name].second);
-  timing.stop();
-  const auto dlt = timing.delta();
-  if (commited_deltas_.find(section_name) == commited_deltas_.end())
-    commited_deltas_[section_name] = dlt;
-  else {
-    for (auto i : value_range(dlt.size()))
-      commited_deltas_[section_name][i] += dlt[i];
-  }
-  return dlt[0];
+  return stop_section(id, section_name.c_str(), stamp);
 } // StopTiming
 
+long Timings::stop(const TimingSection& section)
+{
+  return stop_section(
+      section.id(), section.name_, TimingData::now(measure_cpu_times_.load(std::memory_order_relaxed)));
+}
+
+long Timings::stop_section(std::size_t id, const char* name, const TimingData::DeltaType& stamp)
+{
+  auto& slot = local_slot(id);
+  if (!slot.running)
+    return 0;
+  DXTC_LIKWID_END_SECTION(name)
+  slot.running = false;
+  TimingData::DeltaType dlt;
+  for (std::size_t i = 0; i < dlt.size(); ++i) {
+    dlt[i] = stamp[i] - slot.start[i];
+    slot.accumulated[i] += dlt[i];
+  }
+  ++slot.calls;
+  if (slot.histogram && histograms_.load(std::memory_order_relaxed))
+    slot.histogram->add(static_cast<std::uint64_t>(dlt[0]));
+  auto& data = local_data();
+  if (slot.counting && data.counters) {
+    const auto counters = data.counters->read();
+    for (std::size_t i = 0; i < counters.size(); ++i)
+      slot.counters[i] += counters[i] - slot.counters_start[i];
+    ++slot.counted_calls;
+  }
+  if (!data.stack.empty())
+    pop_tree_node(data, id, stamp);
+  if (event_recording_.load(std::memory_order_relaxed))
+    record_event(id, "timings", slot.start[0], stamp[0]);
+  return TimingData::to_milliseconds(dlt)[0];
+}
+
+void Timings::record_event(std::size_t id, const char* category, TimingData::TimeType begin, TimingData::TimeType end)
+{
+  if (!event_recording_.load(std::memory_order_relaxed))
+    return;
+  auto& data = local_data();
+  const std::size_t capacity = event_capacity_.load(std::memory_order_relaxed);
+  if (data.events.size() != capacity) {
+    data.events.resize(capacity);
+    data.events.shrink_to_fit();
+    data.recorded_events = 0;
+  }
+  if (capacity == 0)
+    return;
+  auto& event = data.events[data.recorded_events++ % capacity];
+  event.section = id;
+  event.category = category;
+  event.begin = begin;
+  event.end = end;
+}
+
+void Timings::push_tree_node(internal::TimingThreadData& data, std::size_t id, const TimingData::DeltaType& stamp)
+{
+  auto& tree = data.tree;
+  if (tree.empty())
+    tree.emplace_back();
+  const std::size_t parent = data.stack.empty() ? 0 : data.stack.back();
+  std::size_t node = internal::TimingTreeNode::root;
+  for (const auto& child : tree[parent].children) {
+    if (child.first == id) {
+      node = child.second;
+      break;
+    }
+  }
+  if (node == internal::TimingTreeNode::root) {
+    node = tree.size();
+    tree.emplace_back(id, parent);
+    tree[parent].children.emplace_back(id, node);
+  }
+  tree[node].start = stamp;
+  data.stack.push_back(node);
+}
+
+void Timings::pop_tree_node(internal::TimingThreadData& data, std::size_t id, const TimingData::DeltaType& stamp)
+{
+  auto& stack = data.stack;
+  auto& tree = data.tree;
+  std::size_t pos = stack.size();
+  while (pos > 0 && tree[stack[pos - 1]].section != id)
+    --pos;
+  if (pos == 0)
+    return;
+  // a section stopped out of order also ends the call paths of all sections started after it
+  while (stack.size() >= pos) {
+    auto& node = tree[stack.back()];
+    for (std::size_t i = 0; i < stamp.size(); ++i)
+      node.inclusive[i] += stamp[i] - node.start[i];
+    ++node.calls;
+    stack.pop_back();
+  }
+}
+
 TimingData::TimeType Timings::walltime(std::string section_name) const
 {
   return delta(section_name)[0];
@@ -129,23 +417,96 @@ TimingData::TimeType Timings::walltime(std::string section_name) const
 
 TimingData::DeltaType Timings::delta(std::string section_name) const
 {
-  DeltaMap::const_iterator section = commited_deltas_.find(section_name);
-  if (section == commited_deltas_.end()) {
-    // timer might still be running
-    const auto& timer_it = known_timers_map_.find(section_name);
-    if (timer_it == known_timers_map_.end())
-      DUNE_THROW(Dune::InvalidStateException, "no timer found: " + section_name);
-    return timer_it->second.second->delta();
+  std::size_t id;
+  if (!find_section_id(section_name, id))
+    DUNE_THROW(Dune::InvalidStateException, "no timer found: " + section_name);
+  TimingData::DeltaType committed = {{0, 0, 0}};
+  bool was_committed = false;
+  for (const auto& data : thread_data_) {
+    if (id < data.slots.size() && data.slots[id].calls > 0) {
+      was_committed = true;
+      for (auto i : value_range(committed.size()))
+        committed[i] += data.slots[id].accumulated[i];
+    }
+  }
+  if (was_committed)
+    return TimingData::to_milliseconds(committed);
+  // timer might still be running
+  const auto& slots = local_data().slots;
+  if (id < slots.size() && slots[id].running) {
+    const auto stamp = TimingData::now(measure_cpu_times_);
+    return TimingData::to_milliseconds(
+        {{stamp[0] - slots[id].start[0], stamp[1] - slots[id].start[1], stamp[2] - slots[id].start[2]}});
+  }
+  return committed;
+}
+
+LogLinearHistogram Timings::histogram(std::string section_name) const
+{
+  std::size_t id;
+  if (!find_section_id(section_name, id))
+    DUNE_THROW(Dune::InvalidStateException, "no timer found: " + section_name);
+  LogLinearHistogram merged;
+  for (const auto& data : thread_data_)
+    if (id < data.slots.size() && data.slots[id].histogram)
+      merged.merge(*data.slots[id].histogram);
+  return merged;
+}
+
+Timings::SummaryMap Timings::merged_sections() const
+{
+  SummaryMap sections;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& data : thread_data_) {
+    for (auto id : value_range(data.slots.size())) {
+      const auto& slot = data.slots[id];
+      if (slot.calls == 0)
+        continue;
+      auto& section = sections[section_names_[id]];
+      section.calls += slot.calls;
+      for (auto i : value_range(section.delta.size()))
+        section.delta[i] += slot.accumulated[i];
+      section.counted_calls += slot.counted_calls;
+      for (auto i : value_range(section.counters.size()))
+        section.counters[i] += slot.counters[i];
+      if (slot.histogram) {
+        if (!section.histogram)
+          section.histogram = std::make_shared<LogLinearHistogram>();
+        section.histogram->merge(*slot.histogram);
+      }
+    }
   }
-  return section->second;
+  for (auto&& section : sections)
+    section.second.delta = TimingData::to_milliseconds(section.second.delta);
+  return sections;
 }
 
 void Timings::stop()
 {
-  for (auto&& section : known_timers_map_) {
-    try {
-      stop(section.first);
-    } catch (Dune::RangeError&) {
+  // sections running in other threads can only be stopped with respect to their wall time
+  const auto stamp = TimingData::now(measure_cpu_times_);
+  const auto& own_slots = local_data().slots;
+  for (auto&& data : thread_data_) {
+    const bool own = &data.slots == &own_slots;
+    for (auto&& slot : data.slots) {
+      if (!slot.running)
+        continue;
+      slot.running = false;
+      slot.accumulated[0] += stamp[0] - slot.start[0];
+      if (own) {
+        slot.accumulated[1] += stamp[1] - slot.start[1];
+        slot.accumulated[2] += stamp[2] - slot.start[2];
+      }
+      ++slot.calls;
+    }
+    for (; !data.stack.empty(); data.stack.pop_back()) {
+      auto& node = data.tree[data.stack.back()];
+      node.inclusive[0] += stamp[0] - node.start[0];
+      if (own) {
+        node.inclusive[1] += stamp[1] - node.start[1];
+        node.inclusive[2] += stamp[2] - node.start[2];
+      }
+      ++node.calls;
     }
   }
 } // GetTiming
@@ -153,15 +514,155 @@ void Timings::stop()
 void Timings::reset()
 {
   stop();
-  commited_deltas_.clear();
+  for (auto&& data : thread_data_) {
+    for (auto&& slot : data.slots)
+      slot = internal::TimingSlot();
+    data.tree.clear();
+    data.recorded_events = 0;
+  }
 } // Reset
 
+Timings::CallTreeMap Timings::merged_call_tree() const
+{
+  CallTreeMap merged;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& data : thread_data_) {
+    const auto& tree = data.tree;
+    std::vector<std::string> paths(tree.size());
+    std::vector<TimingData::DeltaType> exclusive(tree.size());
+    for (std::size_t ii = 1; ii < tree.size(); ++ii) {
+      auto name = section_names_[tree[ii].section];
+      std::replace(name.begin(), name.end(), ';', '_');
+      paths[ii] = (tree[ii].parent == 0) ? name : paths[tree[ii].parent] + ";" + name;
+      exclusive[ii] = tree[ii].inclusive;
+    }
+    // parents are always created before their children
+    for (std::size_t ii = 1; ii < tree.size(); ++ii) {
+      const auto parent = tree[ii].parent;
+      if (parent != 0 && tree[parent].calls > 0)
+        for (auto i : value_range(exclusive[parent].size()))
+          exclusive[parent][i] -= tree[ii].inclusive[i];
+    }
+    for (std::size_t ii = 1; ii < tree.size(); ++ii) {
+      if (tree[ii].calls == 0)
+        continue;
+      auto& entry = merged[paths[ii]];
+      entry.calls += tree[ii].calls;
+      for (auto i : value_range(entry.inclusive.size())) {
+        entry.inclusive[i] += tree[ii].inclusive[i];
+        entry.exclusive[i] += exclusive[ii][i];
+      }
+    }
+  }
+  return merged;
+} // ... merged_call_tree(...)
+
+std::vector<std::pair<std::string, std::vector<double>>>
+Timings::reduced_call_tree(MPIHelper::MPICommunicator mpi_comm) const
+{
+  CollectiveCommunication<MPIHelper::MPICommunicator> comm(mpi_comm);
+  const auto local = merged_call_tree();
+  // call paths may differ between ranks, so the union of all paths is formed on rank 0 and broadcast from there
+  std::string local_keys;
+  for (const auto& entry : local)
+    local_keys += entry.first + "\n";
+  const auto all_keys = gather_on_rank_0(local_keys, comm);
+  std::string union_keys;
+  if (comm.rank() == 0) {
+    std::set<std::string> paths;
+    for (auto&& path : tokenize(all_keys, "\n"))
+      if (!path.empty())
+        paths.insert(path);
+    for (const auto& path : paths)
+      union_keys += path + "\n";
+  }
+  int union_length = boost::numeric_cast<int>(union_keys.size());
+  comm.broadcast(&union_length, 1, 0);
+  std::vector<char> union_buffer(union_keys.begin(), union_keys.end());
+  union_buffer.resize(union_length + 1, '\0');
+  comm.broadcast(union_buffer.data(), union_length, 0);
+
+  std::vector<std::pair<std::string, std::vector<double>>> reduced;
+  for (auto&& path : tokenize(std::string(union_buffer.begin(), union_buffer.end() - 1), "\n"))
+    if (!path.empty())
+      reduced.emplace_back(path, std::vector<double>(14, 0.));
+  // calls, inclusive and exclusive times for each path: first the sums, then the maxima
+  std::vector<double> values(7 * reduced.size(), 0.);
+  for (auto ii : value_range(reduced.size())) {
+    const auto entry = local.find(reduced[ii].first);
+    if (entry == local.end())
+      continue;
+    values[7 * ii] = entry->second.calls;
+    for (auto i : value_range(3)) {
+      values[7 * ii + 1 + i] = entry->second.inclusive[i];
+      values[7 * ii + 4 + i] = entry->second.exclusive[i];
+    }
+  }
+  auto sums = values;
+  auto maxima = values;
+  if (!values.empty()) {
+    comm.sum(sums.data(), boost::numeric_cast<int>(sums.size()));
+    comm.max(maxima.data(), boost::numeric_cast<int>(maxima.size()));
+  }
+  for (auto ii : value_range(reduced.size())) {
+    for (auto i : value_range(7)) {
+      reduced[ii].second[i] = sums[7 * ii + i];
+      reduced[ii].second[7 + i] = maxima[7 * ii + i];
+    }
+  }
+  return reduced;
+} // ... reduced_call_tree(...)
+
 void Timings::set_outputdir(std::string dir)
 {
   output_dir_ = dir;
   test_create_directory(output_dir_);
 }
 
+void Timings::set_measure_cpu_times(bool value)
+{
+  measure_cpu_times_ = value;
+}
+
+void Timings::set_call_tree_mode(bool value)
+{
+  call_tree_mode_ = value;
+}
+
+void Timings::set_event_recording(bool value, const std::size_t capacity)
+{
+  if (value && !event_recording_)
+    event_epoch_ = TimingData::now(false)[0];
+  event_capacity_ = capacity;
+  event_recording_ = value;
+}
+
+bool Timings::event_recording() const
+{
+  return event_recording_;
+}
+
+void Timings::set_perf_counters(bool value, const PerfCounterGroup::FlopEventsType& raw_flop_events)
+{
+  raw_flop_events_ = raw_flop_events;
+  perf_counters_ = value;
+}
+
+bool Timings::perf_counters() const
+{
+  return perf_counters_;
+}
+
+void Timings::set_histograms(bool value)
+{
+  histograms_ = value;
+}
+
+bool Timings::histograms() const
+{
+  return histograms_;
+}
+
 void Timings::output_per_rank(std::string csv_base) const
 {
   const auto rank = MPIHelper::getCollectiveCommunication().rank();
@@ -176,15 +677,82 @@ void Timings::output_per_rank(std::string csv_base) const
     boost::filesystem::ofstream a_out(a_filename);
     a_out << tmp_out.str() << std::endl;
   }
+  if (!call_tree_mode_)
+    return;
+  boost::filesystem::ofstream tree_out(dir / (boost::format("%s_tree_p%08d.csv") % csv_base % rank).str());
+  output_call_tree(tree_out, MPIHelper::getLocalCommunicator());
+  std::stringstream tmp_tree_out;
+  output_call_tree(tmp_tree_out, MPIHelper::getCommunicator());
+  std::stringstream tmp_collapsed_out;
+  output_collapsed_stacks(tmp_collapsed_out, MPIHelper::getCommunicator());
+  if (rank == 0) {
+    boost::filesystem::ofstream a_tree_out(dir / (boost::format("%s_tree.csv") % csv_base).str());
+    a_tree_out << tmp_tree_out.str();
+    boost::filesystem::ofstream a_collapsed_out(dir / (boost::format("%s.collapsed") % csv_base).str());
+    a_collapsed_out << tmp_collapsed_out.str();
+  }
+}
+
+std::string Timings::trace_events(int rank) const
+{
+  std::stringstream events;
+  const TimingData::TimeType epoch = event_epoch_;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::string sep = ",\n";
+  events << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank << ", \"args\": {\"name\": \"rank "
+         << rank << "\"}}";
+  events << std::fixed << std::setprecision(3);
+  for (const auto& data : thread_data_) {
+    const auto capacity = data.events.size();
+    if (capacity == 0 || data.recorded_events == 0)
+      continue;
+    // oldest first
+    const auto count = std::min(capacity, data.recorded_events);
+    const auto first = data.recorded_events - count;
+    for (auto ii : value_range(first, data.recorded_events)) {
+      const auto& event = data.events[ii % capacity];
+      events << sep << "{\"name\": \"" << json_escaped(section_names_[event.section]) << "\", \"cat\": \""
+             << event.category << "\", \"ph\": \"X\", \"ts\": " << (event.begin - epoch) * 1e-3
+             << ", \"dur\": " << (event.end - event.begin) * 1e-3 << ", \"pid\": " << rank
+             << ", \"tid\": " << data.index << "}";
+    }
+    if (data.recorded_events > capacity)
+      events << sep << "{\"name\": \"dropped_events\", \"ph\": \"C\", \"ts\": 0, \"pid\": " << rank
+             << ", \"tid\": " << data.index << ", \"args\": {\"dropped\": " << data.recorded_events - capacity << "}}";
+  }
+  return events.str();
+} // ... trace_events(...)
+
+void Timings::output_trace(std::string json_base, const bool merge_on_rank_0) const
+{
+  const auto comm = MPIHelper::getCollectiveCommunication();
+  boost::filesystem::path dir(output_dir_);
+  if (!merge_on_rank_0) {
+    boost::filesystem::ofstream out(dir / (boost::format("%s_p%08d.json") % json_base % comm.rank()).str());
+    output_trace_simple(out);
+    return;
+  }
+  const auto events = gather_on_rank_0(trace_events(comm.rank()) + ",\n", comm);
+  if (comm.rank() == 0) {
+    boost::filesystem::ofstream out(dir / (boost::format("%s.json") % json_base).str());
+    out << "{\"traceEvents\": [\n" << events.substr(0, events.size() - 2) << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  }
+} // ... output_trace(...)
+
+void Timings::output_trace_simple(std::ostream& out) const
+{
+  const auto rank = MPIHelper::getCollectiveCommunication().rank();
+  out << "{\"traceEvents\": [\n" << trace_events(rank) << "\n], \"displayTimeUnit\": \"ms\"}\n";
 }
 
 void Timings::output_simple(std::ostream& out) const
 {
-  for (const auto& section : commited_deltas_) {
+  const auto sections = merged_sections();
+  for (const auto& section : sections) {
     out << csv_sep_ << section.first;
   }
-  for (const auto& section : commited_deltas_) {
-    out << csv_sep_ << section.second[0];
+  for (const auto& section : sections) {
+    out << csv_sep_ << section.second.delta[0];
     ;
   }
   out << std::endl;
@@ -194,18 +762,35 @@ void Timings::output_all_measures(std::ostream& out, MPIHelper::MPICommunicator
 {
   CollectiveCommunication<MPIHelper::MPICommunicator> comm(mpi_comm);
   std::stringstream stash;
+  const auto sections = merged_sections();
+  // the columns depend on the recorded data of all ranks, not on the current modes
+  int counted = 0;
+  int recorded = 0;
+  for (const auto& section : sections) {
+    counted |= (section.second.counted_calls > 0);
+    recorded |= (section.second.histogram != nullptr);
+  }
+  const bool with_counters = comm.max(counted) > 0;
+  const bool with_histograms = comm.max(recorded) > 0;
 
   stash << "threads" << csv_sep_ << "ranks";
-  for (const auto& section : commited_deltas_) {
+  for (const auto& section : sections) {
     stash << csv_sep_ << section.first << "_avg_usr" << csv_sep_ << section.first << "_max_usr" << csv_sep_
           << section.first << "_avg_wall" << csv_sep_ << section.first << "_max_wall" << csv_sep_ << section.first
           << "_avg_sys" << csv_sep_ << section.first << "_max_sys";
+    if (with_counters)
+      stash << csv_sep_ << section.first << "_ipc" << csv_sep_ << section.first << "_cache_misses_per_call" << csv_sep_
+            << section.first << "_branch_misses_per_call" << csv_sep_ << section.first << "_flops_per_call";
+    if (with_histograms)
+      stash << csv_sep_ << section.first << "_calls" << csv_sep_ << section.first << "_call_min_wall" << csv_sep_
+            << section.first << "_call_p50_wall" << csv_sep_ << section.first << "_call_p90_wall" << csv_sep_
+            << section.first << "_call_p99_wall" << csv_sep_ << section.first << "_call_max_wall";
   }
   const auto weight = 1 / double(comm.size());
 
   stash << std::endl << threadManager().max_threads() << csv_sep_ << comm.size();
-  for (const auto& section : commited_deltas_) {
-    const auto timings = section.second;
+  for (const auto& section : sections) {
+    const auto timings = section.second.delta;
     auto wall = timings[0];
     auto usr = timings[1];
     auto sys = timings[2];
@@ -217,6 +802,29 @@ void Timings::output_all_measures(std::ostream& out, MPIHelper::MPICommunicator
     const auto sys_max = comm.max(sys);
     stash << csv_sep_ << usr_sum * weight << csv_sep_ << usr_max << csv_sep_ << wall_sum * weight << csv_sep_
           << wall_max << csv_sep_ << sys_sum * weight << csv_sep_ << sys_max;
+    if (with_counters) {
+      // counted calls followed by the counter values
+      std::array<double, 1 + PerfCounterGroup::num_events> counts;
+      counts[0] = double(section.second.counted_calls);
+      for (auto i : value_range(PerfCounterGroup::num_events))
+        counts[1 + i] = double(section.second.counters[i]);
+      // counts beyond 2^53 are not exact in double, so the sum of the rounded counts depends on the order of the ranks
+      Common::sum(counts.data(), counts.size(), SummationMode::reproducible, comm);
+      const auto per_call = [&](double value) { return counts[0] > 0 ? value / counts[0] : 0.; };
+      stash << csv_sep_ << (counts[1] > 0 ? counts[2] / counts[1] : 0.) << csv_sep_ << per_call(counts[3]) << csv_sep_
+            << per_call(counts[4]) << csv_sep_ << per_call(counts[5]);
+    }
+    if (with_histograms) {
+      const auto histogram = reduced_histogram(section.second.histogram, comm);
+      // nanoseconds to milliseconds
+      const double ms = 1e-6;
+      if (histogram.count() == 0)
+        stash << csv_sep_ << 0 << csv_sep_ << 0 << csv_sep_ << 0 << csv_sep_ << 0 << csv_sep_ << 0 << csv_sep_ << 0;
+      else
+        stash << csv_sep_ << histogram.count() << csv_sep_ << histogram.min() * ms << csv_sep_
+              << histogram.percentile(50) * ms << csv_sep_ << histogram.percentile(90) * ms << csv_sep_
+              << histogram.percentile(99) * ms << csv_sep_ << histogram.max() * ms;
+    }
   }
 
   stash << std::endl;
@@ -224,8 +832,57 @@ void Timings::output_all_measures(std::ostream& out, MPIHelper::MPICommunicator
     out << stash.str();
 }
 
+void Timings::output_call_tree(std::ostream& out, MPIHelper::MPICommunicator mpi_comm) const
+{
+  CollectiveCommunication<MPIHelper::MPICommunicator> comm(mpi_comm);
+  const auto reduced = reduced_call_tree(mpi_comm);
+  if (comm.rank() != 0)
+    return;
+  std::stringstream stash;
+  stash << "path" << csv_sep_ << "calls";
+  for (const std::string measure : {"wall", "usr", "sys"})
+    stash << csv_sep_ << "avg_incl_" << measure << csv_sep_ << "max_incl_" << measure << csv_sep_ << "avg_excl_"
+          << measure << csv_sep_ << "max_excl_" << measure;
+  stash << std::endl;
+  // times are accumulated in nanoseconds, output is in milliseconds
+  const auto weight = 1e-6 / double(comm.size());
+  for (const auto& entry : reduced) {
+    const auto& values = entry.second;
+    stash << entry.first << csv_sep_ << std::size_t(values[0]);
+    for (auto i : value_range(3))
+      stash << csv_sep_ << values[1 + i] * weight << csv_sep_ << values[8 + i] * 1e-6 << csv_sep_
+            << values[4 + i] * weight << csv_sep_ << values[11 + i] * 1e-6;
+    stash << std::endl;
+  }
+  out << stash.str();
+} // ... output_call_tree(...)
+
+void Timings::output_collapsed_stacks(std::ostream& out, MPIHelper::MPICommunicator mpi_comm) const
+{
+  CollectiveCommunication<MPIHelper::MPICommunicator> comm(mpi_comm);
+  const auto reduced = reduced_call_tree(mpi_comm);
+  if (comm.rank() != 0)
+    return;
+  std::stringstream stash;
+  for (const auto& entry : reduced) {
+    // average exclusive wall time in microseconds
+    const auto exclusive = static_cast<long long>(entry.second[4] * 1e-3 / double(comm.size()));
+    if (exclusive > 0)
+      stash << entry.first << " " << exclusive << "\n";
+  }
+  out << stash.str();
+} // ... output_collapsed_stacks(...)
+
 Timings::Timings()
   : csv_sep_(",")
+  , measure_cpu_times_(true)
+  , call_tree_mode_(false)
+  , event_recording_(false)
+  , event_capacity_(0)
+  , event_epoch_(0)
+  , thread_count_(0)
+  , perf_counters_(false)
+  , histograms_(false)
 {
   DXTC_LIKWID_INIT;
   reset();
@@ -242,10 +899,15 @@ OutputScopedTiming::OutputScopedTiming(const std::string& section_name, std::ost
   , out_(out)
 {}
 
+OutputScopedTiming::OutputScopedTiming(const TimingSection& section, std::ostream& out)
+  : ScopedTiming(section)
+  , out_(out)
+{}
+
 OutputScopedTiming::~OutputScopedTiming()
 {
-  const auto duration = timings().stop(section_name_);
-  out_ << "Executing " << section_name_ << " took " << duration / 1000.f << "s\n";
+  const auto duration = timings().stop(section_);
+  out_ << "Executing " << section_.name() << " took " << duration / 1000.f << "s\n";
 }
 
 } // namespace Common
@@ -17,9 +17,12 @@
 #  define DUNE_XT_COMMON_DO_PROFILE 0
 #endif
 
+#include <array>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <deque>
 #include <ctime>
 #include <memory>
 #include <iostream>
@@ -32,6 +35,8 @@
 #include <dune/common/unused.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <dune/xt/common/histogram.hh>
+#include <dune/xt/common/perf_counters.hh>
 #include <dune/xt/common/parallel/threadmanager.hh>
 #include <dune/xt/common/parallel/threadstorage.hh>
 
@@ -47,9 +52,6 @@ Timings& timings();
 //! wraps name, start- and end time for one timing section
 struct TimingData
 {
-private:
-  std::shared_ptr<boost::timer::cpu_timer> timer_;
-
 public:
   std::string name;
 
@@ -66,40 +68,199 @@ public:
    *nanosecond results are scaled accordingly
    **/
   DeltaType delta() const;
+
+  /** \return array{wall,user,sys}: current monotonic wall clock and cpu times of the calling thread in nanoseconds
+   *  \param with_cpu_times if false, only the wall clock is read and user, sys are 0
+   *  \note these are absolute stamps, only differences of two calls are meaningful
+   **/
+  static DeltaType now(bool with_cpu_times = true);
+
+  //! converts a nanosecond delta as obtained from differences of now() to milliseconds
+  static DeltaType to_milliseconds(const DeltaType& nanoseconds);
+
+private:
+  DeltaType start_;
+  DeltaType stop_;
+  bool running_;
+};
+
+namespace internal {
+
+
+//! accumulator for one timing section in one thread, all times in nanoseconds
+struct TimingSlot
+{
+  bool running = false;
+  //! whether counters_start was read on start
+  bool counting = false;
+  std::size_t calls = 0;
+  //! calls with counters read on start and stop
+  std::size_t counted_calls = 0;
+  TimingData::DeltaType start = {{0, 0, 0}};
+  TimingData::DeltaType accumulated = {{0, 0, 0}};
+  PerfCounterGroup::ValuesType counters_start = {};
+  PerfCounterGroup::ValuesType counters = {};
+  //! wall times of single calls, allocated on the first start in histogram mode
+  std::shared_ptr<LogLinearHistogram> histogram;
+};
+
+//! node of a per-thread call tree, identified by its section and its parent node, all times in nanoseconds
+struct TimingTreeNode
+{
+  static constexpr std::size_t root = std::size_t(-1);
+
+  explicit TimingTreeNode(std::size_t section_in = root, std::size_t parent_in = root)
+    : section(section_in)
+    , parent(parent_in)
+  {}
+
+  std::size_t section;
+  std::size_t parent;
+  //! pairs of (section id, node index)
+  std::vector<std::pair<std::size_t, std::size_t>> children;
+  std::size_t calls = 0;
+  TimingData::DeltaType start = {{0, 0, 0}};
+  TimingData::DeltaType inclusive = {{0, 0, 0}};
+};
+
+//! id and name of a registered section, the name stays valid as long as timings()
+struct InternedSection
+{
+  std::size_t id = 0;
+  const char* name = nullptr;
+};
+
+//! begin and end of one pass through a section (or another scope) in one thread, times in nanoseconds
+struct TimingEvent
+{
+  std::size_t section = 0;
+  const char* category = nullptr;
+  TimingData::TimeType begin = 0;
+  TimingData::TimeType end = 0;
+};
+
+/** data owned by exactly one thread: a cache of interned section ids, one slot per known section id and, in call tree
+ *  mode, the call tree (node 0 being the root) and the stack of currently active nodes
+ *  \note all containers only grow when a thread encounters a section (or call path) for the first time, the event
+ *        ring buffer is allocated once on the first recorded event
+ **/
+struct TimingThreadData
+{
+  //! consecutive number of the thread, in order of first use of timings()
+  std::size_t index = 0;
+  std::unordered_map<std::string, InternedSection> ids;
+  std::vector<TimingSlot> slots;
+  std::vector<TimingTreeNode> tree;
+  std::vector<std::size_t> stack;
+  std::vector<TimingEvent> events;
+  //! total number of events recorded, the ring buffer position is recorded_events % events.size()
+  std::size_t recorded_events = 0;
+  //! opened on the first section started in perf counter mode
+  std::shared_ptr<PerfCounterGroup> counters;
 };
 
+
+} // namespace internal
+
 //! a utility class to time a limited scope of code
 class ScopedTiming;
 
+/** \brief handle to an interned timing section
+ *
+ *  Constructing the handle registers section_name with timings() once, starting and stopping the section via the
+ *  handle afterwards involves no string handling at all. Sections started via handle or via name share the same data.
+\code
+static const TimingSection assembly_section("assembly");
+for (auto&& element : elements) {
+  ScopedTiming timing(assembly_section);
+  // ...
+}
+\endcode
+ **/
+class TimingSection
+{
+public:
+  explicit TimingSection(const std::string& section_name);
+
+  std::size_t id() const
+  {
+    return id_;
+  }
+
+  const std::string& name() const;
+
+private:
+  friend class Timings;
+
+  std::size_t id_;
+  //! the interned name, for the likwid markers
+  const char* name_;
+};
+
 /** \brief simple inline timing class
  *  - User can set as many (even nested) named sections whose total (=system+user) time will be computed across all
  *    program instances.\n
  *  - Provides csv-conform output of process-averaged runtimes.
+ *  - Section names are interned into ids once, afterwards each thread only touches its own accumulator slots, so
+ *    start/stop do neither lock nor allocate. Data of all threads is merged on output or query.
+ *  - In call tree mode (see set_call_tree_mode) nested sections are additionally recorded per call path, with
+ *    inclusive and exclusive times.
+ *  - In event recording mode (see set_event_recording) each pass through a section is recorded with its begin and end
+ *    time, for inspection as a timeline in chrome://tracing or Perfetto (see output_trace).
+ *  - In perf counter mode (see set_perf_counters) hardware performance counters are read on each start and stop and
+ *    reported by output_all_measures.
+ *  - In histogram mode (see set_histograms) the wall time of each single call is additionally recorded in a histogram,
+ *    to expose the distribution of call durations (load imbalance, jitter) hidden by the sums.
+ *  \note reset, output and query methods must not be called while other threads are starting or stopping sections
  **/
 class Timings
 {
   friend Timings& timings();
+  friend class TimingSection;
 
 private:
   Timings();
 
-  typedef std::map<std::string, std::pair<std::atomic<bool>, UnsafePerThreadValue<TimingData>>> KnownTimersMap;
-  //! section name -> seconds
-  typedef std::map<std::string, TimingData::DeltaType> DeltaMap;
-
-  const TimingData& get_timing_data(std::string section_name) const;
+  //! merged data of one section over all threads
+  struct SectionSummary
+  {
+    std::size_t calls = 0;
+    //! milliseconds
+    TimingData::DeltaType delta = {{0, 0, 0}};
+    std::size_t counted_calls = 0;
+    PerfCounterGroup::ValuesType counters = {};
+    //! nanoseconds, nullptr if no thread recorded a histogram
+    std::shared_ptr<LogLinearHistogram> histogram;
+  };
+  typedef std::map<std::string, SectionSummary> SummaryMap;
+
+  struct CallTreeEntry
+  {
+    std::size_t calls = 0;
+    TimingData::DeltaType inclusive = {{0, 0, 0}};
+    TimingData::DeltaType exclusive = {{0, 0, 0}};
+  };
+  //! call path (section names separated by ';') -> nanoseconds
+  typedef std::map<std::string, CallTreeEntry> CallTreeMap;
 
 public:
   ~Timings();
 
+  //! stop all running sections
   void stop();
 
   //! set this to begin a named section
   void start(std::string section_name);
 
+  //! begin an already registered section
+  void start(const TimingSection& section);
+
   //! stop named section's counter
   long stop(std::string section_name);
 
+  //! stop an already registered section's counter, does nothing if it is not running
+  long stop(const TimingSection& section);
+
   //! set elapsed time back to 0 for section_name
   void reset(std::string section_name);
 
@@ -107,6 +268,8 @@ public:
   TimingData::TimeType walltime(std::string section_name) const;
   //! get the full delta array
   TimingData::DeltaType delta(std::string section_name) const;
+  //! get the wall times (in nanoseconds) of all calls recorded in histogram mode, merged over all threads
+  LogLinearHistogram histogram(std::string section_name) const;
 
   /** creates one file local to each MPI-rank (no global averaging)
    *  one single rank-0 file with all combined/averaged measures
@@ -115,23 +278,127 @@ public:
   //! outputs walltime only w/o MPI-rank averaging
   void output_simple(std::ostream& out = std::cout) const;
   /** output all recorded measures
-   * \note outputs average, min, max over all MPI processes associated to mpi_comm **/
+   * \note outputs average, min, max over all MPI processes associated to mpi_comm
+   * \note if perf counters were recorded (see set_perf_counters), also outputs instructions per cycle as well as cache
+   *       misses, branch misses and flops per counted call (each summed over all MPI processes)
+   * \note if histograms were recorded (see set_histograms), also outputs the number of calls and min, 50th, 90th and
+   *       99th percentile and max of the wall time per call, over all calls on all MPI processes **/
   void output_all_measures(std::ostream& out = std::cout,
                            MPIHelper::MPICommunicator mpi_comm = Dune::MPIHelper::getCommunicator()) const;
 
+  /** output the call tree recorded in call tree mode, one csv line per call path
+   * \note outputs summed calls and average, max of inclusive and exclusive times over all MPI processes associated to
+   *       mpi_comm, call paths missing on some ranks count as 0 there **/
+  void output_call_tree(std::ostream& out = std::cout,
+                        MPIHelper::MPICommunicator mpi_comm = Dune::MPIHelper::getCommunicator()) const;
+
+  /** output the call tree recorded in call tree mode in the collapsed stack format understood by flame graph tools:
+   *  one line "outer;inner <exclusive wall time in microseconds>" per call path, averaged over all MPI processes
+   *  associated to mpi_comm **/
+  void output_collapsed_stacks(std::ostream& out = std::cout,
+                               MPIHelper::MPICommunicator mpi_comm = Dune::MPIHelper::getCommunicator()) const;
+
+  /** writes the events recorded in event recording mode in the Chrome trace event (json) format, with the MPI rank as
+   *  process and the thread as thread id
+   *  \param merge_on_rank_0 if false, each rank writes json_base_pXXXXXXXX.json, if true the events of all ranks are
+   *         gathered and written to a single json_base.json by rank 0
+   *  \note timestamps are relative to enabling event recording on each rank, so merged traces are only aligned as well
+   *        as the calls to set_event_recording were **/
+  void output_trace(std::string json_base, const bool merge_on_rank_0 = false) const;
+  //! writes the events recorded on this rank in the Chrome trace event (json) format
+  void output_trace_simple(std::ostream& out = std::cout) const;
+
   /// stops and resets all timers and data
   void reset();
 
   void set_outputdir(std::string dir);
 
+  /** if false, only wall times are measured (user and sys times are reported as 0), which saves a system call on each
+   *  start and stop **/
+  void set_measure_cpu_times(bool value);
+
+  /** if true, each thread additionally keeps track of the stack of active sections and accumulates times per call
+   *  path, see output_call_tree and output_collapsed_stacks
+   *  \note only sections started after enabling are recorded **/
+  void set_call_tree_mode(bool value);
+
+  /** if true, each pass through a section (and each TimedLogManager scope) is recorded as an event in a ring buffer of
+   *  the calling thread, see output_trace
+   *  \param capacity number of events per thread, the buffer is allocated on the first event of each thread and the
+   *         oldest events are overwritten once it is full **/
+  void set_event_recording(bool value, const std::size_t capacity = 65536);
+
+  bool event_recording() const;
+
+  /** records an event of section id in event recording mode, does nothing otherwise
+   *  \param category a string literal (only the pointer is stored), e.g. "timings"
+   *  \param begin,end wall times in nanoseconds, as obtained from TimingData::now() **/
+  void record_event(std::size_t id, const char* category, TimingData::TimeType begin, TimingData::TimeType end);
+
+  /** if true, the hardware performance counters of PerfCounterGroup are read on each start and stop of a section and
+   *  accumulated per section and thread
+   *  \param raw_flop_events model specific events counting floating point operations, see PerfCounterGroup
+   *  \note the counters of each thread are opened on the first section started in that thread after enabling, so
+   *        raw_flop_events should be set before any section is started **/
+  void set_perf_counters(bool value,
+                         const PerfCounterGroup::FlopEventsType& raw_flop_events = PerfCounterGroup::FlopEventsType());
+
+  bool perf_counters() const;
+
+  /** if true, the wall time of each single call of a section is recorded in a LogLinearHistogram per section and thread
+   *  \note costs about 8KB per section and thread, allocated on the first start of a section after enabling **/
+  void set_histograms(bool value);
+
+  bool histograms() const;
+
+  //! interned id of section_name, registers the section if unknown
+  std::size_t section_id(const std::string& section_name);
+
+  //! name of a registered section
+  const std::string& section_name(std::size_t id) const;
+
 private:
-  DeltaMap commited_deltas_;
+  //! interned id and name of section_name, registers the section if unknown
+  const internal::InternedSection& intern(const std::string& section_name);
+  //! interned id of section_name, false if the section was never registered
+  bool find_section_id(const std::string& section_name, std::size_t& id) const;
+  //! the calling thread's data, looked up in thread_data_ only once per thread
+  internal::TimingThreadData& local_data() const;
+  //! the calling thread's slot for section id
+  internal::TimingSlot& local_slot(std::size_t id);
+  //! \param name the name of the section, only used for the likwid markers
+  long stop_section(std::size_t id, const char* name, const TimingData::DeltaType& stamp);
+  //! pushes the node for section id below the currently active node of the calling thread
+  void push_tree_node(internal::TimingThreadData& data, std::size_t id, const TimingData::DeltaType& stamp);
+  //! pops the active node of section id (and any nodes that were started after it) of the calling thread
+  void pop_tree_node(internal::TimingThreadData& data, std::size_t id, const TimingData::DeltaType& stamp);
+  //! sums up the committed data of all threads, includes only sections that were stopped at least once
+  SummaryMap merged_sections() const;
+  //! merges the call trees of all threads by call path
+  CallTreeMap merged_call_tree() const;
+  //! sum and max (in this order) of all entries over mpi_comm, keyed by the union of all call paths on rank 0
+  std::vector<std::pair<std::string, std::vector<double>>> reduced_call_tree(MPIHelper::MPICommunicator mpi_comm) const;
+  //! json objects (separated by ",\n") of all recorded events of this rank
+  std::string trace_events(int rank) const;
+
   //! runtime tables etc go there
   std::string output_dir_;
 
-  KnownTimersMap known_timers_map_;
   const std::string csv_sep_;
-  std::mutex mutex_;
+  //! guards the section registry, never locked on the start/stop path once a thread knows a section
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::size_t> section_ids_;
+  std::deque<std::string> section_names_;
+  mutable PerThreadValue<internal::TimingThreadData> thread_data_;
+  std::atomic<bool> measure_cpu_times_;
+  std::atomic<bool> call_tree_mode_;
+  std::atomic<bool> event_recording_;
+  std::atomic<std::size_t> event_capacity_;
+  std::atomic<TimingData::TimeType> event_epoch_;
+  mutable std::atomic<std::size_t> thread_count_;
+  std::atomic<bool> perf_counters_;
+  std::atomic<bool> histograms_;
+  PerfCounterGroup::FlopEventsType raw_flop_events_;
 };
 
 //! global profiler object
@@ -144,18 +411,24 @@ DUNE_EXPORT inline Timings& timings()
 class ScopedTiming : public boost::noncopyable
 {
 protected:
-  const std::string section_name_;
+  const TimingSection section_;
 
 public:
   explicit inline ScopedTiming(const std::string& section_name)
-    : section_name_(section_name)
+    : section_(section_name)
+  {
+    timings().start(section_);
+  }
+
+  explicit inline ScopedTiming(const TimingSection& section)
+    : section_(section)
   {
-    timings().start(section_name_);
+    timings().start(section_);
   }
 
   inline ~ScopedTiming()
   {
-    timings().stop(section_name_);
+    timings().stop(section_);
   }
 };
 
@@ -163,6 +436,8 @@ struct OutputScopedTiming : public ScopedTiming
 {
   OutputScopedTiming(const std::string& section_name, std::ostream& out);
 
+  OutputScopedTiming(const TimingSection& section, std::ostream& out);
+
   ~OutputScopedTiming();
 
 protected:
@@ -175,8 +450,17 @@ protected:
 
 #define DXTC_TIMINGS Dune::XT::Common::timings()
 
+#define DXTC_TIMING_SCOPE_IMPL(section_name, id)                                                                       \
+  static const Dune::XT::Common::TimingSection dxtc_timing_section_##id(section_name);                                 \
+  const Dune::XT::Common::ScopedTiming dxtc_scoped_timing_##id(dxtc_timing_section_##id)
+#define DXTC_TIMING_SCOPE_EXPAND(section_name, id) DXTC_TIMING_SCOPE_IMPL(section_name, id)
+
 #if DUNE_XT_COMMON_DO_TIMING
-#  define DUNE_XT_COMMON_TIMING_SCOPE(section_name) Dune::XT::Common::ScopedTiming DXTC_UNUSED(timer)(section_name)
+/** \brief times the enclosing scope
+ *  The section is registered once per call site through a function-local static TimingSection, so section_name is
+ *  only evaluated on the first pass. Use ScopedTiming directly for names that change between passes.
+ **/
+#  define DUNE_XT_COMMON_TIMING_SCOPE(section_name) DXTC_TIMING_SCOPE_EXPAND(section_name, __COUNTER__)
 #else
 #  define DUNE_XT_COMMON_TIMING_SCOPE(section_name)
 #endif
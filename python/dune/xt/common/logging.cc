@@ -57,6 +57,8 @@ PYBIND11_MODULE(logging, m)
         },
         "msg"_a,
         "end"_a = "\n");
+  m.def("collate", [](bool complete) { Logger().collate(complete); }, "complete"_a = false);
   m.attr("log_max") = LogMax;
   m.attr("log_default") = LogDefault;
+  m.attr("log_aggregate") = int(LOG_AGGREGATE);
 }
@@ -31,7 +31,7 @@ PYBIND11_MODULE(_timings, m)
 
   bindings::try_register(m, [](auto& m_) {
     py::class_<Timings>(m_, "Timings")
-        .def("start", &Timings::start, "set this to begin a named section")
+        .def("start", py::overload_cast<std::string>(&Timings::start), "set this to begin a named section")
         .def("reset", py::overload_cast<std::string>(&Timings::reset), "set elapsed time back to 0 for section_name")
         .def("reset", py::overload_cast<>(&Timings::reset), "set elapsed time back to 0 for section_name")
         .def("stop", py::overload_cast<std::string>(&Timings::stop), "stop all timer for given section only")
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+#
+# ~~~
+# This file is part of the dune-xt-common project:
+#   https://github.com/dune-community/dune-xt-common
+# Copyright 2009-2018 dune-xt-common developers and contributors. All rights reserved.
+# License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+#      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+#          with "runtime exception" (http://www.dune-project.org/license.html)
+# ~~~
+"""Decode log files written by Dune::XT::Common::BinaryLogSink into text
+
+Usage: decode_binary_log.py [--rank=RANK]... [--thread=THREAD]... [--level=LEVEL]... FILE...
+
+Arguments:
+    FILE                One or more binary log files, decoded one after another.
+
+Options:
+    --rank=RANK         Only print records of this MPI rank, may be given more than once.
+    --thread=THREAD     Only print records of this thread number, may be given more than once.
+    --level=LEVEL       Only print records of this level (error, info, debug or the id of a stream), may be given
+                        more than once.
+
+Each line is printed as 'SECONDS|rank RANK|thread THREAD|LEVEL: TEXT', where SECONDS have passed since the creation of
+the sink.
+"""
+
+import struct
+import sys
+
+import docopt
+
+MAGIC = b'DXTCLOG\0'
+VERSION = 1
+FORMAT_RECORD = 1
+MESSAGE_RECORD = 2
+LEVELS = {2: 'error', 4: 'info', 8: 'debug'}
+
+
+class BinaryLogError(Exception):
+    pass
+
+
+def level_name(level):
+    return LEVELS.get(level, str(level))
+
+
+def format_argument(data, position, order):
+    """returns the argument starting at position, formatted like a LogStream would, and the position after it"""
+    kind = data[position]
+    position += 1
+    if kind == 1:
+        return str(struct.unpack_from(order + 'q', data, position)[0]), position + 8
+    if kind == 2:
+        return str(struct.unpack_from(order + 'Q', data, position)[0]), position + 8
+    if kind == 3:
+        return '%g' % struct.unpack_from(order + 'd', data, position)[0], position + 8
+    if kind == 4:
+        size = struct.unpack_from(order + 'I', data, position)[0]
+        position += 4
+        return data[position:position + size].decode('utf-8', 'replace'), position + size
+    if kind == 5:
+        return data[position:position + 1].decode('latin-1'), position + 1
+    if kind == 6:
+        return str(int(data[position] != 0)), position + 1
+    raise BinaryLogError('unknown argument type {}'.format(kind))
+
+
+def substitute(fmt, arguments):
+    """replaces each {} in fmt by the next argument, appends surplus arguments"""
+    pieces = fmt.split('{}')
+    text = pieces[0]
+    for ii, piece in enumerate(pieces[1:]):
+        text += (arguments[ii] if ii < len(arguments) else '{}') + piece
+    for argument in arguments[len(pieces) - 1:]:
+        text += ' ' + argument
+    return text
+
+
+def records(filename):
+    """yields (rank, level, thread, nanoseconds, text) for each message in filename"""
+    with open(filename, 'rb') as log:
+        header = log.read(32)
+        if len(header) != 32 or header[:8] != MAGIC:
+            raise BinaryLogError('{} is not a binary log file'.format(filename))
+        order = '<' if struct.unpack_from('<I', header, 8)[0] == 0x01020304 else '>'
+        _, version, rank, _, _ = struct.unpack_from(order + 'IIiIq', header, 8)
+        if version != VERSION:
+            raise BinaryLogError('{} has version {}, only {} is supported'.format(filename, version, VERSION))
+        formats = {}
+        while True:
+            size = log.read(4)
+            if len(size) != 4:
+                return
+            size = struct.unpack(order + 'I', size)[0]
+            payload = log.read(size)
+            # the last record may have been truncated by a crash
+            if len(payload) != size:
+                return
+            kind, format_id = struct.unpack_from(order + 'BI', payload)
+            if kind == FORMAT_RECORD:
+                formats[format_id] = payload[5:].decode('utf-8', 'replace')
+            elif kind == MESSAGE_RECORD:
+                level, thread, time = struct.unpack_from(order + 'iIQ', payload, 5)
+                arguments = []
+                position = 21
+                while position < size:
+                    argument, position = format_argument(payload, position, order)
+                    arguments.append(argument)
+                yield rank, level, thread, time, substitute(formats[format_id], arguments)
+            else:
+                raise BinaryLogError('unknown record kind {} in {}'.format(kind, filename))
+
+
+def matches(value, allowed):
+    return not allowed or value in allowed
+
+
+def level_matches(level, allowed):
+    return not allowed or level_name(level) in allowed or str(level) in allowed
+
+
+if __name__ == '__main__':
+    arguments = docopt.docopt(__doc__)
+    ranks = {int(rank) for rank in arguments['--rank']}
+    threads = {int(thread) for thread in arguments['--thread']}
+    levels = set(arguments['--level'])
+    try:
+        for filename in arguments['FILE']:
+            for rank, level, thread, time, text in records(filename):
+                if not (matches(rank, ranks) and matches(thread, threads) and level_matches(level, levels)):
+                    continue
+                prefix = '{:.6f}|rank {}|thread {}|{}: '.format(time * 1e-9, rank, thread, level_name(level))
+                lines = text[:-1] if text.endswith('\n') else text
+                for line in lines.split('\n'):
+                    print(prefix + line)
+    except (BinaryLogError, IOError) as error:
+        print(error, file=sys.stderr)
+        sys.exit(1)